@@ -1,6 +1,8 @@
 #include "Atom.h"
 #include "Pair.h"
+#include "SafeOps.h"
 
+#include <algorithm>
 #include <cstring>
 
 
@@ -9,7 +11,8 @@ Atom::Atom()
 	
 	id                   = 0;
 	bond_id              = 0;
-	atomtype[0]          = (char) 0;
+	mixing_type          = -1;
+	atomtype_id          = 0;
 	frozen               = 0;
 	adiabatic            = 0;
 	spectre              = 0;
@@ -46,8 +49,10 @@ Atom::Atom()
 	}
 	
 
-	// pair_t *pairs;
-
+	pairs                = nullptr;
+	pairs_count          = 0;
+	pairs_allocd         = 0;
+	next                 = nullptr;
 }
 
 
@@ -56,7 +61,7 @@ Atom::Atom()
 
 Atom::Atom(const Atom &other) {
 	
-	strcpy(atomtype, other.atomtype);
+	atomtype_id = other.atomtype_id;
 
 	id        = other.id;
 	bond_id   = other.bond_id;
@@ -82,6 +87,7 @@ Atom::Atom(const Atom &other) {
 	last_volume              = other.last_volume;
 	gwp_spin                 = other.gwp_spin;
 	site_neighbor_id         = other.site_neighbor_id;
+	mixing_type              = other.mixing_type;
 	
 	for (int i = 0; i < 3; i++) {
 		pos[i]               = other.pos[i];
@@ -102,31 +108,14 @@ Atom::Atom(const Atom &other) {
 
 	// Copy the pair list
 	////////////////////////////////////////////////////////////////////
-	{
-		
-		Pair *other_pair_ptr = other.pairs;   // position in the 'other' pair list
-
-		if (other_pair_ptr) 
-		// If there is a list... 
-		{
-			pairs = new Pair(*other_pair_ptr); // Create the first node for our new pairs list.
-			Pair *this_pair_ptr = pairs;       // iterator for the list we are building
-
-			// Traverse the 'other' pair list...
-			for (other_pair_ptr = other_pair_ptr->next; other_pair_ptr; other_pair_ptr = other_pair_ptr->next) {
-				// ...creating new nodes in our list for each pair node we discover in the 'other' list.
-				this_pair_ptr->next = new Pair(*other_pair_ptr);
-				this_pair_ptr = this_pair_ptr->next;
-			}
-			this_pair_ptr->next = nullptr; // Terminate our new list.
-
-		} else {
-			// If there is no pair list on the original, we leave the new pair list empty as well
-			pairs = nullptr;
-		}
+	pairs        = nullptr;
+	pairs_count  = 0;
+	pairs_allocd = 0;
+	if( other.pairs_count ) {
+		resize_pairs( other.pairs_count );
+		std::memcpy( pairs, other.pairs, pairs_count * sizeof(Pair) );
+		thread_pairs( 0 );
 	}
-	
-	
 }
 
 
@@ -143,16 +132,52 @@ Atom::~Atom() {
 void Atom::free_pairs() {
 
 	if(pairs)
-		recursive_free_pairs( pairs );
+		free(pairs);
 
-	pairs = nullptr;
+	pairs        = nullptr;
+	pairs_count  = 0;
+	pairs_allocd = 0;
 	return;
 }
-void Atom::recursive_free_pairs(Pair *pPair) {
-	
-	if( pPair->next )
-		recursive_free_pairs( pPair->next );
 
-	free(pPair);
-	return;
-}
\ No newline at end of file
+
+
+
+void Atom::resize_pairs( int count ) {
+// The pair list is a single contiguous array whose capacity grows geometrically, so appending the
+// pairs for an inserted molecule is amortized O(1) per list. New entries are value-initialized, as freshly
+// calloc'd nodes were.
+
+	Pair *old = pairs;
+
+	if( count <= 0 ) {
+		free_pairs();
+		return;
+	}
+
+	if( count > pairs_allocd ) {
+		int allocd = pairs_allocd ? pairs_allocd : 1;
+		while( allocd < count )
+			allocd *= 2;
+		SafeOps::realloc( pairs, allocd * sizeof(Pair), __LINE__, __FILE__ );
+		pairs_allocd = allocd;
+	}
+	if( count > pairs_count )
+		std::fill( pairs + pairs_count, pairs + count, Pair() );
+
+	// if the array moved, every link must be redone
+	int from = (pairs == old) ? ((count < pairs_count) ? count : pairs_count) : 0;
+	pairs_count = count;
+	thread_pairs( from );
+}
+
+
+
+
+void Atom::thread_pairs( int from ) {
+// Link entries [from-1, pairs_count) to their successors, so that lists may still be walked.
+
+	for( int k = (from > 0 ? from - 1 : 0); k < pairs_count - 1; k++ )
+		pairs[k].next = &pairs[k + 1];
+	pairs[ pairs_count - 1 ].next = nullptr;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "constants.h"
+#include "TypeRegistry.h"
 
 class Pair;
 
@@ -14,14 +15,17 @@ public:
 	Atom(const Atom &other);
 	~Atom();
 	void free_pairs();
+	void resize_pairs( int count ); // grow/shrink the pair list, keeping the leading entries
+	const char * atomtype() const { return TypeRegistry::atom_type_name( atomtype_id ); }
 private:
-	void recursive_free_pairs( Pair *pPair);
+	void thread_pairs( int from );
 
 	
 public:
 	int    id,
-	       bond_id;
-	char   atomtype[maxLine];
+	       bond_id,
+	       mixing_type;   // index into the System's exclusion/mixing table, -1 until assigned
+	int    atomtype_id;   // TypeRegistry id of the atom type name
 	int    frozen, 
 	       adiabatic,
 	       spectre, 
@@ -53,7 +57,12 @@ public:
 	       last_volume;
 	int    gwp_spin,
 	       site_neighbor_id; // dr fluctuations will be applied along the vector from this atom to the atom identified by this variable
-	Pair   *pairs;
+	// The pairs are kept as one array of whole Pair records per atom rather than split into per-field
+	// arrays: the energy kernels read most fields of each pair they visit, and the Pair* links the rest
+	// of the code holds would all need rewriting for a structure-of-arrays layout.
+	Pair   *pairs;               // contiguous array of pairs_count entries, threaded via Pair::next (nullptr if empty)
+	int     pairs_count,
+	        pairs_allocd;
 	Atom   *next;
 };
 
@@ -0,0 +1,232 @@
+#include "FFT.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SafeOps.h"
+
+
+
+static const double two_pi = 6.283185307179586476925286766559;
+
+
+
+
+FFT::FFT() {
+	for( int q = 0; q < 3; q++ ) {
+		n[q]        = 0;
+		nfactors[q] = 0;
+		twiddle[q]  = nullptr;
+	}
+	line      = nullptr;
+	butterfly = nullptr;
+}
+
+
+
+
+FFT::~FFT() {
+	clear();
+}
+
+
+
+
+FFT::FFT( const FFT &other ) : FFT() {
+	*this = other;
+}
+
+
+
+
+FFT & FFT::operator=( const FFT &other ) {
+
+	if( this == &other )
+		return *this;
+
+	clear();
+	if( other.n[0] )
+		plan( other.n[0], other.n[1], other.n[2] );
+	return *this;
+}
+
+
+
+
+void FFT::clear() {
+
+	for( int q = 0; q < 3; q++ ) {
+		if( twiddle[q] ) free( twiddle[q] );
+		twiddle[q]  = nullptr;
+		n[q]        = 0;
+		nfactors[q] = 0;
+	}
+	if( line      ) free( line      );
+	if( butterfly ) free( butterfly );
+	line      = nullptr;
+	butterfly = nullptr;
+}
+
+
+
+
+int FFT::good_size( int n ) {
+// The smallest product of 2s, 3s and 5s that is at least n.
+
+	int m;
+
+	if( n < 1 )
+		return 1;
+
+	for( ; ; n++ ) {
+		m = n;
+		while( !(m % 2) ) m /= 2;
+		while( !(m % 3) ) m /= 3;
+		while( !(m % 5) ) m /= 5;
+		if( m == 1 )
+			return n;
+	}
+}
+
+
+
+
+void FFT::plan( int n0, int n1, int n2 ) {
+
+	int dims[3] = { n0, n1, n2 },
+	    longest = 1,
+	    radix   = 1,
+	    m;
+
+	clear();
+
+	for( int q = 0; q < 3; q++ ) {
+		n[q] = dims[q];
+		if( n[q] > longest )
+			longest = n[q];
+
+		// factor the axis, small radices first
+		m = n[q];
+		for( int f = 2; m > 1; f++ )
+			while( !(m % f) ) {
+				factors[q][nfactors[q]++] = f;
+				if( f > radix )
+					radix = f;
+				m /= f;
+			}
+
+		SafeOps::malloc( twiddle[q], 2 * n[q] * sizeof(double), __LINE__, __FILE__ );
+		for( int j = 0; j < n[q]; j++ ) {
+			twiddle[q][2*j    ] = cos( two_pi * j / n[q] );
+			twiddle[q][2*j + 1] = sin( two_pi * j / n[q] );
+		}
+	}
+
+	SafeOps::malloc( line,      2 * longest * sizeof(double), __LINE__, __FILE__ );
+	SafeOps::malloc( butterfly, 2 * radix   * sizeof(double), __LINE__, __FILE__ );
+}
+
+
+
+
+void FFT::forward( double *data ) {
+	transform( data, -1 );
+}
+
+
+
+
+void FFT::backward( double *data ) {
+	transform( data, 1 );
+}
+
+
+
+
+void FFT::transform( double *data, int sign ) {
+// One axis at a time: rows along axis 2, then columns along 1 and 0.
+
+	for( int i0 = 0; i0 < n[0]; i0++ )
+		for( int i1 = 0; i1 < n[1]; i1++ )
+			transform_line( 2, data + 2*(i0*n[1] + i1)*n[2], 1, sign );
+
+	for( int i0 = 0; i0 < n[0]; i0++ )
+		for( int i2 = 0; i2 < n[2]; i2++ )
+			transform_line( 1, data + 2*(i0*n[1]*n[2] + i2), n[2], sign );
+
+	for( int i1 = 0; i1 < n[1]; i1++ )
+		for( int i2 = 0; i2 < n[2]; i2++ )
+			transform_line( 0, data + 2*(i1*n[2] + i2), n[1]*n[2], sign );
+}
+
+
+
+
+void FFT::transform_line( int axis, double *data, int stride, int sign ) {
+
+	if( n[axis] == 1 )
+		return;
+
+	fft1d( axis, data, stride, line, n[axis], 0, sign );
+	for( int j = 0; j < n[axis]; j++ ) {
+		data[2*j*stride    ] = line[2*j    ];
+		data[2*j*stride + 1] = line[2*j + 1];
+	}
+}
+
+
+
+
+void FFT::fft1d( int axis, const double *in, int stride, double *out, int len, int level, int sign ) {
+// Transform the len points in[0], in[stride], ... into out[0..len-1]. Splitting len = p*m, the p
+// decimated subsequences are transformed into consecutive blocks of out, which are then combined by
+// m p-point butterflies in place.
+
+	int            p, m, N, step, idx;
+	double         c, s, re, im;
+	const double * w = twiddle[axis];
+
+	if( len == 1 ) {
+		out[0] = in[0];
+		out[1] = in[1];
+		return;
+	}
+
+	p    = factors[axis][level];
+	m    = len / p;
+	N    = n[axis];
+	step = N / len;
+
+	for( int r = 0; r < p; r++ )
+		fft1d( axis, in + 2*r*stride, stride*p, out + 2*r*m, m, level + 1, sign );
+
+	for( int k = 0; k < m; k++ ) {
+
+		// twiddle the k-th point of each block: W_len^{r k} = W_N^{r k step}
+		for( int r = 0; r < p; r++ ) {
+			idx = r * k * step;
+			c   = w[2*idx];
+			s   = sign * w[2*idx + 1];
+			re  = out[2*(r*m + k)    ];
+			im  = out[2*(r*m + k) + 1];
+			butterfly[2*r    ] = re*c - im*s;
+			butterfly[2*r + 1] = re*s + im*c;
+		}
+
+		// p-point DFT of those, back into the same slots
+		for( int q = 0; q < p; q++ ) {
+			re = 0;
+			im = 0;
+			for( int r = 0; r < p; r++ ) {
+				idx = ((r * q) % p) * (N / p);
+				c   = w[2*idx];
+				s   = sign * w[2*idx + 1];
+				re += butterfly[2*r]*c - butterfly[2*r + 1]*s;
+				im += butterfly[2*r]*s + butterfly[2*r + 1]*c;
+			}
+			out[2*(q*m + k)    ] = re;
+			out[2*(q*m + k) + 1] = im;
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Complex, in-place, three-dimensional fast Fourier transforms.
+//
+// Data is stored row major (the last index varies fastest), with the real and imaginary parts of
+// each point interleaved. forward() computes X(m) = sum_g x(g) e^{-2 pi i m.g/n} and backward() the
+// same with e^{+2 pi i ...}; neither one normalizes. Each axis is transformed by a mixed-radix
+// Cooley-Tukey recursion, which is fast for sizes with only small prime factors; good_size() rounds a
+// size up to a product of 2s, 3s and 5s.
+
+class FFT
+{
+public:
+	FFT();
+	~FFT();
+	FFT( const FFT &other );
+	FFT & operator=( const FFT &other );
+
+	int n[3];                     // points along each axis (0: no plan)
+
+	void plan( int n0, int n1, int n2 );
+	void clear();
+	void forward( double *data );
+	void backward( double *data );
+
+	inline bool planned( int n0, int n1, int n2 ) const {
+		return (n[0] == n0) && (n[1] == n1) && (n[2] == n2);
+	}
+
+	static int good_size( int n );
+
+private:
+	int      nfactors[3],
+	         factors[3][32];      // radices of each axis, in the order the recursion applies them
+	double * twiddle[3],          // cos and sin of 2 pi j/n[axis], interleaved
+	       * line,                // one axis' worth of points
+	       * butterfly;           // one butterfly's worth of points
+
+	void transform( double *data, int sign );
+	void transform_line( int axis, double *data, int stride, int sign );
+	void fft1d( int axis, const double *in, int stride, double *out, int len, int level, int sign );
+};
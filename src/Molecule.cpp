@@ -16,16 +16,19 @@
 Molecule::Molecule()
 {
 	id = 0;
-	moleculetype[0] = (char) 0;
+	moleculetype_id = 0;
 	mass            = 0.0;
 	frozen          = 0; 
 	adiabatic       = 0;
 	spectre         = 0;
 	target          = 0;
 	nuclear_spin    = 0;
+	dirty           = 0;
 	rot_partfunc_g  = 0;
 	rot_partfunc_u  = 0;
 	rot_partfunc    = 0;
+	atoms           = nullptr;
+	next            = nullptr;
 	for( int i=0; i<3; i++ ) {
 		com        [i] = 0.0;
 	    wrapped_com[i] = 0.0;  //center of mass
@@ -47,7 +50,7 @@ Molecule::Molecule()
 }
 Molecule::Molecule( const Molecule &other ) {
 	
-	strcpy(moleculetype, other.moleculetype);
+	moleculetype_id = other.moleculetype_id;
 
 	id             = other.id;
 	mass           = other.mass;
@@ -56,6 +59,7 @@ Molecule::Molecule( const Molecule &other ) {
 	spectre        = other.spectre;
 	target         = other.target;
 	nuclear_spin   = other.nuclear_spin;
+	dirty          = other.dirty;
 	rot_partfunc_g = other.rot_partfunc_g;
 	rot_partfunc_u = other.rot_partfunc_u;
 	rot_partfunc   = other.rot_partfunc;
@@ -397,11 +401,3 @@ void Molecule::recursive_free_atoms(Atom *pAtom) {
 	delete pAtom;
 
 }
-
-
-
-
-void Molecule::wipe_pair_refs() {
-	for (Atom *pAtom = atoms; pAtom; pAtom = pAtom->next) 
-		pAtom->pairs = nullptr;
-}
\ No newline at end of file
@@ -16,6 +16,7 @@ public:
 
 	~Molecule();
 
+	const char * moleculetype() const { return TypeRegistry::molecule_type_name( moleculetype_id ); }
 	// void free_pairs();
 	void rotate_rand(double scale); //, const PeriodicBoundary &pbc, std::mt19937 *mt_rand );
 	void rotate( double x, double y, double z, double angle ); // params are axis-of-rotation and angle-of-rotation (in degrees)
@@ -28,7 +29,6 @@ public:
 	void displace_gwp( double scale, std::mt19937 *mt_rand );
 	void update_COM();
 	void free_atoms(); // Free memory used by the molecule's linked list of atoms. 
-	void wipe_pair_refs(); // zero out all the pair list pointers while keeping the lists themselves
 	                       // (for use prior to deletion, when the pair list is to be preserved elsewhere)
 private:
 	void recursive_free_atoms(Atom *pAtom);
@@ -37,7 +37,7 @@ private:
 
 public:
 	int        id;
-	char       moleculetype[maxID];
+	int        moleculetype_id; // TypeRegistry id of the molecule type name
 	double     mass;
 	int        frozen, 
 	           adiabatic,
@@ -47,6 +47,7 @@ public:
 	           wrapped_com[3]; //center of mass
 	double     iCOM       [3]; // initial Center of Mass
 	int        nuclear_spin;
+	int        dirty;          // Flag: perturbed since the last System::pairs()
 	double     rot_partfunc_g, 
 	           rot_partfunc_u,
 	           rot_partfunc;
@@ -24,9 +24,11 @@ public:
 		es_excluded          = 0;
 		attractive_only      = 0;
 		recalculate_energy   = 0;
+		culled               = 0;
 		lrc                  = 0;
 		last_volume          = 0;
-		epsilon, sigma       = 0;
+		epsilon              = 0;
+		sigma                = 0;
 		r                    = 0;
 		rimg                 = 0;
 		rd_energy            = 0;
@@ -47,43 +49,17 @@ public:
 		next     = nullptr;
 
 	};
-	Pair(const Pair &other) {
-		frozen               = other.frozen;
-		rd_excluded          = other.rd_excluded;
-		es_excluded          = other.es_excluded;
-		attractive_only      = other.attractive_only;
-		recalculate_energy   = other.recalculate_energy;
-		lrc                  = other.lrc;
-		last_volume          = other.last_volume;
-		epsilon, sigma       = other.epsilon, sigma;
-		r                    = other.r;
-		rimg                 = other.rimg;
-		rd_energy            = other.rd_energy;
-		es_real_energy       = other.es_real_energy;
-		es_self_intra_energy = other.es_self_intra_energy;
-		sigrep               = other.sigrep;
-		c6                   = other.c6;
-		c8                   = other.c8;
-		c10                  = other.c10;
-
-		for (int i = 0; i < 3; i++) {
-			dimg  [i] = other.dimg  [i];
-			d_prev[i] = other.d_prev[i];
-		}
-
-		atom     = other.atom;
-		molecule = other.molecule;
-
-		next     = nullptr;
-	};
-	~Pair(){};
+	// No copy constructor or destructor of our own: Pair stays trivially copyable, since each atom's pairs
+	// are a contiguous array that Atom::resize_pairs() grows with realloc() and Atom's copy constructor
+	// copies whole (re-threading Pair::next afterwards).
 
 	
 	int      frozen,               //are they both MOF atoms, for instance
 	         rd_excluded, 
 	         es_excluded,
 	         attractive_only,
-	         recalculate_energy;
+	         recalculate_energy,
+	         culled;               //atoms are in non-neighboring cells (System.CellList.cpp), rimg/dimg not current
 	double   lrc,                  //LJ long-range correction
 	         last_volume,          //what was the volume when we last calculated LRC? needed for NPT
 	         epsilon, sigma,       //LJ
@@ -0,0 +1,279 @@
+#include "PeriodicBoundary.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "SafeOps.h"
+#include "Simd.h"
+
+
+
+
+// Batched minimum image.
+//
+// minimum_image() handles one pair at a time. image_batch() instead takes one atom against a block
+// of partner coordinates held in structure-of-arrays form, so that the imaging of consecutive
+// partners can be done several at a time in vector registers. An AVX-512 or AVX2 kernel is used
+// when the CPU supports it (checked once, at run time), otherwise a scalar loop. Every kernel
+// performs the same operations in the same order as PeriodicBoundary::image_offset() (so that the
+// results do not depend on which one is picked), and falls back on the real displacement wherever
+// the image separation comes out NaN, just as minimum_image() does.
+
+typedef void (*image_kernel)( const PeriodicBoundary &pbc, const double *origin, ImageBatch &batch, int start );
+
+
+
+
+ImageBatch::ImageBatch() {
+	n      = 0;
+	allocd = 0;
+	index  = nullptr;
+	x  = y  = z  = nullptr;
+	dx = dy = dz = nullptr;
+	ix = iy = iz = nullptr;
+	r  = rimg    = nullptr;
+}
+
+
+
+
+ImageBatch::~ImageBatch() {
+	double ** arrays[] = { &x, &y, &z, &dx, &dy, &dz, &ix, &iy, &iz, &r, &rimg };
+
+	for( double **a : arrays )
+		if( *a ) free( *a );
+	if( index ) free( index );
+}
+
+
+
+
+void ImageBatch::reserve( int size ) {
+
+	double ** arrays[] = { &x, &y, &z, &dx, &dy, &dz, &ix, &iy, &iz, &r, &rimg };
+
+	if( size <= allocd )
+		return;
+
+	for( double **a : arrays )
+		SafeOps::realloc( *a, size * sizeof(double), __LINE__, __FILE__ );
+	SafeOps::realloc( index, size * sizeof(int), __LINE__, __FILE__ );
+	allocd = size;
+}
+
+
+
+
+static void image_batch_scalar( const PeriodicBoundary &pbc, const double *origin, ImageBatch &b, int start ) {
+// Also finishes off whatever the vector kernels leave over, from partner start on.
+
+	double d[3], img[3], di[3], r2, ri2;
+
+	for( int k = start; k < b.n; k++ ) {
+
+		d[0] = origin[0] - b.x[k];
+		d[1] = origin[1] - b.y[k];
+		d[2] = origin[2] - b.z[k];
+
+		pbc.image_offset( d, img );
+
+		r2  = 0;
+		ri2 = 0;
+		for( int p = 0; p < 3; p++ ) {
+			di[p] = d[p] - img[p];
+			r2   += d [p]*d [p];
+			ri2  += di[p]*di[p];
+		}
+
+		b.dx[k] = d[0];
+		b.dy[k] = d[1];
+		b.dz[k] = d[2];
+		b.r [k] = sqrt(r2);
+
+		b.rimg[k] = sqrt(ri2);
+		if( isnan(b.rimg[k]) ) {
+			b.rimg[k] = b.r[k];
+			for( int p = 0; p < 3; p++ )
+				di[p] = d[p];
+		}
+		b.ix[k] = di[0];
+		b.iy[k] = di[1];
+		b.iz[k] = di[2];
+	}
+}
+
+
+
+
+#ifdef SIMD_X86
+
+SIMD_TARGET_AVX2 static void image_batch_avx2( const PeriodicBoundary &pbc, const double *origin, ImageBatch &b, int start ) {
+
+	const int     round = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+	const __m256d ox   = _mm256_set1_pd( origin[0] ),
+	              oy   = _mm256_set1_pd( origin[1] ),
+	              oz   = _mm256_set1_pd( origin[2] );
+	__m256d       dx, dy, dz, ix, iy, iz, fx, fy, fz, r, ri, bad;
+	int           k    = start;
+
+	// the rows of basis/reciprocal_basis, broadcast: B[q][p] multiplies component q of the input
+	__m256d B[3][3], R[3][3];
+	for( int p = 0; p < 3; p++ )
+		for( int q = 0; q < 3; q++ ) {
+			B[q][p] = _mm256_set1_pd( pbc.basis[q][p] );
+			R[q][p] = _mm256_set1_pd( pbc.reciprocal_basis[q][p] );
+		}
+	const __m256d lx = _mm256_set1_pd( pbc.box_length[0] ), hx = _mm256_set1_pd( pbc.inverse_box_length[0] ),
+	              ly = _mm256_set1_pd( pbc.box_length[1] ), hy = _mm256_set1_pd( pbc.inverse_box_length[1] ),
+	              lz = _mm256_set1_pd( pbc.box_length[2] ), hz = _mm256_set1_pd( pbc.inverse_box_length[2] );
+
+	for( ; k + 4 <= b.n; k += 4 ) {
+
+		dx = _mm256_sub_pd( ox, _mm256_loadu_pd(b.x + k) );
+		dy = _mm256_sub_pd( oy, _mm256_loadu_pd(b.y + k) );
+		dz = _mm256_sub_pd( oz, _mm256_loadu_pd(b.z + k) );
+
+		if( pbc.orthorhombic ) {
+			ix = _mm256_sub_pd( dx, _mm256_mul_pd( lx, _mm256_round_pd( _mm256_mul_pd(dx, hx), round )));
+			iy = _mm256_sub_pd( dy, _mm256_mul_pd( ly, _mm256_round_pd( _mm256_mul_pd(dy, hy), round )));
+			iz = _mm256_sub_pd( dz, _mm256_mul_pd( lz, _mm256_round_pd( _mm256_mul_pd(dz, hz), round )));
+		} else {
+			fx = _mm256_round_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(R[0][0], dx), _mm256_mul_pd(R[1][0], dy) ), _mm256_mul_pd(R[2][0], dz) ), round );
+			fy = _mm256_round_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(R[0][1], dx), _mm256_mul_pd(R[1][1], dy) ), _mm256_mul_pd(R[2][1], dz) ), round );
+			fz = _mm256_round_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(R[0][2], dx), _mm256_mul_pd(R[1][2], dy) ), _mm256_mul_pd(R[2][2], dz) ), round );
+			ix = _mm256_sub_pd( dx, _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(B[0][0], fx), _mm256_mul_pd(B[1][0], fy) ), _mm256_mul_pd(B[2][0], fz) ));
+			iy = _mm256_sub_pd( dy, _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(B[0][1], fx), _mm256_mul_pd(B[1][1], fy) ), _mm256_mul_pd(B[2][1], fz) ));
+			iz = _mm256_sub_pd( dz, _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(B[0][2], fx), _mm256_mul_pd(B[1][2], fy) ), _mm256_mul_pd(B[2][2], fz) ));
+		}
+
+		r  = _mm256_sqrt_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy) ), _mm256_mul_pd(dz, dz) ));
+		ri = _mm256_sqrt_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(ix, ix), _mm256_mul_pd(iy, iy) ), _mm256_mul_pd(iz, iz) ));
+
+		// image distance result is bad, use actual distance
+		bad = _mm256_cmp_pd( ri, ri, _CMP_UNORD_Q );
+		ri  = _mm256_blendv_pd( ri, r,  bad );
+		ix  = _mm256_blendv_pd( ix, dx, bad );
+		iy  = _mm256_blendv_pd( iy, dy, bad );
+		iz  = _mm256_blendv_pd( iz, dz, bad );
+
+		_mm256_storeu_pd( b.dx   + k, dx );
+		_mm256_storeu_pd( b.dy   + k, dy );
+		_mm256_storeu_pd( b.dz   + k, dz );
+		_mm256_storeu_pd( b.ix   + k, ix );
+		_mm256_storeu_pd( b.iy   + k, iy );
+		_mm256_storeu_pd( b.iz   + k, iz );
+		_mm256_storeu_pd( b.r    + k, r  );
+		_mm256_storeu_pd( b.rimg + k, ri );
+	}
+
+	image_batch_scalar( pbc, origin, b, k );
+}
+
+
+
+
+// The masked forms, with every lane taken from a defined source: the plain _mm512_roundscale_pd and
+// _mm512_sqrt_pd pass an undefined vector through, which GCC then warns may be used uninitialized.
+SIMD_TARGET_AVX512 static inline __m512d round_pd( __m512d v ) {
+	return _mm512_mask_roundscale_pd( v, 0xFF, v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+}
+
+
+
+
+SIMD_TARGET_AVX512 static inline __m512d sqrt_pd( __m512d v ) {
+	return _mm512_mask_sqrt_pd( v, 0xFF, v );
+}
+
+
+
+
+SIMD_TARGET_AVX512 static void image_batch_avx512( const PeriodicBoundary &pbc, const double *origin, ImageBatch &b, int start ) {
+
+	const __m512d ox   = _mm512_set1_pd( origin[0] ),
+	              oy   = _mm512_set1_pd( origin[1] ),
+	              oz   = _mm512_set1_pd( origin[2] );
+	__m512d       dx, dy, dz, ix, iy, iz, fx, fy, fz, r, ri;
+	__mmask8      bad;
+	int           k    = start;
+
+	__m512d B[3][3], R[3][3];
+	for( int p = 0; p < 3; p++ )
+		for( int q = 0; q < 3; q++ ) {
+			B[q][p] = _mm512_set1_pd( pbc.basis[q][p] );
+			R[q][p] = _mm512_set1_pd( pbc.reciprocal_basis[q][p] );
+		}
+	const __m512d lx = _mm512_set1_pd( pbc.box_length[0] ), hx = _mm512_set1_pd( pbc.inverse_box_length[0] ),
+	              ly = _mm512_set1_pd( pbc.box_length[1] ), hy = _mm512_set1_pd( pbc.inverse_box_length[1] ),
+	              lz = _mm512_set1_pd( pbc.box_length[2] ), hz = _mm512_set1_pd( pbc.inverse_box_length[2] );
+
+	for( ; k + 8 <= b.n; k += 8 ) {
+
+		dx = _mm512_sub_pd( ox, _mm512_loadu_pd(b.x + k) );
+		dy = _mm512_sub_pd( oy, _mm512_loadu_pd(b.y + k) );
+		dz = _mm512_sub_pd( oz, _mm512_loadu_pd(b.z + k) );
+
+		if( pbc.orthorhombic ) {
+			ix = _mm512_sub_pd( dx, _mm512_mul_pd( lx, round_pd( _mm512_mul_pd(dx, hx) )));
+			iy = _mm512_sub_pd( dy, _mm512_mul_pd( ly, round_pd( _mm512_mul_pd(dy, hy) )));
+			iz = _mm512_sub_pd( dz, _mm512_mul_pd( lz, round_pd( _mm512_mul_pd(dz, hz) )));
+		} else {
+			fx = round_pd( _mm512_add_pd( _mm512_add_pd( _mm512_mul_pd(R[0][0], dx), _mm512_mul_pd(R[1][0], dy) ), _mm512_mul_pd(R[2][0], dz) ) );
+			fy = round_pd( _mm512_add_pd( _mm512_add_pd( _mm512_mul_pd(R[0][1], dx), _mm512_mul_pd(R[1][1], dy) ), _mm512_mul_pd(R[2][1], dz) ) );
+			fz = round_pd( _mm512_add_pd( _mm512_add_pd( _mm512_mul_pd(R[0][2], dx), _mm512_mul_pd(R[1][2], dy) ), _mm512_mul_pd(R[2][2], dz) ) );
+			ix = _mm512_sub_pd( dx, _mm512_add_pd( _mm512_add_pd( _mm512_mul_pd(B[0][0], fx), _mm512_mul_pd(B[1][0], fy) ), _mm512_mul_pd(B[2][0], fz) ));
+			iy = _mm512_sub_pd( dy, _mm512_add_pd( _mm512_add_pd( _mm512_mul_pd(B[0][1], fx), _mm512_mul_pd(B[1][1], fy) ), _mm512_mul_pd(B[2][1], fz) ));
+			iz = _mm512_sub_pd( dz, _mm512_add_pd( _mm512_add_pd( _mm512_mul_pd(B[0][2], fx), _mm512_mul_pd(B[1][2], fy) ), _mm512_mul_pd(B[2][2], fz) ));
+		}
+
+		r  = sqrt_pd( _mm512_add_pd( _mm512_add_pd( _mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy) ), _mm512_mul_pd(dz, dz) ));
+		ri = sqrt_pd( _mm512_add_pd( _mm512_add_pd( _mm512_mul_pd(ix, ix), _mm512_mul_pd(iy, iy) ), _mm512_mul_pd(iz, iz) ));
+
+		// image distance result is bad, use actual distance
+		bad = _mm512_cmp_pd_mask( ri, ri, _CMP_UNORD_Q );
+		ri  = _mm512_mask_blend_pd( bad, ri, r  );
+		ix  = _mm512_mask_blend_pd( bad, ix, dx );
+		iy  = _mm512_mask_blend_pd( bad, iy, dy );
+		iz  = _mm512_mask_blend_pd( bad, iz, dz );
+
+		_mm512_storeu_pd( b.dx   + k, dx );
+		_mm512_storeu_pd( b.dy   + k, dy );
+		_mm512_storeu_pd( b.dz   + k, dz );
+		_mm512_storeu_pd( b.ix   + k, ix );
+		_mm512_storeu_pd( b.iy   + k, iy );
+		_mm512_storeu_pd( b.iz   + k, iz );
+		_mm512_storeu_pd( b.r    + k, r  );
+		_mm512_storeu_pd( b.rimg + k, ri );
+	}
+
+	image_batch_scalar( pbc, origin, b, k );
+}
+
+
+
+
+#endif // SIMD_X86
+
+
+
+
+static image_kernel select_image_kernel() {
+
+	#ifdef SIMD_X86
+		switch( Simd::isa() ) {
+			case Simd::AVX512: return image_batch_avx512;
+			case Simd::AVX2:   return image_batch_avx2;
+			default:           break;
+		}
+	#endif
+
+	return image_batch_scalar;
+}
+
+
+
+
+void PeriodicBoundary::image_batch( const double *origin, ImageBatch &batch ) const {
+	static const image_kernel kernel = select_image_kernel();
+	kernel( *this, origin, batch, 0 );
+}
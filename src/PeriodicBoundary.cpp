@@ -18,6 +18,13 @@ PeriodicBoundary::PeriodicBoundary() {
 			basis[i][j]            = 0.0;  // unit cell lattice (A)
 			reciprocal_basis[i][j] = 0.0;  // reciprocal space lattice (1/A)
 		}
+
+	orthorhombic = 0;
+	cubic        = 0;
+	for( int i=0; i<3; i++ ) {
+		box_length        [i] = 0.0;
+		inverse_box_length[i] = 0.0;
+	}
 }
 
 PeriodicBoundary::~PeriodicBoundary() { }
@@ -90,6 +97,28 @@ void PeriodicBoundary::compute_reciprocal() {
 	reciprocal_basis[2][1] = inverse_volume*(basis[0][1]*basis[2][0] - basis[0][0]*basis[2][1]);
 	reciprocal_basis[2][2] = inverse_volume*(basis[0][0]*basis[1][1] - basis[0][1]*basis[1][0]);
 
+	classify_cell();
+}
+
+
+
+// detect orthorhombic (and cubic) cells, for which the minimum image needs no matrix products
+void PeriodicBoundary::classify_cell() {
+
+	orthorhombic = 1;
+	for( int i=0; i<3; i++ )
+		for( int j=0; j<3; j++ )
+			if( (i != j) && (basis[i][j] != 0.0) )
+				orthorhombic = 0;
+
+	// the inverse lengths are taken from reciprocal_basis, so that both paths round identically
+	for( int i=0; i<3; i++ ) {
+		box_length        [i] = basis[i][i];
+		inverse_box_length[i] = reciprocal_basis[i][i];
+	}
+
+	cubic = orthorhombic  &&  (box_length[0] == box_length[1])  &&  (box_length[0] == box_length[2])
+	                      &&  (inverse_box_length[0] == inverse_box_length[1])  &&  (inverse_box_length[0] == inverse_box_length[2]);
 }
 
 void PeriodicBoundary::printboxdim() {
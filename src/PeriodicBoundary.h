@@ -1,4 +1,40 @@
 #pragma once
+
+#include <math.h>
+
+
+
+// Structure-of-arrays scratch for PeriodicBoundary::image_batch(). The coordinates of each partner
+// are pushed in, and the displacements (origin - partner) and separations come out.
+class ImageBatch
+{
+public:
+	ImageBatch();
+	~ImageBatch();
+	ImageBatch( const ImageBatch & ) = delete;
+	ImageBatch & operator=( const ImageBatch & ) = delete;
+
+	int      n,                 // number of partners queued
+	         allocd;
+	int    * index;             // caller's tag for each partner (e.g. its index in atom_array)
+	double * x,  * y,  * z,     // partner coordinates
+	       * dx, * dy, * dz,    // real displacement
+	       * ix, * iy, * iz,    // minimum image displacement (the real one, if imaging failed)
+	       * r,  * rimg;        // lengths of the above
+
+	void reserve( int size );   // room for size partners; contents are not preserved
+
+	inline void push( const double *pos, int tag ) {
+		x    [n] = pos[0];
+		y    [n] = pos[1];
+		z    [n] = pos[2];
+		index[n] = tag;
+		n++;
+	}
+};
+
+
+
 class PeriodicBoundary
 {
 public:
@@ -9,12 +45,88 @@ public:
 	double volume;                     // unit cell volume (A^3) 
 	double basis           [ 3 ][ 3 ]; // unit cell lattice (A)
 	double reciprocal_basis[ 3 ][ 3 ]; // reciprocal space lattice (1/A)
+	int    orthorhombic,               // Flag: the lattice vectors lie along the cartesian axes
+	       cubic;                      // Flag: ...and are all of the same length
+	double box_length        [ 3 ],    // orthorhombic cells: length of each lattice vector (A)
+	       inverse_box_length[ 3 ];    // ...and the diagonal of reciprocal_basis (1/A)
 
 	void   update();
 	double compute_volume();      // takes the determinant of the basis matrix
 	void   compute_reciprocal();  // computes the reciprocal space basis
 	double compute_cutoff();      // calculates the min cutoff radius from the basis lattice (AKA shortest vector problem)
+	void   classify_cell();       // sets orthorhombic/cubic and the box lengths (called by compute_reciprocal())
 	void   printboxdim();
 
-};
+	// minimum image of origin against every partner in batch (PeriodicBoundary.Batch.cpp)
+	void   image_batch( const double *origin, ImageBatch &batch ) const;
+
+
 
+	// The lattice vector nearest to x, i.e. x - offset is the minimum image of x. Orthorhombic cells
+	// skip both matrix products, scaling and rounding each axis on its own.
+	inline void image_offset( const double *x, double *offset ) const {
+
+		if( cubic ) {
+			for( int p = 0; p < 3; p++ )
+				offset[p] = box_length[0] * rint( x[p] * inverse_box_length[0] );
+
+		} else if( orthorhombic ) {
+			for( int p = 0; p < 3; p++ )
+				offset[p] = box_length[p] * rint( x[p] * inverse_box_length[p] );
+
+		} else {
+			double img[3];
+
+			// project into the reciprocal basis and round
+			for( int p = 0; p < 3; p++ ) {
+				img[p] = 0;
+				for( int q = 0; q < 3; q++ )
+					img[p] += reciprocal_basis[q][p] * x[q];
+				img[p] = rint(img[p]);
+			}
+
+			// project back into our basis
+			for( int p = 0; p < 3; p++ ) {
+				offset[p] = 0;
+				for( int q = 0; q < 3; q++ )
+					offset[p] += basis[q][p] * img[q];
+			}
+		}
+	}
+
+
+
+	// fractional coordinates of the cartesian point x
+	inline void cart_to_frac( const double *x, double *frac ) const {
+
+		if( orthorhombic ) {
+			for( int p = 0; p < 3; p++ )
+				frac[p] = x[p] * inverse_box_length[p];
+		} else {
+			// we use transpose(recip_basis), because transpose(recip_basis).basis_vector = <1,0,0> , <0,1,0> or <0,0,1>
+			for( int p = 0; p < 3; p++ ) {
+				frac[p] = 0;
+				for( int q = 0; q < 3; q++ )
+					frac[p] += reciprocal_basis[q][p] * x[q];
+			}
+		}
+	}
+
+
+
+	// cartesian coordinates of the fractional point frac
+	inline void frac_to_cart( const double *frac, double *x ) const {
+
+		if( orthorhombic ) {
+			for( int p = 0; p < 3; p++ )
+				x[p] = frac[p] * box_length[p];
+		} else {
+			for( int p = 0; p < 3; p++ ) {
+				x[p] = 0;
+				for( int q = 0; q < 3; q++ )
+					x[p] += basis[q][p] * frac[q];
+			}
+		}
+	}
+
+};
@@ -0,0 +1,59 @@
+#include "Simd.h"
+
+#if defined(SIMD_X86) && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+
+
+
+Simd::Isa Simd::isa() {
+	static const Isa selected = detect();
+	return selected;
+}
+
+
+
+
+const char * Simd::isa_name() {
+
+	switch( isa() ) {
+		case AVX512: return "AVX-512";
+		case AVX2:   return "AVX2";
+		default:     return "scalar";
+	}
+}
+
+
+
+
+Simd::Isa Simd::detect() {
+// AVX2 (or AVX-512F) in the CPU, and the OS saving the wider registers on context switches
+
+	#if defined(SIMD_X86) && defined(_MSC_VER)
+		int                regs[4];
+		unsigned long long xcr0;
+
+		__cpuid( regs, 1 );
+		if( !(regs[2] & (1 << 27)) )  // OSXSAVE
+			return SCALAR;
+		xcr0 = _xgetbv(0);
+		if( (xcr0 & 0x6) != 0x6 )     // XMM and YMM state
+			return SCALAR;
+
+		__cpuidex( regs, 7, 0 );
+		if( (regs[1] & (1 << 16))  &&  ((xcr0 & 0xE6) == 0xE6) )  // ...and the opmask/ZMM state
+			return AVX512;
+		if( regs[1] & (1 << 5) )
+			return AVX2;
+
+	#elif defined(SIMD_X86)
+		__builtin_cpu_init();
+		if( __builtin_cpu_supports("avx512f") )
+			return AVX512;
+		if( __builtin_cpu_supports("avx2") )
+			return AVX2;
+	#endif
+
+	return SCALAR;
+}
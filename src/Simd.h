@@ -0,0 +1,46 @@
+#pragma once
+
+
+// Run-time selection of vector instruction sets.
+//
+// Kernels with AVX2/AVX-512 versions are compiled for those instruction sets individually (via
+// SIMD_TARGET_AVX2/SIMD_TARGET_AVX512), whatever the flags for the rest of the build. Which one
+// is actually run is decided by Simd::isa(), from what the CPU and OS support.
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+	#define SIMD_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#define SIMD_TARGET_AVX2
+		#define SIMD_TARGET_AVX512
+	#elif defined(__clang__)
+		#define SIMD_TARGET_AVX2   __attribute__((target("avx2")))
+		#define SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+	#else
+		// AVX-512F brings FMA along with it, and GCC would otherwise fuse the multiplies and adds,
+		// so that the results would depend on the instruction set
+		#define SIMD_TARGET_AVX2   __attribute__((target("avx2")))
+		#define SIMD_TARGET_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off")))
+	#endif
+#endif
+
+
+class Simd
+{
+	Simd() {};
+	~Simd() {};
+
+public:
+
+	enum Isa {
+		SCALAR,
+		AVX2,
+		AVX512
+	};
+
+	static Isa          isa();       // the widest instruction set usable on this machine
+	static const char * isa_name();
+
+private:
+	static Isa detect();
+};
@@ -80,6 +80,7 @@ void SimulationControl::initialize_Gibbs_systems() {
 
 		if (!systems[i]->use_sg || systems[i]->rd_only)
 		{
+			systems[i]->ewald_tune(); // if ewald_precision is set
 			sprintf(linebuf, "SIM_CONTROL, SYS %d: Ewald gaussian width = %f A\n", i, systems[i]->ewald_alpha);
 			Output::out(linebuf);
 			sprintf(linebuf, "SIM_CONTROL, SYS %d: Ewald kmax = %d\n", i, systems[i]->ewald_kmax);
@@ -160,6 +161,10 @@ bool SimulationControl::Gibbs_mc() {
 	System::backup_observables(systems);
 	move = System::pick_Gibbs_move(systems);
 
+	// every move below marks the molecules it perturbs, so pairs() need only revisit those (see mc())
+	for (int i = 0; i < 2; i++)
+		systems[i]->dirty_tracking = !systems[i]->spectre;
+
 	int s = 1;
 	int max_step = systems[0]->numsteps;
 
@@ -178,8 +183,12 @@ bool SimulationControl::Gibbs_mc() {
 
 
 		// calculate the energy change/boltzmann factor
-		final_energy[0] = systems[0]->energy();
-		final_energy[1] = systems[1]->energy();
+		for (int i = 0; i < 2; i++) {
+			if (systems[i]->use_delta_energy)
+				final_energy[i] = systems[i]->delta_energy(systems[i]->checkpoint->molecule_altered);
+			else
+				final_energy[i] = systems[i]->energy();
+		}
 
 #ifdef QM_ROTATION
 		// solve for the rotational energy levels 
@@ -85,6 +85,11 @@ bool SimulationControl::PI_nvt_mc() {
 	System::backup_observables( systems );
 	move = PI_pick_NVT_move();
 
+	// every move below marks the molecule it perturbs in each bead, so pairs() need only revisit those
+	std::for_each( systems.begin(), systems.end(), [](System *SYS) {
+		SYS->dirty_tracking = !SYS->spectre;
+	});
+
 
 	// main MC loop 
 	for( sys.step=1; sys.step <= nSteps; sys.step++ ) {
@@ -450,7 +455,7 @@ double SimulationControl::PI_NVT_boltzmann_factor( double delta_energy, double d
 
 		// calculate a boltzmann factor for a bead perturbation
 		std::map<std::string, int>::iterator it;
-		it = sorbate_data_index.find(systems[rank]->checkpoint->molecule_altered->moleculetype);
+		it = sorbate_data_index.find(systems[rank]->checkpoint->molecule_altered->moleculetype());
 		if (it == sorbate_data_index.end()) {
 
 			// COM-only case (sorbate metadata not found)
@@ -595,6 +600,7 @@ void SimulationControl::initialize_PI_NVT_Systems() {
 		systems[i]->allocate_pair_lists();
 		systems[i]->pairs();          // get all of the pairwise interactions, exclusions, etc.
 		systems[i]->flag_all_pairs(); // set all pairs to initially have their energies calculated 
+		systems[i]->ewald_tune();     // if ewald_precision is set
 		
 		
 		// if polarization active, allocate the necessary matrices 
@@ -654,7 +660,7 @@ void SimulationControl::write_PI_frame() {
 			for (int s = 0; s < nSys; s++) {
 				for (m = systems[s]->molecules; m; m = m->next) {
 					for (a = m->atoms; a; a = a->next) {
-						fprintf(outFile, "%s     %0.4lf     %0.4lf     %0.4lf\n", a->atomtype, a->pos[0], a->pos[1], a->pos[2]);
+						fprintf(outFile, "%s     %0.4lf     %0.4lf     %0.4lf\n", a->atomtype(), a->pos[0], a->pos[1], a->pos[2]);
 					}
 				}
 			}
@@ -679,7 +685,10 @@ double SimulationControl::PI_system_energy() {
 	
 
 	if( mpi ) {
-		energy = systems[rank]->energy();
+		if( systems[rank]->use_delta_energy )
+			energy = systems[rank]->delta_energy( systems[rank]->checkpoint->molecule_altered );
+		else
+			energy = systems[rank]->energy();
 		#ifdef _MPI
 			MPI_Allgather( &energy, 1, MPI_DOUBLE, system_energies, 1, MPI_DOUBLE, MPI_COMM_WORLD);
 		#endif
@@ -702,8 +711,12 @@ double SimulationControl::PI_system_energy() {
 
 	// For single-threaded systems, energy computations happen on every system
 	// This is done in two passes so that energy values will be populated in all systems...
-	for( int s=0; s < PI_nBeads; s++ )
-		system_energies[s] = systems[s]->energy();
+	for( int s=0; s < PI_nBeads; s++ ) {
+		if( systems[s]->use_delta_energy )
+			system_energies[s] = systems[s]->delta_energy( systems[s]->checkpoint->molecule_altered );
+		else
+			system_energies[s] = systems[s]->energy();
+	}
 
 	// ...and on the second pass energies are summed and checked for infinite values.
 	for( int s=0; s < PI_nBeads; s++) {
@@ -841,9 +854,9 @@ double SimulationControl::PI_orientational_distance() {
 
 	
 	std::vector<Vector3D> bond_vectors;
-	char *moleculeID = systems[rank]->checkpoint->molecule_altered->moleculetype;
-	int    orientation_site = SimulationControl::get_orientation_site( moleculeID );
-	double bond_length      = SimulationControl::get_bond_length(      moleculeID );
+	const char * moleculeID       = systems[rank]->checkpoint->molecule_altered->moleculetype();
+	int          orientation_site = SimulationControl::get_orientation_site( moleculeID );
+	double       bond_length      = SimulationControl::get_bond_length(      moleculeID );
 	if (  (orientation_site < 0)   ||   (bond_length <= 0)  )
 		return 0.0;
 
@@ -943,8 +956,6 @@ int SimulationControl::PI_pick_NVT_move() {
 
 		// if we have a molecule already backed up (from a previous accept), go ahead and free it
 		if (systems[s]->checkpoint->molecule_backup) {
-			// clear the references to the pair list, so that they aren't deleted in the process 
-			systems[s]->checkpoint->molecule_backup->wipe_pair_refs();
 			delete systems[s]->checkpoint->molecule_backup;
 			systems[s]->checkpoint->molecule_backup = nullptr;
 		}
@@ -999,6 +1010,11 @@ void SimulationControl::PI_make_move(int movetype) {
 			Output::err("MC_MOVES: invalid mc move\n");
 			throw invalid_monte_carlo_move;
 	}
+
+	// each move alters only the targeted molecule, in every bead
+	std::for_each(systems.begin(), systems.end(), [](System *SYS) {
+		SYS->checkpoint->molecule_altered->dirty = 1;
+	});
 }
 
 
@@ -1088,18 +1104,7 @@ void SimulationControl::PI_insert() {
 			checkpoint->molecule_backup = nullptr;
 
 			if (num_insertion_molecules) { //multi sorbate
-				// Free all pair memory in the list
-				for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
-					for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
-						pair_ptr = atom_ptr->pairs;
-						while (pair_ptr) {
-							Pair *temp = pair_ptr;
-							pair_ptr = pair_ptr->next;
-							free(temp);
-						}
-					}
-				}
-				// Generate new pairs lists for all atoms in system
+				// Generate new pairs lists for all atoms in system (the old lists are freed along the way)
 				allocate_pair_lists();
 			} // only one sorbate
 			else
@@ -1383,9 +1388,9 @@ void SimulationControl::PI_perturb_bead_COMs(int n) {
 
 
 void SimulationControl::PI_perturb_beads_orientations() {
-	char * moleculeID       = systems[0]->checkpoint->molecule_altered->moleculetype;
-	int    orientation_site = SimulationControl::get_orientation_site(moleculeID);
-	double bond_length      = SimulationControl::get_bond_length(moleculeID);
+	const char * moleculeID       = systems[0]->checkpoint->molecule_altered->moleculetype();
+	int          orientation_site = SimulationControl::get_orientation_site(moleculeID);
+	double       bond_length      = SimulationControl::get_bond_length(moleculeID);
 
 	// Exit early if requisite orientation data is not present
 	if (  (orientation_site < 0)  ||  (bond_length <= 0)  )
@@ -1400,18 +1405,18 @@ void SimulationControl::PI_perturb_beads_orientations() {
 
 void SimulationControl::generate_orientation_configs() {
 	
-	double sorbate_reduced_mass = SimulationControl::get_reduced_mass(systems[0]->checkpoint->molecule_altered->moleculetype);
+	double sorbate_reduced_mass = SimulationControl::get_reduced_mass(systems[0]->checkpoint->molecule_altered->moleculetype());
 	if (sorbate_reduced_mass < 0) {
 		char buffer[maxLine];
-		sprintf(buffer, "No reduced mass specified for moveable/sorbate molecule \"%s\"\n", systems[0]->checkpoint->molecule_altered->moleculetype);
+		sprintf(buffer, "No reduced mass specified for moveable/sorbate molecule \"%s\"\n", systems[0]->checkpoint->molecule_altered->moleculetype());
 		Output::err(buffer);
 		throw missing_required_datum;
 	}
 	
-	double sorbate_bond_length = SimulationControl::get_bond_length(systems[0]->checkpoint->molecule_altered->moleculetype);
+	double sorbate_bond_length = SimulationControl::get_bond_length(systems[0]->checkpoint->molecule_altered->moleculetype());
 	if (sorbate_bond_length < 0) {
 		char buffer[maxLine];
-		sprintf(buffer, "No bond length specified for moveable/sorbate molecule \"%s\"\n", systems[0]->checkpoint->molecule_altered->moleculetype);
+		sprintf(buffer, "No bond length specified for moveable/sorbate molecule \"%s\"\n", systems[0]->checkpoint->molecule_altered->moleculetype());
 		Output::err(buffer);
 		throw missing_required_datum;
 	}
@@ -1515,7 +1520,7 @@ void SimulationControl::apply_orientation_configs() {
 	int nSystems = (int) systems.size();
 
 	// Impose the orientational perturbations we've computed onto the actual system representations
-	int orientation_site = SimulationControl::get_orientation_site( systems[0]->checkpoint->molecule_altered->moleculetype );
+	int orientation_site = SimulationControl::get_orientation_site( systems[0]->checkpoint->molecule_altered->moleculetype() );
 	if (orientation_site < 0)
 		return; // Molecule has no "handle" specified, and so is will not be re-oriented. 
 	for (int s = 0; s < nSystems; s++) {
@@ -61,6 +61,9 @@ SimulationControl::SimulationControl(char *inFilename, bool rAR, bool writeFrame
 		Output::err("SIM_CONTROL: input file has failed validation.\n");
 		throw invalid_input;
 	}
+	sys.energy_pipeline_select();    // Resolve the force-field configuration to a specialized energy kernel.
+	sys.spline_tables_init();        // Tabulate erfc/exp, if spline_tolerance is set.
+	sys.pair_tables_init();          // Choose the pair kernels to tabulate, if pair_table_tolerance is set.
 
 	orientations.resize(size); // allocate space for one orientation vector per bead
 
@@ -164,9 +167,13 @@ void SimulationControl::initializeSimulationObjects() {
 
 			if(  ! sys.use_sg   ||   sys.rd_only  ) 
 			{
+				sys.ewald_tune(); // if ewald_precision is set
 				sprintf(linebuf, "SIM_CONTROL: Ewald gaussian width = %f A\n", sys.ewald_alpha);
 				Output::out(linebuf);
-				sprintf(linebuf, "SIM_CONTROL: Ewald kmax = %d\n", sys.ewald_kmax);
+				if( sys.ewald_spme )
+					sprintf(linebuf, "SIM_CONTROL: Ewald reciprocal sum by SPME, tolerance = %.2e\n", sys.ewald_spme_tolerance);
+				else
+					sprintf(linebuf, "SIM_CONTROL: Ewald kmax = %d\n", sys.ewald_kmax);
 				Output::out(linebuf);
 			}
 
@@ -1000,6 +1007,19 @@ bool SimulationControl::process_command( char token[maxTokens][maxLine] ) {
 		else return fail;
 		return ok;
 	}
+	if( SafeOps::iequals(token[0], "delta_energy") ) {
+		if( SafeOps::iequals(token[1], "on") )
+			sys.use_delta_energy = 1;
+		else if( SafeOps::iequals(token[1], "off") )
+			sys.use_delta_energy = 0;
+		else return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "delta_energy_refresh") ) {
+		if(  ! SafeOps::atoi(token[1], sys.delta_energy_refresh )  )
+			return fail;
+		return ok;
+	}
 	if( SafeOps::iequals(token[0], "rd_crystal") ) {
 		if( SafeOps::iequals(token[1], "on") )
 			sys.rd_crystal = 1;
@@ -1013,6 +1033,19 @@ bool SimulationControl::process_command( char token[maxTokens][maxLine] ) {
 			return fail;
 		return ok;
 	}
+	if( SafeOps::iequals(token[0], "rd_crystal_ewald") ) {
+		if( SafeOps::iequals(token[1], "on") )
+			sys.rd_crystal_ewald = 1;
+		else if( SafeOps::iequals(token[1], "off"))
+			sys.rd_crystal_ewald = 0;
+		else return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "rd_crystal_ewald_tolerance") ) {
+		if( !SafeOps::atod(token[1], sys.rd_crystal_ewald_tolerance) )
+			return fail;
+		return ok;
+	}
 	if( SafeOps::iequals(token[0], "rd_anharmonic") ) {
 		if( SafeOps::iequals(token[1], "on") )
 			sys.rd_anharmonic = 1;
@@ -1142,6 +1175,11 @@ bool SimulationControl::process_command( char token[maxTokens][maxLine] ) {
 		else return fail;
 		return ok;
 	}
+	if( SafeOps::iequals(token[0], "axilrod_teller_cutoff") ) {
+		if( !SafeOps::atod(token[1], sys.axilrod_teller_cutoff) )
+			return fail;
+		return ok;
+	}
 	if( SafeOps::iequals(token[0], "midzuno_kihara_approx") ) {
 		if( SafeOps::iequals(token[1], "on") )
 			sys.midzuno_kihara_approx = 1;
@@ -1184,6 +1222,63 @@ bool SimulationControl::process_command( char token[maxTokens][maxLine] ) {
 			return fail;
 		return ok;
 	}
+	if( SafeOps::iequals(token[0], "ewald_spme") ) {
+		if( SafeOps::iequals(token[1], "on") )
+			sys.ewald_spme = 1;
+		else if( SafeOps::iequals(token[1], "off") )
+			sys.ewald_spme = 0;
+		else return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "ewald_retune") ) {
+		if( SafeOps::iequals(token[1], "on") )
+			sys.ewald_retune = 1;
+		else if( SafeOps::iequals(token[1], "off") )
+			sys.ewald_retune = 0;
+		else return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "ewald_precision") ) {
+		if( !SafeOps::atod(token[1], sys.ewald_precision) )
+			return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "ewald_spme_tolerance") ) {
+		if( !SafeOps::atod(token[1], sys.ewald_spme_tolerance) )
+			return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "cell_list") ) {
+		if( SafeOps::iequals(token[1], "on") )
+			sys.cell_list = 1;
+		else if( SafeOps::iequals(token[1], "off") )
+			sys.cell_list = 0;
+		else return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "verlet_list") ) {
+		if( SafeOps::iequals(token[1], "on") )
+			sys.verlet_list = 1;
+		else if( SafeOps::iequals(token[1], "off") )
+			sys.verlet_list = 0;
+		else return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "verlet_skin") ) {
+		if(  ! SafeOps::atod(token[1], sys.verlet_skin )  )
+			return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "spline_tolerance") ) {
+		if(  ! SafeOps::atod(token[1], sys.spline_tolerance )  )
+			return fail;
+		return ok;
+	}
+	if( SafeOps::iequals(token[0], "pair_table_tolerance") ) {
+		if(  ! SafeOps::atod(token[1], sys.pair_table_tolerance )  )
+			return fail;
+		return ok;
+	}
 	if( SafeOps::iequals(token[0], "pbc_cutoff") ) {
 		if(  ! SafeOps::atod(token[1], sys.pbc.cutoff )  )
 			return fail;
@@ -1680,7 +1775,11 @@ bool SimulationControl::check_system() {
 		Output::out1("SIM_CONTROL: rd long-range corrections are ON\n");
 	else 
 		Output::out1("SIM_CONTROL: rd long-range corrections are OFF\n");
-	if( sys.rd_crystal ) {
+	if( sys.rd_crystal_ewald ) {
+		if( ! check_rd_crystal_ewald_options() )
+			return fail;
+	}
+	else if( sys.rd_crystal ) {
 		if( sys.rd_crystal_order <= 0 ) {
 			Output::err("SIM_CONTROL: rd crystal order must be positive\n");
 			return fail;
@@ -1769,6 +1868,40 @@ bool SimulationControl::check_system() {
 		#endif // CUDA 
 	}
 
+	if( sys.cell_list   &&   ! check_cell_list_options() )
+		return fail;
+
+	if( sys.verlet_list   &&   ! check_verlet_list_options() )
+		return fail;
+
+	if( sys.use_delta_energy   &&   ! check_delta_energy_options() )
+		return fail;
+
+	if( sys.axilrod_teller_cutoff < 0.0 ) {
+		Output::err("SIM_CONTROL: axilrod_teller_cutoff must be positive (or 0, for no cutoff)\n");
+		return fail;
+	}
+
+	if(  (sys.ewald_precision < 0.0)  ||  ((sys.ewald_precision > 0.0) && (sys.ewald_alpha_set || sys.wolf))  ) {
+		Output::err("SIM_CONTROL: ewald_precision must be positive, and chooses ewald_alpha and ewald_kmax itself (it can't be used with wolf)\n");
+		return fail;
+	}
+
+	if(  sys.ewald_spme  &&  ((sys.ewald_spme_tolerance <= 0.0) || (sys.ewald_spme_tolerance >= 1.0))  ) {
+		Output::err("SIM_CONTROL: ewald_spme_tolerance must be between 0 and 1\n");
+		return fail;
+	}
+
+	if( sys.spline_tolerance < 0.0 ) {
+		Output::err("SIM_CONTROL: spline_tolerance must be positive (or 0, to call erfc/exp directly)\n");
+		return fail;
+	}
+
+	if( sys.pair_table_tolerance < 0.0 ) {
+		Output::err("SIM_CONTROL: pair_table_tolerance must be positive (or 0, to evaluate the pair kernels directly)\n");
+		return fail;
+	}
+
 	if( sys.rd_anharmonic ) {
 		if( !sys.rd_only ) {
 			Output::err("SIM_CONTROL: rd_anharmonic being set requires rd_only\n");
@@ -2447,6 +2580,126 @@ bool SimulationControl::check_io_files_options() {
 
 
 
+bool SimulationControl::check_cell_list_options() {
+// The cell list dismisses pairs that are beyond the cutoff without imaging them, so it may only be
+// used when every pairwise term is truncated at pbc.cutoff.
+
+	if( sys.ensemble == ENSEMBLE_SURF   ||   sys.ensemble == ENSEMBLE_SURF_FIT ) {
+		Output::err("SIM_CONTROL: cell_list requires periodic boundary conditions\n");
+		return fail;
+	}
+	if( sys.polarization   ||   sys.polarvdw   ||   sys.disp_expansion_mbvdw ) {
+		Output::err("SIM_CONTROL: cell_list is incompatible with polarization/polarvdw/disp_expansion_mbvdw (the dipole matrix spans all pairs)\n");
+		return fail;
+	}
+	if( sys.rd_crystal ) {
+		Output::err("SIM_CONTROL: cell_list is incompatible with rd_crystal\n");
+		return fail;
+	}
+	if( sys.spectre   ||   sys.gwp ) {
+		Output::err("SIM_CONTROL: cell_list is incompatible with spectre and gwp\n");
+		return fail;
+	}
+
+	Output::out1("SIM_CONTROL: linked-cell neighbor search active\n");
+	return ok;
+}
+
+
+
+
+bool SimulationControl::check_verlet_list_options() {
+// The neighbor lists are only consulted by the cutoff-limited pair kernels, and only remain valid
+// while every atom has moved less than half the skin.
+
+	char linebuf[maxLine];
+
+	if( sys.verlet_skin <= 0.0 ) {
+		Output::err("SIM_CONTROL: verlet_skin must be positive\n");
+		return fail;
+	}
+	if( sys.ensemble == ENSEMBLE_SURF   ||   sys.ensemble == ENSEMBLE_SURF_FIT ) {
+		Output::err("SIM_CONTROL: verlet_list requires periodic boundary conditions\n");
+		return fail;
+	}
+	if( sys.rd_crystal ) {
+		Output::err("SIM_CONTROL: verlet_list is incompatible with rd_crystal\n");
+		return fail;
+	}
+	if( sys.spectre   ||   sys.gwp ) {
+		Output::err("SIM_CONTROL: verlet_list is incompatible with spectre and gwp\n");
+		return fail;
+	}
+
+	sprintf( linebuf, "SIM_CONTROL: Verlet neighbor lists active (skin = %.3f A)\n", sys.verlet_skin );
+	Output::out1( linebuf );
+	return ok;
+}
+
+
+
+
+bool SimulationControl::check_delta_energy_options() {
+// Single-molecule moves are evaluated incrementally only for pairwise-additive potentials; the
+// many-body terms need the whole system every step.
+
+	char linebuf[maxLine];
+
+	if( sys.delta_energy_refresh < 1 ) {
+		Output::err("SIM_CONTROL: delta_energy_refresh must be at least 1\n");
+		return fail;
+	}
+	if( sys.polarization   ||   sys.polarvdw   ||   sys.using_axilrod_teller   ||   sys.cavity_autoreject_absolute ) {
+		Output::err("SIM_CONTROL: delta_energy is incompatible with polarization/polarvdw/axilrod_teller/cavity_autoreject_absolute\n");
+		return fail;
+	}
+	if( sys.rd_anharmonic || sys.use_sg || sys.use_dreiding || sys.using_lj_buffered_14_7 || sys.using_disp_expansion || sys.rd_crystal ) {
+		Output::err("SIM_CONTROL: delta_energy supports only the lj and exp_repulsion repulsion/dispersion models\n");
+		return fail;
+	}
+	if( sys.spectre   ||   sys.gwp   ||   sys.wolf ) {
+		Output::err("SIM_CONTROL: delta_energy is incompatible with spectre, gwp and wolf\n");
+		return fail;
+	}
+
+	sprintf( linebuf, "SIM_CONTROL: delta-energy evaluation of single-molecule moves active (full recalculation every %d)\n", sys.delta_energy_refresh );
+	Output::out1( linebuf );
+	return ok;
+}
+
+
+
+
+bool SimulationControl::check_rd_crystal_ewald_options() {
+// The Ewald lattice sums replace the image loops of lj() only, and only its plain 12-6 form.
+
+	char linebuf[maxLine];
+
+	if( ! sys.rd_crystal ) {
+		Output::err("SIM_CONTROL: rd_crystal_ewald requires rd_crystal\n");
+		return fail;
+	}
+	if( (sys.rd_crystal_ewald_tolerance <= 0.0)  ||  (sys.rd_crystal_ewald_tolerance >= 1.0) ) {
+		Output::err("SIM_CONTROL: rd_crystal_ewald_tolerance must be between 0 and 1\n");
+		return fail;
+	}
+	if( sys.rd_anharmonic || sys.use_sg || sys.use_dreiding || sys.using_lj_buffered_14_7 || sys.using_disp_expansion || sys.cdvdw_exp_repulsion ) {
+		Output::err("SIM_CONTROL: rd_crystal_ewald supports only the lj repulsion/dispersion model\n");
+		return fail;
+	}
+	if( sys.spectre   ||   sys.gwp   ||   sys.polarvdw   ||   sys.cdvdw_sig_repulsion   ||   sys.feynman_hibbs ) {
+		Output::err("SIM_CONTROL: rd_crystal_ewald is incompatible with spectre, gwp, polarvdw, cdvdw_sig_repulsion and feynman_hibbs\n");
+		return fail;
+	}
+
+	sprintf( linebuf, "SIM_CONTROL: rd crystal lattice sums by Ewald summation (tolerance = %.2e)\n", sys.rd_crystal_ewald_tolerance );
+	Output::out1( linebuf );
+	return ok;
+}
+
+
+
+
 bool SimulationControl::check_feynman_hibbs_options( ) {
 
 	char linebuf[maxLine];
@@ -79,6 +79,10 @@ private:
 	bool check_mc_options();
 	bool check_spectre_options();
 	bool check_io_files_options();
+	bool check_cell_list_options();
+	bool check_verlet_list_options();
+	bool check_delta_energy_options();
+	bool check_rd_crystal_ewald_options();
 	bool check_feynman_hibbs_options();
 	bool check_simulated_annealing_options();
 	bool check_hist_options();
@@ -0,0 +1,160 @@
+#include "SplineTable.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SafeOps.h"
+
+
+
+// the finest table build() will make (32 MB of coefficients)
+static const int max_intervals = 1 << 20;
+
+
+
+
+SplineTable::SplineTable() {
+	intervals       = 0;
+	x_min           = 0;
+	x_max           = 0;
+	spacing         = 0;
+	max_error       = 0;
+	inverse_spacing = 0;
+	coef            = nullptr;
+}
+
+
+
+
+SplineTable::~SplineTable() {
+	clear();
+}
+
+
+
+
+SplineTable::SplineTable( const SplineTable &other ) : SplineTable() {
+	*this = other;
+}
+
+
+
+
+SplineTable & SplineTable::operator=( const SplineTable &other ) {
+
+	if( this == &other )
+		return *this;
+
+	clear();
+	intervals       = other.intervals;
+	x_min           = other.x_min;
+	x_max           = other.x_max;
+	spacing         = other.spacing;
+	max_error       = other.max_error;
+	inverse_spacing = other.inverse_spacing;
+
+	if( other.coef ) {
+		SafeOps::malloc( coef, 4 * intervals * sizeof(double), __LINE__, __FILE__ );
+		memcpy( coef, other.coef, 4 * intervals * sizeof(double) );
+	}
+	return *this;
+}
+
+
+
+
+void SplineTable::clear() {
+
+	if( coef ) free( coef );
+
+	coef      = nullptr;
+	intervals = 0;
+}
+
+
+
+
+bool SplineTable::build( function f, function df, const double *param, double lower, double upper, double tolerance ) {
+// Tabulate f (whose derivative is df) over [lower, upper). Returns false if the tolerance could not
+// be met, in which case the finest table tried is kept, and max_error says how close it came.
+
+	x_min = lower;
+	x_max = upper;
+
+	for( int n = 16; ; n *= 2 ) {
+		fill( f, df, param, n );
+		max_error = worst_error( f, param );
+		if( max_error <= tolerance )
+			return true;
+		if( 2*n > max_intervals )
+			return false;
+	}
+}
+
+
+
+
+void SplineTable::fill( function f, function df, const double *param, int n ) {
+// Cubic Hermite segments through the values and slopes of f at n+1 evenly spaced knots.
+
+	double x1, y0, y1, m0, m1;
+
+	clear();
+	intervals       = n;
+	spacing         = (x_max - x_min) / n;
+	inverse_spacing = n / (x_max - x_min);
+	SafeOps::malloc( coef, 4 * n * sizeof(double), __LINE__, __FILE__ );
+
+	x1 = x_min;
+	y1 = f    ( x1, param );
+	m1 = slope( f, df, param, x1 ) * spacing;  // slopes with respect to t
+	for( int i = 0; i < n; i++ ) {
+		y0 = y1;
+		m0 = m1;
+		x1 = x_min + (i + 1) * spacing;
+		y1 = f    ( x1, param );
+		m1 = slope( f, df, param, x1 ) * spacing;
+
+		coef[4*i    ] = y0;
+		coef[4*i + 1] = m0;
+		coef[4*i + 2] = 3.0*(y1 - y0) - 2.0*m0 - m1;
+		coef[4*i + 3] = 2.0*(y0 - y1) + m0 + m1;
+	}
+}
+
+
+
+
+double SplineTable::slope( function f, function df, const double *param, double x ) const {
+// df(x), or a fourth-order central difference of f over a small fraction of the knot spacing, whose
+// error is then far below that of the interpolation itself.
+
+	if( df )
+		return df( x, param );
+
+	double h = spacing / 16.0;
+	return ( f(x - 2.0*h, param) - 8.0*f(x - h, param) + 8.0*f(x + h, param) - f(x + 2.0*h, param) ) / (12.0*h);
+}
+
+
+
+
+double SplineTable::worst_error( function f, const double *param ) const {
+// The error of a Hermite segment is largest between its knots, so the quarter points are checked.
+
+	static const double t[] = { 0.25, 0.5, 0.75 };
+
+	double worst = 0,
+	       x, error;
+
+	for( int i = 0; i < intervals; i++ )
+		for( double ti : t ) {
+			x     = x_min + (i + ti) * spacing;
+			error = fabs( (*this)(x) - f(x, param) );
+			if( error > worst )
+				worst = error;
+		}
+
+	return worst;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+
+// Cubic spline tabulation of smooth functions of one variable.
+//
+// build() samples a function and its derivative at evenly spaced knots and joins them with cubic
+// Hermite segments, halving the spacing until the largest interpolation error found between the
+// knots is within the requested tolerance. A lookup then costs a scaling, a truncation and a cubic
+// polynomial in place of the library call. Tables only cover [x_min, x_max): callers check covers()
+// and evaluate the function itself outside of that range. Functions without a derivative at hand
+// (df null) get their slopes from central differences of f.
+
+class SplineTable
+{
+public:
+	typedef double (*function)( double x, const double *param );
+
+	SplineTable();
+	~SplineTable();
+	SplineTable( const SplineTable &other );
+	SplineTable & operator=( const SplineTable &other );
+
+	int      intervals;         // number of cubic segments
+	double   x_min,
+	         x_max,
+	         spacing,           // distance between knots
+	         max_error;         // largest absolute error found while building
+
+	bool build( function f, function df, const double *param, double x_min, double x_max, double tolerance );
+	void clear();
+
+	inline bool built() const {
+		return coef != nullptr;
+	}
+
+	inline bool covers( double x ) const {
+		return (x >= x_min) && (x < x_max);
+	}
+
+	// only valid where covers(x)
+	inline double operator()( double x ) const {
+		double         u = (x - x_min) * inverse_spacing;
+		int            i = (int) u;
+		if( i >= intervals )  // x a rounding error short of x_max
+			i = intervals - 1;
+		double         t = u - i;
+		const double * c = coef + 4*i;
+		return c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+	}
+
+private:
+	double   inverse_spacing;
+	double * coef;              // four per segment: c0 + t*(c1 + t*(c2 + t*c3)), with t in [0,1)
+
+	void   fill( function f, function df, const double *param, int n );
+	double slope( function f, function df, const double *param, double x ) const;
+	double worst_error( function f, const double *param ) const;
+};
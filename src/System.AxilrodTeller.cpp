@@ -0,0 +1,545 @@
+#include <math.h>
+#include <string.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "SafeOps.h"
+#include "System.h"
+
+
+
+// Axilrod-Teller three-body dispersion.
+//
+// Each unordered triplet of atoms that spans at least two molecules contributes
+//
+//   c9 (1 + 3 cos(g_i) cos(g_j) cos(g_k)) / (r_ij r_ik r_jk)^3
+//
+// with g the interior angles and every separation the minimum image. c9 is zero unless all three
+// atoms are polarizable, so the others are left out from the start, and since it depends only on
+// the (polarizability, c6, c9) of the three atoms, it is computed once per triple of such types
+// (at_c9).
+//
+// axilrod_teller_full() lists, for every atom i, its neighbors j > i (within axilrod_teller_cutoff,
+// found through a grid of cells at least that wide, or all of them if no cutoff is set), and then
+// visits each triplet i < j < k once, as a pair of i's neighbors that are also neighbors of one
+// another.
+//
+// The total is kept between calls. When make_move() has displaced, inserted or removed a single
+// molecule since it was summed, axilrod_teller() subtracts the triplets involving the molecule as
+// it was and adds those involving it as it now is, which is O(n_mol N^2) without a cutoff and
+// O(N + n_mol n_neighbor^2) with one (the atoms are binned once, and the molecule's neighbors found
+// through the cells about its atoms). The bookkeeping around moves follows that of the Ewald structure
+// factor (see System.EwaldKSpace.cpp).
+//
+// The energy expression and mixing rule are Adam Hogan's (2015).
+
+static const int    at_refresh      = 1000;             // incremental updates between full summations
+static const double au_to_angstrom  = 6.7483345;        // polarizability conversion used by the c9 mixing rule
+static const double au_to_kelvin    = 0.0032539449 / (3.166811429 * 0.000001);  // H*Bohr^9 to K*Angstrom^9
+
+
+
+
+static inline double triplet_energy( double c9, const double *dij, double rij, const double *dik, double rik, const double *djk, double rjk ) {
+// dxy is the minimum image displacement x - y.
+
+	double ci =  (dij[0]*dik[0] + dij[1]*dik[1] + dij[2]*dik[2]) / (rij * rik),
+	       cj = -(dij[0]*djk[0] + dij[1]*djk[1] + dij[2]*djk[2]) / (rij * rjk),
+	       ck =  (dik[0]*djk[0] + dik[1]*djk[1] + dik[2]*djk[2]) / (rik * rjk),
+	       r3 = rij * rik * rjk;
+
+	return c9 * (1.0 + 3.0*ci*cj*ck) / (r3*r3*r3);
+}
+
+
+
+
+double System::axilrod_teller() {
+
+	double change = 0;
+
+	if( at_pending  &&  at_valid  &&  (at_updates < at_refresh) ) {
+
+		at_saved_energy = at_energy;
+		at_rollback     = 1;
+
+		// the backup holds the molecule as it was (none for insertions), and the altered molecule is as it now is (none for removals)
+		if( checkpoint->molecule_backup )
+			change -= axilrod_teller_molecule( checkpoint->molecule_backup, checkpoint->molecule_altered );
+		if( checkpoint->molecule_altered )
+			change += axilrod_teller_molecule( checkpoint->molecule_altered, nullptr );
+
+		at_energy += change;
+		at_updates++;
+
+	} else {
+		if( at_pending ) {
+			at_saved_energy = at_energy;
+			at_rollback     = at_valid;
+		}
+		at_energy  = axilrod_teller_full();
+		at_valid   = 1;
+		at_updates = 0;
+	}
+
+	at_pending = 0;
+	return at_energy;
+}
+
+
+
+
+double System::axilrod_teller_full() {
+// Every triplet, from scratch.
+
+	int     n     = at_gather( nullptr, nullptr ),
+	        j, k, e3;
+	double  potential = 0,
+	      * dij, * dik, * djk;
+
+	if( n < 3 )
+		return 0;
+
+	at_neighbors( n );
+
+	for( int i = 0; i < n; i++ )
+		at_mark[i] = -1;
+
+	for( int i = 0; i < n; i++ ) {
+		for( int e1 = at_nbr_start[i]; e1 < at_nbr_start[i + 1]; e1++ ) {
+			j   = at_nbr[e1];
+			dij = at_nbr_d + 4*e1;
+
+			// k qualifies when it is a neighbor of j (and so k > j) as well as of i
+			for( int e = at_nbr_start[j]; e < at_nbr_start[j + 1]; e++ )
+				at_mark[ at_nbr[e] ] = e;
+
+			for( int e2 = at_nbr_start[i]; e2 < at_nbr_start[i + 1]; e2++ ) {
+				k  = at_nbr[e2];
+				e3 = at_mark[k];
+				if( (k <= j)  ||  (e3 < 0) )
+					continue;
+				if( (at_mol[i] == at_mol[j])  &&  (at_mol[j] == at_mol[k]) )
+					continue;
+
+				dik = at_nbr_d + 4*e2;
+				djk = at_nbr_d + 4*e3;
+				potential += triplet_energy( at_c9_lookup( at_type[i], at_type[j], at_type[k] ), dij, dij[3], dik, dik[3], djk, djk[3] );
+			}
+
+			for( int e = at_nbr_start[j]; e < at_nbr_start[j + 1]; e++ )
+				at_mark[ at_nbr[e] ] = -1;
+		}
+	}
+
+	return potential;
+}
+
+
+
+
+double System::axilrod_teller_molecule( Molecule *molecule, Molecule *skip ) {
+// The triplets that include at least one atom of molecule, the others being its own atoms or those
+// of the rest of the system (apart from skip). molecule itself need not be in the system. A triplet
+// with m of its atoms in molecule is found once from each of them, and so is weighted by 1/m.
+
+	int     n      = at_gather( molecule, skip ),
+	        mine   = 0,
+	        count, b, c;
+	double  cutoff = axilrod_teller_cutoff,
+	        potential = 0,
+	        d[3], r, weight,
+	      * dab, * dac;
+	bool    binned = at_bin( n );
+
+	while( (mine < n)  &&  (at_mol[mine] == molecule) )
+		mine++;
+
+	for( int a = 0; a < mine; a++ ) {
+
+		// a's neighbors, with the displacements a - b: those in the cells about a's, or any of them
+		count = 0;
+		if( binned ) {
+			for( int k = 0; k < 27; k++ )
+				for( b = at_cell_head[ at_cell_around(a, k) ]; b >= 0; b = at_cell_next[b] )
+					if( b != a )
+						count = at_nbr_add( count, a, b );
+		} else {
+			for( b = 0; b < n; b++ )
+				if( b != a )
+					count = at_nbr_add( count, a, b );
+		}
+
+		for( int e1 = 0; e1 < count; e1++ ) {
+			b   = at_nbr[e1];
+			dab = at_nbr_d + 4*e1;
+			for( int e2 = e1 + 1; e2 < count; e2++ ) {
+				c = at_nbr[e2];
+
+				// all three in molecule: no three-body term
+				if( (b < mine)  &&  (c < mine) )
+					continue;
+
+				at_separation( at_atom[b], at_atom[c], d, r );
+				if( (cutoff > 0)  &&  (r >= cutoff) )
+					continue;
+
+				dac    = at_nbr_d + 4*e2;
+				weight = 1.0 / (1 + (b < mine) + (c < mine));
+				potential += weight * triplet_energy( at_c9_lookup( at_type[a], at_type[b], at_type[c] ), dab, dab[3], dac, dac[3], d, r );
+			}
+		}
+	}
+
+	return potential;
+}
+
+
+
+
+int System::at_gather( Molecule *molecule, Molecule *skip ) {
+// Collect the polarizable atoms into at_atom, with their molecules and c9 types: molecule's first
+// and then those of every other molecule in the system (apart from skip), or, with no molecule,
+// all of them. Returns the number collected.
+
+	Molecule * molecule_ptr;
+	Atom     * atom_ptr;
+	int        n = 0;
+
+	if( molecule )
+		for( atom_ptr = molecule->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			n++;
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			n++;
+
+	if( n > at_allocd ) {
+		at_allocd = n;
+		SafeOps::realloc( at_atom,      at_allocd * sizeof(Atom *),     __LINE__, __FILE__ );
+		SafeOps::realloc( at_mol,       at_allocd * sizeof(Molecule *), __LINE__, __FILE__ );
+		SafeOps::realloc( at_type,      at_allocd * sizeof(int),        __LINE__, __FILE__ );
+		SafeOps::realloc( at_mark,      at_allocd * sizeof(int),        __LINE__, __FILE__ );
+		SafeOps::realloc( at_nbr_start, (at_allocd + 1) * sizeof(int),  __LINE__, __FILE__ );
+		SafeOps::realloc( at_cell_next, at_allocd * sizeof(int),        __LINE__, __FILE__ );
+		SafeOps::realloc( at_cell_of,   3 * at_allocd * sizeof(int),    __LINE__, __FILE__ );
+	}
+
+	n = 0;
+	if( molecule )
+		n = at_gather_molecule( molecule, n );
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		if( (molecule_ptr != molecule)  &&  (molecule_ptr != skip) )
+			n = at_gather_molecule( molecule_ptr, n );
+
+	at_natoms = n;
+	return n;
+}
+
+
+
+
+int System::at_gather_molecule( Molecule *molecule, int n ) {
+
+	for( Atom *atom_ptr = molecule->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+		if( atom_ptr->polarizability == 0.0 )
+			continue;
+		at_atom[n] = atom_ptr;
+		at_mol [n] = molecule;
+		at_type[n] = at_type_intern( atom_ptr );
+		n++;
+	}
+	return n;
+}
+
+
+
+
+void System::at_neighbors( int n ) {
+// List the neighbors j > i of each collected atom i (CSR: at_nbr[at_nbr_start[i] .. at_nbr_start[i+1]-1]),
+// with the minimum image displacements i - j and separations.
+
+	int  count  = 0,
+	     j;
+	bool binned = at_bin( n );
+
+	for( int i = 0; i < n; i++ ) {
+		at_nbr_start[i] = count;
+
+		if( binned ) {
+			for( int k = 0; k < 27; k++ )
+				for( j = at_cell_head[ at_cell_around(i, k) ]; j >= 0; j = at_cell_next[j] )
+					if( j > i )
+						count = at_nbr_add( count, i, j );
+		} else {
+			for( j = i + 1; j < n; j++ )
+				count = at_nbr_add( count, i, j );
+		}
+	}
+	at_nbr_start[n] = count;
+}
+
+
+
+
+bool System::at_bin( int n ) {
+// Bin the n collected atoms into cells at least axilrod_teller_cutoff wide, so that neighbors share a
+// cell or sit in adjacent ones. With no cutoff, or fewer than three cells along an axis (when the 27
+// cells around an atom would repeat), nothing is binned and false is returned.
+
+	int    cells = 1,
+	       c[3], cell;
+	double cutoff = axilrod_teller_cutoff,
+	       width, s;
+
+	if( cutoff <= 0 )
+		return false;
+
+	for( int p = 0; p < 3; p++ ) {
+		width = 0;
+		for( int q = 0; q < 3; q++ )
+			width += pbc.reciprocal_basis[q][p] * pbc.reciprocal_basis[q][p];
+		width = 1.0 / sqrt( width );
+		at_cell_dim[p] = (int) floor( width / cutoff );
+		if( at_cell_dim[p] < 3 )
+			return false;
+		cells *= at_cell_dim[p];
+	}
+
+	if( cells > at_cells_allocd ) {
+		at_cells_allocd = cells;
+		SafeOps::realloc( at_cell_head, at_cells_allocd * sizeof(int), __LINE__, __FILE__ );
+	}
+	for( int i = 0; i < cells; i++ )
+		at_cell_head[i] = -1;
+
+	// bin in reverse, so that each cell lists its atoms in increasing order
+	for( int i = n - 1; i >= 0; i-- ) {
+		for( int q = 0; q < 3; q++ ) {
+			s  = pbc.reciprocal_basis[0][q]*at_atom[i]->pos[0] + pbc.reciprocal_basis[1][q]*at_atom[i]->pos[1] + pbc.reciprocal_basis[2][q]*at_atom[i]->pos[2];
+			s -= floor( s );
+			c[q] = (int) (s * at_cell_dim[q]);
+			if( c[q] >= at_cell_dim[q] )
+				c[q] = at_cell_dim[q] - 1;
+			at_cell_of[3*i + q] = c[q];
+		}
+		cell = (c[0]*at_cell_dim[1] + c[1])*at_cell_dim[2] + c[2];
+		at_cell_next[i]    = at_cell_head[cell];
+		at_cell_head[cell] = i;
+	}
+	return true;
+}
+
+
+
+
+int System::at_cell_around( int i, int k ) {
+// The k-th (0 to 26) of the cells about the one binned atom i is in, that one included.
+
+	int c[3];
+
+	for( int q = 0; q < 3; q++, k /= 3 )
+		c[q] = (at_cell_of[3*i + q] + (k % 3) - 1 + at_cell_dim[q]) % at_cell_dim[q];
+	return (c[0]*at_cell_dim[1] + c[1])*at_cell_dim[2] + c[2];
+}
+
+
+
+
+void System::at_separation( const Atom *atom_i, const Atom *atom_j, double *d, double &r ) {
+// The minimum image displacement atom_i - atom_j, as minimum_image() finds it, and its length.
+
+	double img[3];
+
+	for( int p = 0; p < 3; p++ )
+		d[p] = atom_i->pos[p] - atom_j->pos[p];
+	pbc.image_offset( d, img );
+	for( int p = 0; p < 3; p++ )
+		d[p] -= img[p];
+	r = sqrt( d[0]*d[0] + d[1]*d[1] + d[2]*d[2] );
+}
+
+
+
+
+void System::at_nbr_reserve( int count ) {
+
+	if( count <= at_nbr_allocd )
+		return;
+
+	at_nbr_allocd = (count > 2*at_nbr_allocd) ? count : 2*at_nbr_allocd;
+	SafeOps::realloc( at_nbr,   at_nbr_allocd * sizeof(int),        __LINE__, __FILE__ );
+	SafeOps::realloc( at_nbr_d, at_nbr_allocd * 4 * sizeof(double), __LINE__, __FILE__ );
+}
+
+
+
+
+int System::at_nbr_add( int count, int i, int j ) {
+// Append j to the count neighbors listed so far, with the displacement i - j and separation, if it is
+// within the cutoff. Returns the new count.
+
+	double d[3], r;
+
+	at_separation( at_atom[i], at_atom[j], d, r );
+	if( (axilrod_teller_cutoff > 0)  &&  (r >= axilrod_teller_cutoff) )
+		return count;
+
+	at_nbr_reserve( count + 1 );
+	at_nbr[count] = j;
+	memcpy( at_nbr_d + 4*count, d, sizeof(d) );
+	at_nbr_d[4*count + 3] = r;
+	return count + 1;
+}
+
+
+
+
+int System::at_type_intern( const Atom *atom ) {
+// The c9 type of atom's (polarizability, c6, c9), adding a new one (and growing at_c9) if need be.
+
+	double params[3] = { atom->polarizability, atom->c6, atom->c9 };
+	int    t, n;
+
+	for( t = 0; t < at_ntypes; t++ )
+		if( ! memcmp( params, at_type_params + 3*t, sizeof(params) ) )
+			return t;
+
+	at_ntypes++;
+	n = at_ntypes;
+	SafeOps::realloc( at_type_params, 3 * n * sizeof(double), __LINE__, __FILE__ );
+	memcpy( at_type_params + 3*t, params, sizeof(params) );
+
+	SafeOps::realloc( at_c9, n * n * n * sizeof(double), __LINE__, __FILE__ );
+	for( int u = 0; u < n; u++ )
+		for( int v = 0; v < n; v++ )
+			for( int w = 0; w < n; w++ )
+				at_c9[ (u*n + v)*n + w ] = at_c9_mix( u, v, w );
+
+	return t;
+}
+
+
+
+
+double System::at_c9_mix( int u, int v, int w ) {
+// Mixing rule, eq. 20 of http://dx.doi.org/10.1063/1.440310, with the Midzuno-Kihara approximation
+// for the atomic c9 if asked for (http://dx.doi.org/10.1143/JPSJ.11.1045). Parameters as in
+// http://arxiv.org/pdf/1201.1532.pdf.
+
+	int    types[3] = { u, v, w };
+	double alpha3[3], c9[3], product = 1, sum = 0, alpha, mixed;
+
+	for( int i = 0; i < 3; i++ ) {
+		const double *params = at_type_params + 3*types[i];
+
+		if( params[0] == 0.0 )
+			return 0.0;  // avoid division by zero
+
+		alpha     = params[0] * au_to_angstrom;
+		alpha3[i] = alpha * alpha * alpha;
+		c9[i]     = midzuno_kihara_approx ? 3.0/4.0 * alpha * params[1] : params[2];
+		product  *= alpha3[i];
+		sum      += 1.0 / (c9[i] / alpha3[i]);
+	}
+
+	mixed = pow( product, 1.0/3.0 ) * 3.0 / sum;
+	return mixed * au_to_kelvin;
+}
+
+
+
+
+void System::axilrod_teller_move_made() {
+// Called by make_move() once the move is done.
+
+	int movetype = checkpoint->movetype;
+
+	at_rollback = 0;
+	if(   at_valid
+	   && (   movetype == MOVETYPE_DISPLACE  ||  movetype == MOVETYPE_ADIABATIC  ||  movetype == MOVETYPE_REMOVE
+	       || ((movetype == MOVETYPE_INSERT)  &&  !num_insertion_molecules) )
+	)
+		at_pending = 1;
+	else
+		at_valid = 0;
+}
+
+
+
+
+void System::axilrod_teller_restore() {
+// Called by restore(): go back to the total from before the rejected move.
+
+	if( at_rollback )
+		at_energy = at_saved_energy;
+	else
+		at_valid = 0;
+
+	at_pending  = 0;
+	at_rollback = 0;
+}
+
+
+
+
+void System::axilrod_teller_accept() {
+// Called by do_checkpoint().
+
+	if( at_pending )
+		at_valid = 0;
+
+	at_pending  = 0;
+	at_rollback = 0;
+}
+
+
+
+
+void System::axilrod_teller_free() {
+
+	if( at_atom        ) free( at_atom        );
+	if( at_mol         ) free( at_mol         );
+	if( at_type        ) free( at_type        );
+	if( at_mark        ) free( at_mark        );
+	if( at_nbr_start   ) free( at_nbr_start   );
+	if( at_nbr         ) free( at_nbr         );
+	if( at_nbr_d       ) free( at_nbr_d       );
+	if( at_cell_head   ) free( at_cell_head   );
+	if( at_cell_next   ) free( at_cell_next   );
+	if( at_cell_of     ) free( at_cell_of     );
+	if( at_type_params ) free( at_type_params );
+	if( at_c9          ) free( at_c9          );
+
+	axilrod_teller_init();
+}
+
+
+
+
+void System::axilrod_teller_init() {
+
+	at_natoms       = 0;
+	at_allocd       = 0;
+	at_nbr_allocd   = 0;
+	at_cells_allocd = 0;
+	at_ntypes       = 0;
+	at_energy       = 0;
+	at_saved_energy = 0;
+	at_valid        = 0;
+	at_pending      = 0;
+	at_rollback     = 0;
+	at_updates      = 0;
+
+	at_atom         = nullptr;
+	at_mol          = nullptr;
+	at_type         = nullptr;
+	at_mark         = nullptr;
+	at_nbr_start    = nullptr;
+	at_nbr          = nullptr;
+	at_nbr_d        = nullptr;
+	at_cell_head    = nullptr;
+	at_cell_next    = nullptr;
+	at_cell_of      = nullptr;
+	at_type_params  = nullptr;
+	at_c9           = nullptr;
+}
@@ -46,11 +46,7 @@ void System::cavity_update_grid() {
 				grid_component[2] = ((double)(k + 1))  /  ((double)(cavity_grid_size + 1));
 
 				// project the grid point onto our actual basis
-				for(int p = 0;   p < 3;   p++ ) {
-					grid_vector[p] = 0;
-					for( int q = 0; q < 3; q++)
-						grid_vector[p] += pbc.basis[q][p] * grid_component[q];
-				}
+				pbc.frac_to_cart( grid_component, grid_vector );
 
 				// put into real coordinates 
 				for( int p = 0;   p < 3;   p++ )
@@ -138,14 +134,8 @@ void System::update_cavity_volume() {
 		for( int p = 0; p < 3; p++ )
 			grid_vec[p] = -0.5 + get_rand();
 
-		// zero the coordinate vector
-		for( int p = 0; p < 3; p++)
-			pos_vec[p] = 0;
-
 		// linear transform vector into real coordinates
-		for( int p = 0; p < 3; p++ )
-			for( int q = 0; q < 3; q++ )
-				pos_vec[p] += pbc.basis[q][p] * grid_vec[q];
+		pbc.frac_to_cart( grid_vec, pos_vec );
 
 		// check if the random point lies within an empty cavity
 		if(   is_point_empty(pos_vec[0], pos_vec[1], pos_vec[2])  )
@@ -208,6 +198,7 @@ void System::setup_cavity_grid() {
 
 
 //check cavity_autoreject_absolute 
+//(the image separations were all refreshed, a batch per atom, by the preceding pairs())
 double System::cavity_absolute_check()
 {
 	Molecule * molecule_ptr;
@@ -0,0 +1,231 @@
+#include <math.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Pair.h"
+#include "SafeOps.h"
+#include "System.h"
+
+
+
+// Linked-cell spatial index.
+//
+// The unit cell is divided along each lattice vector into cells whose perpendicular width is
+// at least pbc.cutoff (plus the skin, when Verlet lists are in use). Any two atoms separated by
+// less than that (under the minimum image convention) must then occupy the same cell or cells
+// that neighbor one another (periodically), so pairs that fail this test can be dismissed without
+// performing the minimum image. Working in
+// fractional coordinates (via reciprocal_basis) makes this valid for triclinic cells as well.
+//
+//   cell_list_head[c]        index (into atom_array) of the first atom in cell c, -1 if empty
+//   cell_list_next[i]        index of the next atom sharing a cell with atom i, -1 terminates
+//   cell_list_cell[i]        the cell c of atom i
+//   cell_list_atom_cell[3i]  the (a,b,c) cell coordinates of atom i
+//
+// The binning before the last is kept in cell_list_prev_head/_next/_cell. Once a sweep has culled
+// every pair by the current grid, pairs_cell_sweep() reaches the pairs in neighboring cells through
+// the lists, and finds the pairs that have left the neighborhood of an atom that changed cells
+// through the previous lists, so that distant pairs are never visited.
+
+
+
+
+bool System::cell_list_build() {
+// Bins every atom in atom_array into the cell grid. The grid dimensions are recomputed
+// from the current basis on every call, so NPT volume changes are picked up automatically.
+// rebuild_arrays() must have been called first. Returns true if the last call binned the
+// same number of atoms into the same grid, i.e. if the previous binning can be compared.
+
+	int    ncells = 1,
+	       cell[3],
+	       dim[3],
+	     * swap;
+	bool   same_grid;
+	double width,
+	       s[3],
+	       range = pbc.cutoff;
+
+	// the Verlet lists are built from the pairs that survive culling, so they need the wider radius
+	if( verlet_list )
+		range += verlet_skin;
+
+	// number of cells along each lattice vector: the spacing between the lattice planes
+	// normal to reciprocal vector p is 1/|b*_p|
+	for( int p = 0; p < 3; p++ ) {
+		width = 0;
+		for( int q = 0; q < 3; q++ )
+			width += pbc.reciprocal_basis[q][p] * pbc.reciprocal_basis[q][p];
+		width = 1.0 / sqrt(width);
+
+		dim[p] = (int) floor( width / range );
+		if( dim[p] < 1 )
+			dim[p] = 1;
+		ncells *= dim[p];
+	}
+
+	same_grid = cell_list_nbuilt  &&  (natoms == cell_list_natoms);
+	for( int p = 0; p < 3; p++ ) {
+		if( dim[p] != cell_list_dim[p] )
+			same_grid = false;
+		cell_list_dim[p] = dim[p];
+	}
+
+	// the last binning becomes the previous one
+	swap = cell_list_head;  cell_list_head = cell_list_prev_head;  cell_list_prev_head = swap;
+	swap = cell_list_next;  cell_list_next = cell_list_prev_next;  cell_list_prev_next = swap;
+	swap = cell_list_cell;  cell_list_cell = cell_list_prev_cell;  cell_list_prev_cell = swap;
+
+	// grow the storage as needed
+	if( ncells > cell_list_ncells_allocd ) {
+		SafeOps::realloc( cell_list_head,      ncells * sizeof(int), __LINE__, __FILE__ );
+		SafeOps::realloc( cell_list_prev_head, ncells * sizeof(int), __LINE__, __FILE__ );
+		cell_list_ncells_allocd = ncells;
+	}
+	if( natoms > cell_list_natoms_allocd ) {
+		SafeOps::realloc( cell_list_next,      natoms * sizeof(int),     __LINE__, __FILE__ );
+		SafeOps::realloc( cell_list_prev_next, natoms * sizeof(int),     __LINE__, __FILE__ );
+		SafeOps::realloc( cell_list_cell,      natoms * sizeof(int),     __LINE__, __FILE__ );
+		SafeOps::realloc( cell_list_prev_cell, natoms * sizeof(int),     __LINE__, __FILE__ );
+		SafeOps::realloc( cell_list_atom_cell, natoms * sizeof(int) * 3, __LINE__, __FILE__ );
+		cell_list_natoms_allocd = natoms;
+	}
+	cell_list_ncells = ncells;
+	cell_list_natoms = natoms;
+	cell_list_nbuilt++;
+
+	for( int c = 0; c < ncells; c++ )
+		cell_list_head[c] = -1;
+
+	for( int i = 0; i < natoms; i++ ) {
+
+		// project into fractional coordinates and wrap into [0,1)
+		pbc.cart_to_frac( atom_array[i]->pos, s );
+		for( int p = 0; p < 3; p++ ) {
+			s[p] -= floor(s[p]);
+
+			cell[p] = (int) ( s[p] * cell_list_dim[p] );
+			if( cell[p] >= cell_list_dim[p] ) // guard against s rounding up to 1.0
+				cell[p] = cell_list_dim[p] - 1;
+			cell_list_atom_cell[ 3*i + p ] = cell[p];
+		}
+
+		// push the atom onto the front of its cell's list
+		int c = (cell[0] * cell_list_dim[1] + cell[1]) * cell_list_dim[2] + cell[2];
+		cell_list_cell[i] = c;
+		cell_list_next[i] = cell_list_head[c];
+		cell_list_head[c] = i;
+	}
+
+	return same_grid;
+}
+
+
+
+
+int System::cell_list_neighbor_cells( int c, int *cells ) {
+// Fills cells[] with cell c and each cell adjacent to it (periodically), without repeats, and
+// returns their number (at most 27). These are the cells cell_list_neighbors() accepts.
+
+	int coord[3],
+	    along[3][3],
+	    nalong[3],
+	    n = 0;
+
+	coord[2] = c % cell_list_dim[2];
+	coord[1] = (c / cell_list_dim[2]) % cell_list_dim[1];
+	coord[0] = c / (cell_list_dim[2] * cell_list_dim[1]);
+
+	for( int p = 0; p < 3; p++ ) {
+		// with fewer than 3 cells along an axis, every cell neighbors every other
+		if( cell_list_dim[p] < 3 ) {
+			nalong[p] = cell_list_dim[p];
+			for( int k = 0; k < nalong[p]; k++ )
+				along[p][k] = k;
+		} else {
+			nalong[p] = 3;
+			for( int k = 0; k < 3; k++ )
+				along[p][k] = (coord[p] + k - 1 + cell_list_dim[p]) % cell_list_dim[p];
+		}
+	}
+
+	for( int a = 0; a < nalong[0]; a++ )
+		for( int b = 0; b < nalong[1]; b++ )
+			for( int d = 0; d < nalong[2]; d++ )
+				cells[ n++ ] = (along[0][a] * cell_list_dim[1] + along[1][b]) * cell_list_dim[2] + along[2][d];
+
+	return n;
+}
+
+
+
+
+bool System::cell_list_neighbors( int i, int j ) {
+// True if atoms i and j (indices into atom_array) are in the same or periodically adjacent
+// cells, i.e. if they could possibly be within the cutoff of one another.
+
+	int dc;
+
+	for( int p = 0; p < 3; p++ ) {
+
+		// with fewer than 3 cells along an axis, every cell neighbors every other
+		if( cell_list_dim[p] < 3 )
+			continue;
+
+		dc = abs( cell_list_atom_cell[3*i + p] - cell_list_atom_cell[3*j + p] );
+		if( (dc > 1) && (dc < cell_list_dim[p] - 1) )
+			return false;
+	}
+
+	return true;
+}
+
+
+
+
+void System::cell_list_cull( Pair *pair_ptr ) {
+// Mark a pair that lies in non-neighboring cells as beyond the cutoff. Its cached energies are
+// flagged for recalculation (which zeroes them) only on the step it first leaves the neighborhood;
+// afterwards it is skipped until the two atoms are once again in neighboring cells.
+
+	if( pair_ptr->culled ) {
+		pair_ptr->recalculate_energy = 0;
+		return;
+	}
+
+	pair_ptr->culled             = 1;
+	pair_ptr->recalculate_energy = 1;
+	pair_ptr->rimg               = MAXVALUE;
+
+	// invalidate the stored displacement so that minimum_image() will not mistake this
+	// pair as unchanged when it re-enters the neighborhood
+	for( int p = 0; p < 3; p++ )
+		pair_ptr->d_prev[p] = NAN;
+}
+
+
+
+
+void System::cell_list_free() {
+
+	if( cell_list_head      ) free( cell_list_head      );
+	if( cell_list_next      ) free( cell_list_next      );
+	if( cell_list_cell      ) free( cell_list_cell      );
+	if( cell_list_prev_head ) free( cell_list_prev_head );
+	if( cell_list_prev_next ) free( cell_list_prev_next );
+	if( cell_list_prev_cell ) free( cell_list_prev_cell );
+	if( cell_list_atom_cell ) free( cell_list_atom_cell );
+
+	cell_list_head          = nullptr;
+	cell_list_next          = nullptr;
+	cell_list_cell          = nullptr;
+	cell_list_prev_head     = nullptr;
+	cell_list_prev_next     = nullptr;
+	cell_list_prev_cell     = nullptr;
+	cell_list_atom_cell     = nullptr;
+	cell_list_ncells        = 0;
+	cell_list_ncells_allocd = 0;
+	cell_list_natoms_allocd = 0;
+	cell_list_natoms        = 0;
+	cell_list_nbuilt        = 0;
+	cell_list_culled        = 0;
+}
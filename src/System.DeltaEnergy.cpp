@@ -0,0 +1,195 @@
+#include <math.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Pair.h"
+#include "System.h"
+#include "UsefulMath.h"
+
+
+
+// Delta-energy evaluation of single-molecule moves.
+//
+// energy() visits every stored pair in order to sum the cached pair energies, even when a single
+// molecule has moved. For DISPLACE/INSERT/REMOVE moves, delta_energy() instead evaluates only the
+// interactions of the altered molecule before and after the move, and applies the difference to
+// running totals kept in observables (using compensated summation). The Ewald reciprocal term is
+// O(N) and is simply recomputed, as are the self terms (from the molecule counts, as a rule; see
+// System.IntraConstants.cpp).
+//
+// The cached pair energies are bypassed entirely, so the next full energy() flags every pair.
+// A full energy() is also done every delta_energy_refresh evaluations, to bound the drift in the
+// running totals.
+
+
+
+
+double System::delta_energy( Molecule *molecule ) {
+// Returns the total potential energy following the move in the checkpoint, just as energy() does.
+// molecule is the altered molecule as it now sits in the system (ignored for removals); its prior
+// configuration is checkpoint->molecule_backup (nullptr after an insertion).
+
+	int        movetype = checkpoint->movetype;
+	Molecule * before   = checkpoint->molecule_backup;
+	bool       intra;
+	double     rd_before = 0,
+	           es_before = 0,
+	           rd_after  = 0,
+	           es_after  = 0,
+	           kspace    = 0,
+	           potential_energy;
+
+	if( movetype == MOVETYPE_REMOVE )
+		molecule = nullptr;
+
+	// fall back on the full calculation whenever the running totals can't be trusted (or updated)
+	if(   !delta_energy_supported()
+	   || ( movetype != MOVETYPE_DISPLACE  &&  movetype != MOVETYPE_INSERT  &&  movetype != MOVETYPE_REMOVE )
+	   || observables->energy == 0.0
+	   || last_volume != pbc.volume
+	   || delta_energy_count >= delta_energy_refresh
+	)
+		return energy();
+	delta_energy_count++;
+
+	natoms = countNatoms();
+
+	// a rigid displacement leaves the molecule's internal terms alone, but insertions and removals
+	// add or take away its intra-molecular pairs and self LRC terms as well
+	intra = (movetype != MOVETYPE_DISPLACE);
+
+	if( before )
+		delta_energy_molecule( before, molecule, intra, rd_before, es_before );
+	if( molecule ) {
+		delta_energy_molecule( molecule, nullptr, intra, rd_after, es_after );
+
+		// pairs() would normally do this
+		molecule->dirty = 1;
+		update_com( true );
+		wrap_all( true );
+	}
+
+	// the pair lists no longer describe the current configuration
+	pair_energies_stale = 1;
+	pairs_sweep_all     = 1;
+
+	UsefulMath::compensated_add( observables->rd_energy, observables->rd_energy_carry, rd_after - rd_before );
+
+	if( !(use_sg || rd_only) ) {
+		kspace = coulombic_reciprocal() + coulombic_self();
+		UsefulMath::compensated_add( observables->coulombic_energy, observables->coulombic_energy_carry, (es_after - es_before) + (kspace - observables->kspace_energy) );
+		observables->kspace_energy = kspace;
+	}
+
+	potential_energy = observables->rd_energy + observables->coulombic_energy;
+	update_energy_observables( potential_energy );
+
+	return potential_energy;
+}
+
+
+
+
+bool System::delta_energy_supported() {
+// The running totals are only kept for the purely pairwise repulsion/dispersion and Ewald terms.
+
+	if( polarization || polarvdw || using_axilrod_teller || cavity_autoreject_absolute )
+		return false;
+	if( rd_anharmonic || use_sg || use_dreiding || using_lj_buffered_14_7 || using_disp_expansion || rd_crystal )
+		return false;
+	if( spectre || gwp || wolf )
+		return false;
+
+	return true;
+}
+
+
+
+
+void System::delta_energy_molecule( Molecule *molecule, Molecule *skip, bool intra, double &rd, double &es ) {
+// Sums the interactions between the atoms of molecule and those of every other molecule in the
+// system, excluding skip (which is the system's own copy of molecule, when molecule is a backup).
+// With intra, the molecule's internal pairs and self LRC terms are included too.
+
+	Molecule * molecule_ptr;
+	Atom     * atom_ptr,
+	         * other_ptr;
+	double     cutoff = pbc.cutoff;
+	int        k;
+
+	// the partners are never more than the atoms in the system, plus those of a removed molecule
+	k = natoms;
+	for( atom_ptr = molecule->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+		k++;
+	image_batch.reserve( k );
+
+	for( atom_ptr = molecule->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+
+		// image the atom against all of its partners at once, which are then visited in the same order
+		image_batch.n = 0;
+		for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+			if( (molecule_ptr == molecule) || (molecule_ptr == skip) )
+				continue;
+			for( other_ptr = molecule_ptr->atoms; other_ptr; other_ptr = other_ptr->next )
+				image_batch.push( other_ptr->pos, 0 );
+		}
+		if( intra )
+			for( other_ptr = atom_ptr->next; other_ptr; other_ptr = other_ptr->next )
+				image_batch.push( other_ptr->pos, 0 );
+		pbc.image_batch( atom_ptr->pos, image_batch );
+
+		k = 0;
+		for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+			if( (molecule_ptr == molecule) || (molecule_ptr == skip) )
+				continue;
+			for( other_ptr = molecule_ptr->atoms; other_ptr; other_ptr = other_ptr->next )
+				delta_energy_pair( molecule, atom_ptr, molecule_ptr, other_ptr, k++, intra, rd, es );
+		}
+
+		if( ! intra )
+			continue;
+
+		for( other_ptr = atom_ptr->next; other_ptr; other_ptr = other_ptr->next )
+			delta_energy_pair( molecule, atom_ptr, molecule, other_ptr, k++, true, rd, es );
+
+		if( rd_lrc )
+			rd += cdvdw_exp_repulsion ? exp_lrc_self( atom_ptr, cutoff ) : lj_lrc_self( atom_ptr, cutoff );
+	}
+}
+
+
+
+
+void System::delta_energy_pair( Molecule *molecule_i, Atom *atom_i, Molecule *molecule_j, Atom *atom_j, int k, bool lrc, double &rd, double &es ) {
+// Evaluate a single pair from scratch, using the same per-pair kernels as energy(). atom_j is entry
+// k of image_batch. The pair LRC only depends on the volume, so it is only needed when the pair is
+// being added or taken away.
+
+	Pair   pair;
+	double cutoff = pbc.cutoff;
+
+	// make sure the pair is treated as having moved
+	for( int p = 0; p < 3; p++ )
+		pair.d_prev[p] = NAN;
+
+	pair.atom     = atom_j;
+	pair.molecule = molecule_j;
+	mixing_table_apply( molecule_i, molecule_j, atom_i, atom_j, &pair );
+	minimum_image_store( &pair, image_batch, k, 1.0 );
+
+	if( cdvdw_exp_repulsion ) {
+		exp_repulsion_pair( molecule_i, atom_i, &pair, cutoff );
+		if( lrc && rd_lrc )
+			rd += exp_lrc_corr( atom_i, &pair, cutoff );
+	} else {
+		lj_pair( molecule_i, atom_i, &pair, cutoff );
+		if( lrc && rd_lrc )
+			rd += lj_lrc_corr( atom_i, &pair, cutoff );
+	}
+	rd += pair.rd_energy;
+
+	if( !(use_sg || rd_only) ) {
+		coulombic_real_pair( molecule_i, atom_i, &pair );
+		es += pair.es_real_energy - pair.es_self_intra_energy;
+	}
+}
@@ -0,0 +1,422 @@
+#include <math.h>
+#include <string.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Pair.h"
+#include "SafeOps.h"
+#include "System.h"
+
+
+
+// Ewald summation of the Lennard-Jones lattice sums of rd_crystal (rd_crystal_ewald).
+//
+// rd_crystal adds, to every pair, its interaction with the periodic images of its partner out to
+// rd_crystal_order cells in each direction, and to every atom its interaction with its own images.
+// The r^-12 part of those sums converges within the nearest image; the r^-6 part is split as in
+// Williams' dispersion Ewald sum (Acta Cryst. A27, 452 (1971)),
+//
+//   sum_n 1/|r+n|^6 = sum_n g(beta |r+n|)/|r+n|^6  +  A sum_k f(|k|/(2 beta)) e^{i k.r}
+//
+//   g(x) = e^{-x^2} (1 + x^2 + x^4/2)
+//   f(b) = (1 - 2 b^2) e^{-b^2} + 2 b^3 sqrt(pi) erfc(b)
+//   A    = pi^{3/2} beta^3 / (3 V)
+//
+// with beta chosen so that the first sum needs only the minimum image within the cutoff, as any pair
+// energy would. rd_ewald_pair() computes that part for each pair, and rd_ewald_reciprocal() the second,
+// which, since the mixed C6 = 4 epsilon sigma^6 of a pair depends only on the mixing types of its two
+// atoms, is
+//
+//   (A/2) sum_k f sum_{a,b} C6_ab S_a(k) S_b(k)*,   S_a(k) = sum over atoms of type a of e^{i k.r}.
+//
+// The framework-framework pairs are left out of the energy, as before. The frozen atoms' part of
+// S_a only changes with the cell, so it is summed once (rd_ewald_update()) into
+// G_b(k) = sum_a C6_ab F_a(k), leaving the cross terms with the mobile atoms at O(types) per
+// k-vector and the frozen-frozen terms out altogether. The r^-6 sums are complete, so only the
+// repulsive part of the long-range correction still applies (see lj_lrc_corr()).
+// rd_crystal_ewald_tolerance sets the size of the terms dropped from either r^-6 sum, relative to the
+// largest.
+
+static const double g_exponent_limit = 40.0;  // g(x) is taken to be 0 beyond sqrt of this
+
+
+
+
+static inline double g6( double x ) {
+	double x2 = x * x;
+	return (x2 > g_exponent_limit) ? 0.0 : exp( -x2 ) * (1.0 + x2 + 0.5*x2*x2);
+}
+
+
+
+
+static inline double f6( double b ) {
+	double b2 = b * b;
+	return (1.0 - 2.0*b2) * exp( -b2 ) + 2.0 * b2 * b * sqrt( pi ) * erfc( b );
+}
+
+
+
+
+static double solve_decreasing( double (*fn)( double ), double target, double upper ) {
+// The x in [0, upper] where fn, decreasing from fn(0) > target, falls to target.
+
+	double lower = 0, middle;
+
+	for( int i = 0; i < 60; i++ ) {
+		middle = 0.5 * (lower + upper);
+		if( fn( middle ) > target )
+			lower = middle;
+		else
+			upper = middle;
+	}
+	return upper;
+}
+
+
+
+
+void System::rd_ewald_pair( Atom *atom_ptr, Pair *pair_ptr ) {
+// The real-space part of a pair's lattice sum. Excluded pairs skip the image at their actual
+// separation, which the reciprocal-space sum includes, and so have that taken back out.
+
+	double cutoff = pbc.cutoff,
+	       beta   = rd_ewald_beta,
+	       term6  = 0,
+	       term12 = 0,
+	       sigma6, d[3], r, r0, r6;
+
+	pair_ptr->rd_energy = 0;
+	if( pair_ptr->frozen )
+		return;
+
+	r = pair_ptr->rimg;
+	if( pair_ptr->rd_excluded ) {
+		for( int p = 0; p < 3; p++ )
+			d[p] = atom_ptr->pos[p] - pair_ptr->atom->pos[p];
+		r0  = sqrt( d[0]*d[0] + d[1]*d[1] + d[2]*d[2] );
+		r6  = r0*r0*r0;
+		r6 *= r6;
+		term6 -= (1.0 - g6( beta * r0 )) / r6;
+
+		// the minimum image being some other image
+		if( (r0 - r < SMALL_dR)  ||  (r >= cutoff) )
+			r = 0;
+	} else if( r >= cutoff )
+		r = 0;
+
+	if( r > 0 ) {
+		r6  = r*r*r;
+		r6 *= r6;
+		term6  += g6( beta * r ) / r6;
+		term12 += 1.0 / (r6 * r6);
+	}
+
+	sigma6  = fabs( pair_ptr->sigma );
+	sigma6 *= sigma6 * sigma6;
+	sigma6 *= sigma6;
+	if( pair_ptr->attractive_only )
+		term12 = 0;
+
+	pair_ptr->rd_energy = 4.0 * pair_ptr->epsilon * (sigma6*sigma6*term12 - sigma6*term6);
+}
+
+
+
+
+double System::rd_ewald_reciprocal() {
+// The reciprocal-space part of the r^-6 sums, and the interactions of each atom with its own images.
+// rd_ewald_update() has been called, ahead of the pairs.
+
+	Molecule     * molecule_ptr;
+	Atom         * atom_ptr;
+	int            n, nk, t, * l;
+	double         dispersion = 0,
+	               repulsion  = 0,
+	               re, im, sum, s[3], c_re, c_im,
+	             * m, * g;
+	const Pair   * mixed;
+
+	n  = rd_ewald_ntypes;
+	nk = rd_ewald_nk;
+	memset( rd_ewald_m,      0, 2 * n * nk * sizeof(double) );
+	memset( rd_ewald_mobile, 0,     n      * sizeof(int)    );
+
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+
+			t     = atom_ptr->mixing_type;
+			mixed = &mixing_table[ t*mixing_ntypes + t ];
+
+			// its own images: all of the r^-12 part, and the r^-6 part, but for frozen atoms (whose S(k) is left out) ...
+			if( ! mixed->attractive_only )
+				repulsion += 2.0 * mixed->epsilon * pow( fabs( mixed->sigma ), 12 ) * rd_ewald_z12;
+			if( atom_ptr->frozen ) {
+				dispersion += 0.5 * rd_ewald_c6[ t*n + t ] * rd_ewald_z6;
+				continue;
+			}
+			// ... for which it is the real-space part, with the k-space sum's r = 0 term taken out
+			dispersion += 0.5 * rd_ewald_c6[ t*n + t ] * (rd_ewald_g6 - pow( rd_ewald_beta, 6 ) / 6.0);
+
+			rd_ewald_mobile[t]++;
+			m = rd_ewald_m + 2*t*nk;
+
+			// e^{2 pi i l s_q} for -lmax_q <= l <= lmax_q, for each fractional coordinate s_q
+			for( int q = 0; q < 3; q++ ) {
+				s[q] = 0;
+				for( int p = 0; p < 3; p++ )
+					s[q] += pbc.reciprocal_basis[p][q] * atom_ptr->pos[p];
+				double *e = rd_ewald_phase + 2*rd_ewald_phase_offset[q];
+				e[0] = 1;
+				e[1] = 0;
+				c_re = cos( 2.0 * pi * s[q] );
+				c_im = sin( 2.0 * pi * s[q] );
+				for( int j = 1; j <= rd_ewald_lmax[q]; j++ ) {
+					e[ 2*j     ] = e[2*(j-1)]*c_re - e[2*(j-1) + 1]*c_im;
+					e[ 2*j + 1 ] = e[2*(j-1)]*c_im + e[2*(j-1) + 1]*c_re;
+					e[-2*j     ] =  e[2*j];
+					e[-2*j + 1 ] = -e[2*j + 1];
+				}
+			}
+
+			for( int kk = 0; kk < nk; kk++ ) {
+				l = rd_ewald_kvec_l + 3*kk;
+				const double *e0 = rd_ewald_phase + 2*(rd_ewald_phase_offset[0] + l[0]),
+				             *e1 = rd_ewald_phase + 2*(rd_ewald_phase_offset[1] + l[1]),
+				             *e2 = rd_ewald_phase + 2*(rd_ewald_phase_offset[2] + l[2]);
+				re = e0[0]*e1[0] - e0[1]*e1[1];
+				im = e0[0]*e1[1] + e0[1]*e1[0];
+				m[2*kk    ] += re*e2[0] - im*e2[1];
+				m[2*kk + 1] += re*e2[1] + im*e2[0];
+			}
+		}
+	}
+
+	// k = 0, where every S_a is just the count of type a
+	sum = 0;
+	for( int a = 0; a < n; a++ ) {
+		if( ! rd_ewald_mobile[a] )
+			continue;
+		for( int b = 0; b < n; b++ )
+			sum += rd_ewald_c6[ a*n + b ] * rd_ewald_mobile[a] * (rd_ewald_mobile[b] + 2.0*rd_ewald_frozen[b]);
+	}
+	dispersion += 0.5 * rd_ewald_a * sum;
+
+	// k and -k together: sum_{a,b} C6_ab Re(M_a M_b*) + 2 Re(M_b* G_b), the frozen-frozen terms left out
+	for( int kk = 0; kk < nk; kk++ ) {
+		sum = 0;
+		for( int b = 0; b < n; b++ ) {
+			if( ! rd_ewald_mobile[b] )
+				continue;
+			m  = rd_ewald_m + 2*b*nk + 2*kk;
+			g  = rd_ewald_g + 2*b*nk + 2*kk;
+			re = 2.0 * g[0];
+			im = 2.0 * g[1];
+			for( int a = 0; a < n; a++ ) {
+				if( ! rd_ewald_mobile[a] )
+					continue;
+				re += rd_ewald_c6[ a*n + b ] * rd_ewald_m[ 2*a*nk + 2*kk     ];
+				im += rd_ewald_c6[ a*n + b ] * rd_ewald_m[ 2*a*nk + 2*kk + 1 ];
+			}
+			sum += re*m[0] + im*m[1];
+		}
+		dispersion += 0.5 * rd_ewald_weight[kk] * sum;
+	}
+
+	return repulsion - dispersion;
+}
+
+
+
+
+void System::rd_ewald_update() {
+// Choose beta and the k-vectors for the cell and cutoff, and sum the frozen atoms' part of S(k).
+// Nothing is redone unless the cell, the cutoff, the tolerance or the mixing types have changed.
+
+	Molecule * molecule_ptr;
+	Atom     * atom_ptr;
+	int        n, nk = 0, l[3], lmax[3], t, width = 0;
+	double     cutoff = pbc.cutoff,
+	           tolerance = rd_crystal_ewald_tolerance,
+	           beta, kcut, k[3], k2, a[3], r, r2, re, im, phase;
+
+	// every atom needs a mixing type for its S(k)
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			if( atom_ptr->mixing_type < 0 )
+				atom_ptr->mixing_type = mixing_type_intern( atom_ptr );
+
+	if(   (rd_ewald_ntypes == mixing_ntypes)
+	   && (rd_ewald_cutoff == cutoff)
+	   && (rd_ewald_tolerance == tolerance)
+	   && ! memcmp( rd_ewald_basis, pbc.basis, sizeof(rd_ewald_basis) )
+	)
+		return;
+
+	n    = mixing_ntypes;
+	beta = solve_decreasing( g6, tolerance, sqrt( g_exponent_limit ) ) / cutoff;
+	kcut = 2.0 * beta * solve_decreasing( f6, tolerance, 20.0 );
+
+	// every pair's real-space term depends on beta
+	if( beta != rd_ewald_beta )
+		flag_all_pairs();
+
+	rd_ewald_beta = beta;
+	rd_ewald_a    = pow( pi, 1.5 ) * beta*beta*beta / (3.0 * pbc.volume);
+
+	// a k-vector of length kcut has |l_q| = |k.a_q|/(2 pi) <= kcut |a_q|/(2 pi)
+	for( int q = 0; q < 3; q++ ) {
+		lmax[q] = (int) ceil( kcut * sqrt( pbc.basis[q][0]*pbc.basis[q][0] + pbc.basis[q][1]*pbc.basis[q][1] + pbc.basis[q][2]*pbc.basis[q][2] ) / (2.0 * pi) );
+		rd_ewald_lmax[q]          = lmax[q];
+		rd_ewald_phase_offset[q]  = width + lmax[q];
+		width                    += 2*lmax[q] + 1;
+	}
+	SafeOps::realloc( rd_ewald_phase, 2 * width * sizeof(double), __LINE__, __FILE__ );
+
+	// the half-space, as for the Coulomb sum (System.EwaldKSpace.cpp)
+	for( l[0] = 0; l[0] <= lmax[0]; l[0]++ ) {
+		for( l[1] = (!l[0] ? 0 : -lmax[1]); l[1] <= lmax[1]; l[1]++ ) {
+			for( l[2] = ((!l[0] && !l[1]) ? 1 : -lmax[2]); l[2] <= lmax[2]; l[2]++ ) {
+
+				for( int p = 0; p < 3; p++ ) {
+					k[p] = 0;
+					for( int q = 0; q < 3; q++ )
+						k[p] += 2.0 * pi * pbc.reciprocal_basis[p][q] * l[q];
+				}
+				k2 = k[0]*k[0] + k[1]*k[1] + k[2]*k[2];
+				if( k2 > kcut*kcut )
+					continue;
+
+				if( nk == rd_ewald_nk_allocd ) {
+					rd_ewald_nk_allocd = rd_ewald_nk_allocd ? 2*rd_ewald_nk_allocd : 256;
+					SafeOps::realloc( rd_ewald_kvec_l, 3 * rd_ewald_nk_allocd * sizeof(int),    __LINE__, __FILE__ );
+					SafeOps::realloc( rd_ewald_weight,     rd_ewald_nk_allocd * sizeof(double), __LINE__, __FILE__ );
+				}
+				for( int q = 0; q < 3; q++ )
+					rd_ewald_kvec_l[3*nk + q] = l[q];
+				// k and -k
+				rd_ewald_weight[nk] = 2.0 * rd_ewald_a * f6( sqrt( k2 ) / (2.0 * beta) );
+				nk++;
+			}
+		}
+	}
+	rd_ewald_nk = nk;
+
+	// C6 of each pair of types
+	SafeOps::realloc( rd_ewald_c6,     (n ? n*n : 1) * sizeof(double),             __LINE__, __FILE__ );
+	SafeOps::realloc( rd_ewald_mobile, (n ? n : 1)   * sizeof(int),                __LINE__, __FILE__ );
+	SafeOps::realloc( rd_ewald_frozen, (n ? n : 1)   * sizeof(int),                __LINE__, __FILE__ );
+	SafeOps::realloc( rd_ewald_m,      (n*nk > 0 ? 2*n*nk : 1) * sizeof(double), __LINE__, __FILE__ );
+	SafeOps::realloc( rd_ewald_g,      (n*nk > 0 ? 2*n*nk : 1) * sizeof(double), __LINE__, __FILE__ );
+	for( int u = 0; u < n; u++ )
+		for( int v = 0; v < n; v++ ) {
+			const Pair &mixed = mixing_table[ u*n + v ];
+			rd_ewald_c6[ u*n + v ] = 4.0 * mixed.epsilon * pow( fabs( mixed.sigma ), 6 );
+		}
+
+	// the frozen atoms' S(k), type by type (in rd_ewald_m for now), and from them G_b = sum_a C6_ab F_a
+	memset( rd_ewald_m,      0, 2 * n * nk * sizeof(double) );
+	memset( rd_ewald_frozen, 0,     n      * sizeof(int)    );
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+			if( ! atom_ptr->frozen )
+				continue;
+			t = atom_ptr->mixing_type;
+			rd_ewald_frozen[t]++;
+			for( int kk = 0; kk < nk; kk++ ) {
+				phase = 0;
+				for( int q = 0; q < 3; q++ )
+					for( int p = 0; p < 3; p++ )
+						phase += 2.0 * pi * pbc.reciprocal_basis[p][q] * rd_ewald_kvec_l[3*kk + q] * atom_ptr->pos[p];
+				rd_ewald_m[ 2*t*nk + 2*kk     ] += cos( phase );
+				rd_ewald_m[ 2*t*nk + 2*kk + 1 ] += sin( phase );
+			}
+		}
+	}
+	for( int b = 0; b < n; b++ )
+		for( int kk = 0; kk < nk; kk++ ) {
+			re = 0;
+			im = 0;
+			for( int u = 0; u < n; u++ ) {
+				re += rd_ewald_c6[ u*n + b ] * rd_ewald_m[ 2*u*nk + 2*kk     ];
+				im += rd_ewald_c6[ u*n + b ] * rd_ewald_m[ 2*u*nk + 2*kk + 1 ];
+			}
+			rd_ewald_g[ 2*b*nk + 2*kk     ] = re;
+			rd_ewald_g[ 2*b*nk + 2*kk + 1 ] = im;
+		}
+
+	// an atom's own images: the real-space part of its r^-6 sum, all of it, and its r^-12 sum
+	rd_ewald_g6  = 0;
+	rd_ewald_z12 = 0;
+	for( l[0] = -4; l[0] <= 4; l[0]++ )
+		for( l[1] = -4; l[1] <= 4; l[1]++ )
+			for( l[2] = -4; l[2] <= 4; l[2]++ ) {
+				if( !l[0] && !l[1] && !l[2] )
+					continue;
+				for( int p = 0; p < 3; p++ ) {
+					a[p] = 0;
+					for( int q = 0; q < 3; q++ )
+						a[p] += pbc.basis[q][p] * l[q];
+				}
+				r2 = a[0]*a[0] + a[1]*a[1] + a[2]*a[2];
+				r  = sqrt( r2 );
+				rd_ewald_g6  += g6( beta * r ) / (r2*r2*r2);
+				rd_ewald_z12 += 1.0 / (r2*r2*r2*r2*r2*r2);
+			}
+	rd_ewald_z6 = rd_ewald_g6 + rd_ewald_a - pow( beta, 6 ) / 6.0;
+	for( int kk = 0; kk < nk; kk++ )
+		rd_ewald_z6 += rd_ewald_weight[kk];
+
+	rd_ewald_ntypes    = n;
+	rd_ewald_cutoff    = cutoff;
+	rd_ewald_tolerance = tolerance;
+	memcpy( rd_ewald_basis, pbc.basis, sizeof(rd_ewald_basis) );
+}
+
+
+
+
+void System::rd_ewald_free() {
+
+	if( rd_ewald_kvec_l ) free( rd_ewald_kvec_l );
+	if( rd_ewald_weight ) free( rd_ewald_weight );
+	if( rd_ewald_phase  ) free( rd_ewald_phase  );
+	if( rd_ewald_c6     ) free( rd_ewald_c6     );
+	if( rd_ewald_mobile ) free( rd_ewald_mobile );
+	if( rd_ewald_frozen ) free( rd_ewald_frozen );
+	if( rd_ewald_m      ) free( rd_ewald_m      );
+	if( rd_ewald_g      ) free( rd_ewald_g      );
+
+	rd_ewald_init();
+}
+
+
+
+
+void System::rd_ewald_init() {
+
+	rd_ewald_ntypes    = -1;
+	rd_ewald_nk        = 0;
+	rd_ewald_nk_allocd = 0;
+	rd_ewald_beta      = 0;
+	rd_ewald_a         = 0;
+	rd_ewald_cutoff    = 0;
+	rd_ewald_tolerance = 0;
+	rd_ewald_g6        = 0;
+	rd_ewald_z6        = 0;
+	rd_ewald_z12       = 0;
+	memset( rd_ewald_basis, 0, sizeof(rd_ewald_basis) );
+	for( int q = 0; q < 3; q++ ) {
+		rd_ewald_lmax[q]         = 0;
+		rd_ewald_phase_offset[q] = 0;
+	}
+
+	rd_ewald_kvec_l    = nullptr;
+	rd_ewald_weight    = nullptr;
+	rd_ewald_phase     = nullptr;
+	rd_ewald_c6        = nullptr;
+	rd_ewald_mobile    = nullptr;
+	rd_ewald_frozen    = nullptr;
+	rd_ewald_m         = nullptr;
+	rd_ewald_g         = nullptr;
+}
@@ -8,7 +8,6 @@
 #include "SafeOps.h"
 #include "System.h"
 #include "UsefulMath.h"
-#include "Vector3D.h"
 
 
 
@@ -31,6 +30,10 @@ double System::energy() {
 		static int count = 0;
 	#endif
 
+	// the trial configuration of a volume move, from the scaled sums (System.VolumeScaling.cpp)
+	if( volume_scale_pending )
+		return volume_scaled_energy();
+
 	natoms = countNatoms();
 
 	// get the pairwise terms necessary for the energy calculation 
@@ -38,15 +41,24 @@ double System::energy() {
 
 	// Only on the first simulation step, make sure that all recalculate flags are set if we made a 
 	// volume change (or just reverted from one) set recalculate flags OR if replaying a trajectory 
-	// we set last_volume at the end of this function
-	if(   last_volume != pbc.volume   ||   ensemble == ENSEMBLE_REPLAY   ||   observables->energy == 0.0  )
+	// we set last_volume at the end of this function. Likewise if delta_energy() has been moving
+	// molecules without updating the cached pair energies.
+	if(   last_volume != pbc.volume   ||   ensemble == ENSEMBLE_REPLAY   ||   observables->energy == 0.0   ||   pair_energies_stale  )
 		flag_all_pairs();
+
+	// this is the full calculation that delta_energy() periodically falls back on
+	pair_energies_stale                  = 0;
+	delta_energy_count                   = 0;
+	observables->rd_energy_carry         = 0;
+	observables->coulombic_energy_carry  = 0;
 		
 	if (cavity_autoreject_absolute)
 		potential_energy += cavity_absolute_check();
 	if (potential_energy == 0) {
-		// get the repulsion/dispersion potential
-		if (rd_anharmonic)
+		// get the repulsion/dispersion potential (and the electrostatics, if specialized for this configuration)
+		if (energy_pipeline)
+			(this->*energy_pipeline)(rd_energy, coulombic_energy);
+		else if (rd_anharmonic)
 			rd_energy = anharmonic();
 		else if (use_sg)
 			rd_energy = sg();
@@ -79,7 +91,7 @@ double System::energy() {
 				kinetic_energy = coulombic_kinetic_gwp();
 				observables->kinetic_energy = kinetic_energy;
 			}
-			else
+			else if (!energy_pipeline) // otherwise done along with the repulsion/dispersion
 				coulombic_energy = coulombic();
 
 			observables->coulombic_energy = coulombic_energy;
@@ -158,6 +170,17 @@ double System::energy() {
 	
 	if( gwp )
 		potential_energy += kinetic_energy;
+
+	update_energy_observables( potential_energy );
+
+	return potential_energy;
+}
+
+
+
+void System::update_energy_observables( double potential_energy ) {
+// Record a newly computed total potential energy, along with the observables derived from it.
+
 	observables->energy = potential_energy;
 
 	countN();
@@ -174,8 +197,6 @@ double System::energy() {
 
 	// set last known volume
 	last_volume = pbc.volume;
-
-	return potential_energy;
 }
 
 
@@ -265,51 +286,30 @@ double System::sum_eiso_vdw ( double * sqrtKinv ) {
 	char       linebuf[maxLine];
 	double     e_iso = 0;
 	Molecule * mp;
-	vdw_t    * vp;
-	vdw_t    * vpscan;
 
 	//loop through molecules. if not known, calculate, store and count. otherwise just count.
 	for ( mp = molecules; mp; mp=mp->next ) {
-		for ( vp = vdw_eiso_info; vp != NULL; vp=vp->next ) { //loop through all vp's
-			if ( strncmp(vp->mtype,mp->moleculetype, maxLine ) == 0 ) {
-					e_iso += vp->energy; //count energy
-					break; //break out of vp loop. the current molecule is accounted for now. go to the next molecule
-			}
-			else continue; //not a match, check the next vp
-		} //vp loop
-
-		if ( vp == NULL ) { //if the molecule was unmatched, we need to grow the list
-			// end of vp list and we haven't matched yet -> grow vdw_eiso_info
-			// scan to the last non-NULL element
-			if ( vdw_eiso_info == NULL ) {
-				SafeOps::calloc( vdw_eiso_info, 1, sizeof(vdw_t), __LINE__, __FILE__ );
-				vpscan = vdw_eiso_info; //set scan pointer
-			} else {
-				for ( vpscan = vdw_eiso_info; vpscan->next != NULL; vpscan=vpscan->next );
-				SafeOps::calloc( vpscan->next, 1, sizeof(vdw_t), __LINE__, __FILE__ ); //allocate space
-				vpscan = vpscan->next;
-			} //done scanning and malloc'ing
-		
-			//set values
-			strncpy( vpscan->mtype, mp->moleculetype, maxLine ); //assign moleculetype
-			vpscan->energy = calc_e_iso( sqrtKinv, mp ); //assign energy
-			if ( std::isfinite(vpscan->energy) == 0 ) { //if nan, then calc_e_iso failed
+
+		int t = mp->moleculetype_id;
+		if ( t >= (int) vdw_eiso_energy.size() )
+			vdw_eiso_energy.resize( TypeRegistry::molecule_type_count(), NAN );
+
+		if ( std::isnan(vdw_eiso_energy[t]) ) { //if the molecule type hasn't been seen, calculate its energy
+			vdw_eiso_energy[t] = calc_e_iso( sqrtKinv, mp );
+			if ( std::isfinite(vdw_eiso_energy[t]) == 0 ) { //if nan, then calc_e_iso failed
 				sprintf(linebuf,"VDW: Problem in calc_e_iso.\n");
 				Output::out( linebuf );
 				throw infinite_energy_calc;
 			}
-			//otherwise count the energy and move to the next molecule
-			e_iso += vpscan->energy;
+		}
 
-		} //vp==NULL
+		e_iso += vdw_eiso_energy[t];
 	} //mp loop	
 
 	////all of this logic is actually really bad if we're doing surface fitting, since omega will change... :-(
-	//free everything so we can recalc next step
-	if( ensemble == ENSEMBLE_SURF_FIT )  {
-		free_vdw_eiso( vdw_eiso_info );
-		vdw_eiso_info = NULL;
-	}
+	//forget everything so we can recalc next step
+	if( ensemble == ENSEMBLE_SURF_FIT )
+		vdw_eiso_energy.clear();
 	
 	return e_iso;
 }
@@ -354,28 +354,6 @@ double System::calc_e_iso ( double * sqrtKinv, Molecule * mptr ) {
 }
 
 
-//free vdw pointer which keeps track of e_iso energies
-void System::free_vdw_eiso(vdw_t * vdw_eiso_info) {
-
-	vdw_t * vp;
-	vdw_t ** varray = NULL;
-	int i=0;
-
-	for ( vp = vdw_eiso_info; vp; vp=vp->next ) {
-		SafeOps::realloc( varray, sizeof(vdw_t *)*(i+1), __LINE__, __FILE__ );
-		varray[i]=vp;
-		i++;
-	}
-
-	while ( i>0 ) {
-		i--;
-		free(varray[i]);
-	}
-
-	free(varray);
-
-	return;
-}
 
 
 //build C matrix for a given molecule/system, with atom indicies (offset)/3..(offset+dim)/3
@@ -597,9 +575,6 @@ double System::lr_vdw_corr() {
 	Atom     * atom_ptr;
 	Pair     * pair_ptr;
 
-	double w1, w2;   //omegas
-	double a1, a2;   //alphas
-	double cC;       //leading coefficient to r^-6
 	double corr = 0; //correction to the energy
 
 	//skip if PBC isn't set-up
@@ -608,32 +583,45 @@ double System::lr_vdw_corr() {
 		return 0;
 	}
 
-	for ( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
-		for ( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
-			for ( pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next ) {
-					//skip if frozen
-					if ( pair_ptr->frozen ) continue;
-					// skip if same molecule  // don't do this... this DOES contribute to LRC
-					// if ( molecule_ptr == pair_ptr->molecule ) continue;
-					// fetch alphas and omegas
-					a1 = atom_ptr->polarizability;
-					a2 = pair_ptr->atom->polarizability;
-					w1 = atom_ptr->omega;
-					w2 = pair_ptr->atom->omega;
-					if ( w1 == 0 || w2 == 0 || a1 == 0 || a2 == 0 ) continue; //no vdw energy
-					// 3/4 hbar/k_B(Ks) omega(s^-1)  Ang^6
-					cC=1.5 * c_hBar * w1*w2/(w1+w2) * au2invseconds * a1 * a2;
-
-					// long-range correction
-					corr += -4.0/3.0 * pi * cC * pow(pbc.cutoff,-3) / pbc.volume;
-			}
-		}
-	}
+	// from the atom counts (System.TailCorrection.cpp)
+	if ( lrc_by_type() )
+		return lrc_from_counts( LRC_TERMS_VDW, pbc.cutoff );
+
+	for ( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		for ( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			for ( pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next )
+				corr += lr_vdw_pair( atom_ptr, pair_ptr->atom, pair_ptr );
 
 	return corr;
 }
 
 
+
+// the long-range correction for a single pair
+double System::lr_vdw_pair( const Atom * atom_ptr, const Atom * other_ptr, const Pair * pair_ptr ) {
+
+	double w1, w2;   //omegas
+	double a1, a2;   //alphas
+	double cC;       //leading coefficient to r^-6
+
+	//skip if frozen
+	if ( pair_ptr->frozen ) return 0;
+	// skip if same molecule  // don't do this... this DOES contribute to LRC
+	// if ( molecule_ptr == pair_ptr->molecule ) continue;
+	// fetch alphas and omegas
+	a1 = atom_ptr->polarizability;
+	a2 = other_ptr->polarizability;
+	w1 = atom_ptr->omega;
+	w2 = other_ptr->omega;
+	if ( w1 == 0 || w2 == 0 || a1 == 0 || a2 == 0 ) return 0; //no vdw energy
+	// 3/4 hbar/k_B(Ks) omega(s^-1)  Ang^6
+	cC=1.5 * c_hBar * w1*w2/(w1+w2) * au2invseconds * a1 * a2;
+
+	// long-range correction
+	return -4.0/3.0 * pi * cC * pow(pbc.cutoff,-3) / pbc.volume;
+}
+
+
 // feynman-hibbs correction - molecular pair finite differencing method
 double System::fh_vdw_corr() {
 
@@ -908,127 +896,100 @@ double System::lj()
 	Molecule * molecule_ptr = nullptr;
 	Atom     * atom_ptr = nullptr;
 	Pair     * pair_ptr = nullptr;
-	double     sigma_over_r = 0,
-		term12 = 0,
-		term6 = 0,
-		sigma_over_r6 = 0,
-		sigma_over_r12 = 0,
-		r = 0,
-		potential = 0,
-		potential_classical = 0,
+	double     potential = 0,
 		cutoff = 0;
-	int        i[3] = { 0 };
-	double     a[3] = { 0 };
+	bool       batched = lj_block_supported();  // evaluate recalculated pairs in blocks (System.LJBlock.cpp)
+	bool       lrc_pairs = rd_lrc && !lrc_by_type();  // otherwise the LRC comes from the atom counts (System.TailCorrection.cpp)
 
 	//set the cutoff
-	if (rd_crystal)
+	if (rd_crystal && !rd_crystal_ewald)
 		cutoff = 2.0 * pbc.cutoff * ((double)rd_crystal_order - 0.5);
 	else
 		cutoff = pbc.cutoff;
 
-	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
-		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
-			for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next) {
-
-				if (pair_ptr->recalculate_energy) {
+	// the pairs' real-space terms need the current beta
+	if (rd_crystal_ewald)
+		rd_ewald_update();
 
-					pair_ptr->rd_energy = 0;
+	if (verlet_list) {
 
-					// pair LRC 
-					if (rd_lrc)
+		// pairs beyond the list radius contribute only their LRC, which is re-summed whenever the list is rebuilt
+		if (lrc_pairs && verlet_list_lrc_stale) {
+			verlet_list_lrc = 0;
+			for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
+				for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
+					for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next) {
 						pair_ptr->lrc = lj_lrc_corr(atom_ptr, pair_ptr, cutoff);
+						verlet_list_lrc += pair_ptr->lrc;
+					}
+			verlet_list_lrc_stale = 0;
+		}
 
-					// to include a contribution, we require
-					if ((pair_ptr->rimg - SMALL_dR < cutoff) &&   // inside cutoff?
-						(!pair_ptr->rd_excluded || rd_crystal) &&   // either not excluded OR rd_crystal is ON
-						(!pair_ptr->frozen)
-						) { //not frozen
-
-							//loop over unit cells
-						if (rd_crystal) {
-							sigma_over_r6 = 0;
-							sigma_over_r12 = 0;
-							for (i[0] = -(rd_crystal_order - 1); i[0] <= rd_crystal_order - 1; i[0]++)
-								for (i[1] = -(rd_crystal_order - 1); i[1] <= rd_crystal_order - 1; i[1]++)
-									for (i[2] = -(rd_crystal_order - 1); i[2] <= rd_crystal_order - 1; i[2]++) {
-										if (!i[0] && !i[1] && !i[2] && pair_ptr->rd_excluded)
-											continue; //no i=j=k=0 for excluded pairs (intra-molecular)
-										//calculate pair separation (atom with it's image)
-										for (int p = 0; p < 3; p++) {
-											a[p] = 0;
-											for (int q = 0; q < 3; q++)
-												a[p] += pbc.basis[q][p] * i[q];
-											a[p] += atom_ptr->pos[p] - pair_ptr->atom->pos[p];
-										}
-										r = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
-
-										if (r > cutoff)
-											continue;
-										sigma_over_r = fabs(pair_ptr->sigma) / r;
-										sigma_over_r6 += pow(sigma_over_r, 6);
-										sigma_over_r12 += pow(sigma_over_r, 12);
-									}
-						}
-						else { //otherwise, calculate as normal
-							sigma_over_r = fabs(pair_ptr->sigma) / pair_ptr->rimg;
-							sigma_over_r6 = sigma_over_r * sigma_over_r*sigma_over_r;
-							sigma_over_r6 *= sigma_over_r6;
-							sigma_over_r12 = sigma_over_r6 * sigma_over_r6;
-						}
-
-						// the LJ potential 
-						if (spectre) {
-							term6 = 0;
-							term12 = sigma_over_r12;
-							potential_classical = term12;
-						}
-						else {
+		for (int i = 0; i < natoms; i++) {
+			for (int e = verlet_list_start[i]; e < verlet_list_start[i + 1]; e++) {
+				pair_ptr = verlet_list_pair[e];
+				if (pair_ptr->recalculate_energy) {
+					if (batched) {
+						potential += lj_block_queue(pair_ptr, cutoff);
+						continue;
+					}
+					lj_pair(molecule_array[i], atom_array[i], pair_ptr, cutoff);
+				}
+				potential += pair_ptr->rd_energy;
+			}
+		}
+		if (batched)
+			potential += lj_block_flush();
+		if (lrc_pairs)
+			potential += verlet_list_lrc;
 
-							if (polarvdw)
-								term6 = 0; //vdw calc'd by vdw.c	
-							else term6 = sigma_over_r6;
+	} else {
 
+		for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
+			for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
+				for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next) {
 
-							if (pair_ptr->attractive_only)
-								term12 = 0;
-							else
-								term12 = sigma_over_r12;
+					if (pair_ptr->recalculate_energy) {
 
+						// pair LRC 
+						if (lrc_pairs)
+							pair_ptr->lrc = lj_lrc_corr(atom_ptr, pair_ptr, cutoff);
 
-							if (cdvdw_sig_repulsion)
-								potential_classical = pair_ptr->sigrep*term12; //C6*sig^6/r^12
-							else
-								potential_classical = 4.0*pair_ptr->epsilon*(term12 - term6);
+						// the pair's energy is summed when its block is flushed
+						if (batched) {
+							potential += pair_ptr->lrc + lj_block_queue(pair_ptr, cutoff);
+							continue;
 						}
+						lj_pair(molecule_ptr, atom_ptr, pair_ptr, cutoff);
 
-						pair_ptr->rd_energy += potential_classical;
-
-						if (feynman_hibbs)
-							pair_ptr->rd_energy += lj_fh_corr(molecule_ptr, pair_ptr, feynman_hibbs_order, term12, term6);
-
-					} //if qualified contributions
+					} // if recalculate
 
-				} // if recalculate
-
-				// sum all of the pairwise terms 
-				potential += pair_ptr->rd_energy + pair_ptr->lrc;
+					// sum all of the pairwise terms 
+					potential += pair_ptr->rd_energy + pair_ptr->lrc;
 
-			} // pair
-		} // atom
-	} // molecule
+				} // pair
+			} // atom
+		} // molecule
+		if (batched)
+			potential += lj_block_flush();
+	}
 
 	// molecule self-energy for rd_crystal -> energy of molecule interacting with its periodic neighbors
 
-	if (rd_crystal)
+	if (rd_crystal_ewald)
+		potential += rd_ewald_reciprocal();
+	else if (rd_crystal)
 		for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
 			for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
 				potential += rd_crystal_self(atom_ptr, cutoff);
 
 	// calculate self LRC interaction
-	if (rd_lrc)
+	if (lrc_pairs)
 		for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
 			for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
 				potential += lj_lrc_self(atom_ptr, cutoff);
+	else if (rd_lrc)
+		potential += lrc_from_counts(LRC_TERMS_RD, cutoff);
 
 	return potential;
 
@@ -1036,6 +997,101 @@ double System::lj()
 
 
 
+void System::lj_pair(Molecule * molecule_ptr, Atom * atom_ptr, Pair * pair_ptr, double cutoff)
+{
+// recompute the cached repulsion/dispersion energy of a single pair
+
+	double     sigma_over_r = 0,
+		term12 = 0,
+		term6 = 0,
+		sigma_over_r6 = 0,
+		sigma_over_r12 = 0,
+		r = 0,
+		potential_classical = 0;
+	int        i[3] = { 0 };
+	double     a[3] = { 0 };
+
+	// the lattice sums by Ewald summation instead (System.DispersionEwald.cpp)
+	if (rd_crystal_ewald) {
+		rd_ewald_pair(atom_ptr, pair_ptr);
+		return;
+	}
+
+	pair_ptr->rd_energy = 0;
+
+	// to include a contribution, we require
+	if ((pair_ptr->rimg - SMALL_dR < cutoff) &&   // inside cutoff?
+		(!pair_ptr->rd_excluded || rd_crystal) &&   // either not excluded OR rd_crystal is ON
+		(!pair_ptr->frozen)
+		) { //not frozen
+
+			//loop over unit cells
+		if (rd_crystal) {
+			sigma_over_r6 = 0;
+			sigma_over_r12 = 0;
+			for (i[0] = -(rd_crystal_order - 1); i[0] <= rd_crystal_order - 1; i[0]++)
+				for (i[1] = -(rd_crystal_order - 1); i[1] <= rd_crystal_order - 1; i[1]++)
+					for (i[2] = -(rd_crystal_order - 1); i[2] <= rd_crystal_order - 1; i[2]++) {
+						if (!i[0] && !i[1] && !i[2] && pair_ptr->rd_excluded)
+							continue; //no i=j=k=0 for excluded pairs (intra-molecular)
+						//calculate pair separation (atom with it's image)
+						for (int p = 0; p < 3; p++) {
+							a[p] = 0;
+							for (int q = 0; q < 3; q++)
+								a[p] += pbc.basis[q][p] * i[q];
+							a[p] += atom_ptr->pos[p] - pair_ptr->atom->pos[p];
+						}
+						r = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+
+						if (r > cutoff)
+							continue;
+						sigma_over_r = fabs(pair_ptr->sigma) / r;
+						sigma_over_r6 += pow(sigma_over_r, 6);
+						sigma_over_r12 += pow(sigma_over_r, 12);
+					}
+		}
+		else { //otherwise, calculate as normal
+			sigma_over_r = fabs(pair_ptr->sigma) / pair_ptr->rimg;
+			sigma_over_r6 = sigma_over_r * sigma_over_r*sigma_over_r;
+			sigma_over_r6 *= sigma_over_r6;
+			sigma_over_r12 = sigma_over_r6 * sigma_over_r6;
+		}
+
+		// the LJ potential 
+		if (spectre) {
+			term6 = 0;
+			term12 = sigma_over_r12;
+			potential_classical = term12;
+		}
+		else {
+
+			if (polarvdw)
+				term6 = 0; //vdw calc'd by vdw.c	
+			else term6 = sigma_over_r6;
+
+
+			if (pair_ptr->attractive_only)
+				term12 = 0;
+			else
+				term12 = sigma_over_r12;
+
+
+			if (cdvdw_sig_repulsion)
+				potential_classical = pair_ptr->sigrep*term12; //C6*sig^6/r^12
+			else
+				potential_classical = 4.0*pair_ptr->epsilon*(term12 - term6);
+		}
+
+		pair_ptr->rd_energy += potential_classical;
+
+		if (feynman_hibbs)
+			pair_ptr->rd_energy += lj_fh_corr(molecule_ptr, pair_ptr, feynman_hibbs_order, term12, term6);
+
+	} //if qualified contributions
+}
+
+
+
 double System::lj_lrc_corr(Atom * atom_ptr, Pair * pair_ptr, double cutoff)
 {
 
@@ -1062,7 +1118,7 @@ double System::lj_lrc_corr(Atom * atom_ptr, Pair * pair_ptr, double cutoff)
 
 		if (cdvdw_sig_repulsion)
 			return (4.0 / 9.0) * pi * pair_ptr->sigrep * sig3 * sig_cut9 / pbc.volume;
-		else if (polarvdw) //only repulsion term, if polarvdw is on
+		else if (polarvdw || rd_crystal_ewald) //only repulsion term, if polarvdw is on (or the dispersion is Ewald summed)
 			return (16.0 / 9.0) * pi * pair_ptr->epsilon * sig3 * sig_cut9 / pbc.volume;
 		else //if polarvdw is off, do the usual thing
 			return ((16.0 / 3.0)*pi * pair_ptr->epsilon * sig3)  *  ((1.0 / 3.0)*sig_cut9 - sig_cut3) / pbc.volume;
@@ -1089,7 +1145,7 @@ double System::lj_lrc_self(Atom * atom_ptr, double cutoff)
 
 		if (cdvdw_sig_repulsion)
 			return (1.0 / 3.0) * pi * hBar / kB * au2invseconds * atom_ptr->omega * atom_ptr->polarizability * atom_ptr->polarizability / sig3 * sig_cut9 / pbc.volume;
-		else if (polarvdw) //only repulsion term, if polarvdw is on
+		else if (polarvdw || rd_crystal_ewald) //only repulsion term, if polarvdw is on (or the dispersion is Ewald summed)
 			return (16.0 / 9.0) * pi * atom_ptr->epsilon * sig3 * sig_cut9 / pbc.volume;
 		else //if polarvdw is off, do the usual thing
 			return ((16.0 / 3.0) * pi * atom_ptr->epsilon*sig3)  *  ((1.0 / 3.0) * sig_cut9 - sig_cut3) / pbc.volume;
@@ -1214,8 +1270,7 @@ double System::rd_crystal_self(Atom * aptr, double cutoff)
 
 double System::lj_buffered_14_7()
 {
-	double potential = 0.0, potential_classical;
-	double r_over_sigma, first_term, second_term;
+	double potential = 0.0;
 
 	Molecule * molecule_ptr = nullptr;
 	Atom     * atom_ptr = nullptr;
@@ -1230,12 +1285,8 @@ double System::lj_buffered_14_7()
 
 					// make sure we're not excluded or beyond the cutoff
 					if (!((pair_ptr->rimg > pbc.cutoff) || pair_ptr->rd_excluded || pair_ptr->frozen)) {
-						r_over_sigma = pair_ptr->rimg / pair_ptr->sigma;
-						first_term = pow(1.07 / (r_over_sigma + 0.07), 7);
-						second_term = (1.12 / (pow(r_over_sigma, 7) + 0.12) - 2);
-						potential_classical = pair_ptr->epsilon*first_term*second_term;
-						pair_ptr->rd_energy += potential_classical;
-
+						if (!pair_table_lookup(PAIR_TABLE_ENERGY, atom_ptr->mixing_type, pair_ptr->atom->mixing_type, pair_ptr->rimg, pbc.cutoff, pair_ptr->rd_energy))
+							pair_ptr->rd_energy = pair_kernel(lj_buffered_14_7_kernel, pair_ptr, pair_ptr->rimg);
 					}
 				}
 				potential += pair_ptr->rd_energy;
@@ -1248,6 +1299,17 @@ double System::lj_buffered_14_7()
 
 
 
+// the buffered 14-7 pair energy at separation r
+double System::lj_buffered_14_7_kernel(double r, const double * param)
+{
+	double r_over_sigma = r / param[PAIR_KERNEL_SIGMA];
+	double first_term = pow(1.07 / (r_over_sigma + 0.07), 7);
+	double second_term = (1.12 / (pow(r_over_sigma, 7) + 0.12) - 2);
+	return param[PAIR_KERNEL_EPSILON] * first_term*second_term;
+}
+
+
+
 double System::lj_buffered_14_7_nopbc()
 {
 	double potential = 0,
@@ -1403,6 +1465,9 @@ double System::coulombic() {
 		reciprocal = coulombic_reciprocal();
 		self = coulombic_self();
 
+		// delta_energy() updates the real-space part incrementally, so it needs this part on its own
+		observables->kspace_energy = reciprocal + self;
+
 		// return the total electrostatic energy
 		potential = real + reciprocal + self;
 	}
@@ -1464,42 +1529,29 @@ double System::coulombic_real() {
 	Atom     * atom_ptr = nullptr;
 	Pair     * pair_ptr = nullptr;
 
-	double alpha = ewald_alpha,
-		r = 0,
-		erfc_term = 0,
-		gaussian_term = 0,
-		potential = 0,
-		potential_classical = 0;
+	double potential = 0;
+
+
+	if (verlet_list) {
 
+		// intra-molecular pairs are always listed, so the self-interaction terms are all visited
+		for (int i = 0; i < natoms; i++) {
+			for (int e = verlet_list_start[i]; e < verlet_list_start[i + 1]; e++) {
+				pair_ptr = verlet_list_pair[e];
+				if (pair_ptr->recalculate_energy)
+					coulombic_real_pair(molecule_array[i], atom_array[i], pair_ptr);
+				potential += pair_ptr->es_real_energy - pair_ptr->es_self_intra_energy;
+			}
+		}
+		return potential;
+	}
 
 	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
 		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
 			for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next) {
 
-				if (pair_ptr->recalculate_energy) {
-					pair_ptr->es_real_energy = 0;
-
-					if (!pair_ptr->frozen) {
-
-						r = pair_ptr->rimg;
-						if (!((r > pbc.cutoff) || pair_ptr->es_excluded)) { // unit cell part
-
-							//calculate potential contribution
-							erfc_term = erfc(alpha*r);
-							gaussian_term = exp(-alpha * alpha*r*r);
-							potential_classical = atom_ptr->charge * pair_ptr->atom->charge * erfc_term / r;
-							//store for pair pointer, so we don't always have to recalculate
-							pair_ptr->es_real_energy += potential_classical;
-
-							if (feynman_hibbs)
-								pair_ptr->es_real_energy += coulombic_real_FH(molecule_ptr, pair_ptr, gaussian_term, erfc_term);
-
-						}
-						else if (pair_ptr->es_excluded) // calculate the charge-to-screen interaction
-							pair_ptr->es_self_intra_energy = atom_ptr->charge * pair_ptr->atom->charge * erf(alpha*pair_ptr->r) / pair_ptr->r;
-
-					} // frozen 
-				} // recalculate 
+				if (pair_ptr->recalculate_energy)
+					coulombic_real_pair(molecule_ptr, atom_ptr, pair_ptr);
 
 				// sum all of the pairwise terms
 				potential += pair_ptr->es_real_energy - pair_ptr->es_self_intra_energy;
@@ -1512,6 +1564,40 @@ double System::coulombic_real() {
 }
 
 
+// recompute the cached real space energy of a single pair
+void System::coulombic_real_pair(Molecule * molecule_ptr, Atom * atom_ptr, Pair * pair_ptr) {
+
+	double alpha = ewald_alpha,
+		r = 0,
+		erfc_term = 0,
+		gaussian_term = 0,
+		potential_classical = 0;
+
+	pair_ptr->es_real_energy = 0;
+
+	if (!pair_ptr->frozen) {
+
+		r = pair_ptr->rimg;
+		if (!((r > pbc.cutoff) || pair_ptr->es_excluded)) { // unit cell part
+
+			//calculate potential contribution
+			erfc_term = erfc_lookup(alpha*r);
+			gaussian_term = exp_neg_lookup(alpha * alpha*r*r);
+			potential_classical = atom_ptr->charge * pair_ptr->atom->charge * erfc_term / r;
+			//store for pair pointer, so we don't always have to recalculate
+			pair_ptr->es_real_energy += potential_classical;
+
+			if (feynman_hibbs)
+				pair_ptr->es_real_energy += coulombic_real_FH(molecule_ptr, pair_ptr, gaussian_term, erfc_term);
+
+		}
+		else if (pair_ptr->es_excluded) // calculate the charge-to-screen interaction (unless coulombic_self() has it)
+			pair_ptr->es_self_intra_energy = es_intra_by_type() ? 0.0 : atom_ptr->charge * pair_ptr->atom->charge * erf_lookup(alpha*pair_ptr->r) / pair_ptr->r;
+
+	} // frozen 
+}
+
+
 // feynman-hibbs for real space
 double System::coulombic_real_FH(Molecule * molecule_ptr, Pair *pair_ptr, double gaussian_term, double erfc_term) {
 
@@ -1541,7 +1627,7 @@ double System::coulombic_real_FH(Molecule * molecule_ptr, Pair *pair_ptr, double
 
 	if (order >= 4) {
 
-		d3u = (gaussian_term / sqrt(pi))*(-8.0*(a3*a2)*r - 8.0*(a3) / r - 12.0*alpha*ir3) - 6.0*erfc(alpha*r)*ir4;
+		d3u = (gaussian_term / sqrt(pi))*(-8.0*(a3*a2)*r - 8.0*(a3) / r - 12.0*alpha*ir3) - 6.0*erfc_term*ir4;
 		d4u = (gaussian_term / sqrt(pi))*(8.0*a3*a2 + 16.0*a3*a4*rr + 32.0*a3*ir2 + 48.0*ir4) + 24.0*erfc_term*(ir4*ir);
 		fh_4th_order = M2A4 * (hBar4 / (1152.0*(kB*kB*temperature*temperature*reduced_mass*reduced_mass)))  *  (15.0*du*ir3 + 4.0*d3u / r + d4u);
 	}
@@ -1555,61 +1641,17 @@ double System::coulombic_real_FH(Molecule * molecule_ptr, Pair *pair_ptr, double
 // fourier space sum 
 double System::coulombic_reciprocal() {
 
-	Molecule * molecule_ptr = nullptr;
-	Atom     * atom_ptr = nullptr;
-
-	int    kmax             = ewald_kmax,
-	       l[3]             = { 0 };
-	double alpha            = ewald_alpha,
-	       k[3]             = { 0 },
-	       k_squared        = 0,
-	       position_product = 0,
-	       SF_re            = 0,
-	       SF_im            = 0, // structure factor 
-	       potential        = 0;
-
-	// perform the fourier sum over a hemisphere (skipping certain points to avoid overcounting the face) 
-	for (l[0] = 0; l[0] <= kmax; l[0]++) {
-		for (l[1] = (!l[0] ? 0 : -kmax); l[1] <= kmax; l[1]++) {
-			for (l[2] = ((!l[0] && !l[1]) ? 1 : -kmax); l[2] <= kmax; l[2]++) {
-
-				//if norm is out of the sphere, skip
-				if (UsefulMath::iidotprod(l, l) > kmax*kmax)
-					continue;
-
-				// get the reciprocal lattice vectors 
-				for (int p = 0; p < 3; p++) {
-					k[p] = 0;
-					for (int q = 0; q < 3; q++)
-						k[p] += 2.0 * pi * pbc.reciprocal_basis[p][q] * l[q];
-				}
-				k_squared = UsefulMath::dddotprod(k, k);
+	double potential = 0;
 
-				// structure factor 
-				SF_re = 0;
-				SF_im = 0;
-				for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
-					for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
+	if( ewald_spme )
+		return spme_reciprocal();
 
-						if (atom_ptr->frozen)
-							continue; //skip frozen
-						if (atom_ptr->charge == 0.0)
-							continue; //skip if no charge
+	// the structure factor is kept up to date between calls (incrementally, for single-molecule moves)
+	ewald_sf_update();
 
-						// the inner product of the position vector and the k vector 
-						position_product = UsefulMath::dddotprod(k, atom_ptr->pos);
-
-						SF_re += atom_ptr->charge * cos(position_product);
-						SF_im += atom_ptr->charge * sin(position_product);
-
-					} // atom
-				} // molecule
-
-				potential += exp(-k_squared / (4.0*alpha*alpha)) / k_squared * (SF_re*SF_re + SF_im * SF_im);
-
-			} // end for n
-		} // end for m
-	} // end for l
+	// perform the fourier sum over a hemisphere (skipping certain points to avoid overcounting the face) 
+	for (int kk = 0; kk < ewald_nk; kk++)
+		potential += ewald_kvec_weight[kk] * (ewald_sf_re[kk] * ewald_sf_re[kk] + ewald_sf_im[kk] * ewald_sf_im[kk]);
 
 	potential *= 4.0 * pi / pbc.volume;
 
@@ -1625,6 +1667,10 @@ double System::coulombic_self() {
 	double     alpha = ewald_alpha,
 		self_potential = 0.0;
 
+	// the self terms of each molecule type, along with its intra-molecular ones (see System.IntraConstants.cpp)
+	if (es_intra_by_type())
+		return es_intra_from_counts();
+
 	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
 		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
 			if (atom_ptr->frozen)
@@ -1641,115 +1687,6 @@ double System::coulombic_self() {
 
 
 
-//   Axilrod Teller 3-body energy   /////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-
-double System::axilrod_teller ()
-// Copyright 2015 Adam Hogan
-{
-	double potential = 0.0, c9, rij, rik, rjk, cos_part;
-	Molecule * molecule1, *molecule2, *molecule3;
-	Atom     * atom1, *atom2, *atom3;
-	Pair temp;
-	Vector3D  ij, ik, jk, a, b;
-
-	for (molecule1 = molecules; molecule1; molecule1 = molecule1->next) {
-		for (molecule2 = molecules; molecule2; molecule2 = molecule2->next) {
-			for (molecule3 = molecules; molecule3; molecule3 = molecule3->next) {
-				int number_of_unique_molecules = 1;
-				if (molecule2 != molecule1) {
-					number_of_unique_molecules++;
-				}
-				if (molecule3 != molecule1 && molecule3 != molecule2) {
-					number_of_unique_molecules++;
-				}
-				if (number_of_unique_molecules > 1) {
-					for (atom1 = molecule1->atoms; atom1; atom1 = atom1->next) {
-						for (atom2 = molecule2->atoms; atom2; atom2 = atom2->next) {
-							for (atom3 = molecule3->atoms; atom3; atom3 = atom3->next) {
-								if (atom1 != atom2 && atom1 != atom3 && atom2 != atom3) {
-
-									double atom1_c9, atom2_c9, atom3_c9;
-									atom1_c9 = atom1->c9;
-									atom2_c9 = atom2->c9;
-									atom3_c9 = atom3->c9;
-
-									// Axilrod-Teller parameters in http://arxiv.org/pdf/1201.1532.pdf and http://dx.doi.org/10.1063/1.440310
-									// Midzuno-Kihara approximation for c9 http://dx.doi.org/10.1143/JPSJ.11.1045
-									if (midzuno_kihara_approx)
-									{
-										atom1_c9 = 3.0 / 4.0*atom1->polarizability*6.7483345*atom1->c6;
-										atom2_c9 = 3.0 / 4.0*atom2->polarizability*6.7483345*atom2->c6;
-										atom3_c9 = 3.0 / 4.0*atom3->polarizability*6.7483345*atom3->c6;
-									}
-
-									// Mixing rule, ep. 20 of http://dx.doi.org/10.1063/1.440310
-									c9 = pow(pow(atom1->polarizability*6.7483345, 3)*pow(atom2->polarizability*6.7483345, 3)*pow(atom3->polarizability*6.7483345, 3), 1.0 / 3.0) *
-										3.0 / (1.0 / (atom1_c9 / pow(atom1->polarizability*6.7483345, 3)) + 1.0 / (atom2_c9 / pow(atom2->polarizability*6.7483345, 3)) + 1.0 / (atom3_c9 / pow(atom3->polarizability*6.7483345, 3)));
-
-									if (atom1->polarizability == 0.0 || atom2->polarizability == 0.0 || atom3->polarizability == 0.0)
-										c9 = 0.0; // avoid division by zero
-
-									c9 *= 0.0032539449 / (3.166811429*0.000001); // convert H*Bohr^9 to K*Angstrom^9
-
-									// reset fake pair ptr
-									temp.d_prev[0] = temp.d_prev[1] = temp.d_prev[2] = -999999999999.;
-									// get minimum image distance
-									minimum_image (atom1, atom2, &temp);
-									rij = temp.rimg;
-									ij.set (temp.dimg[0], temp.dimg[1], temp.dimg[2]);
-
-									// reset fake pair ptr
-									temp.d_prev[0] = temp.d_prev[1] = temp.d_prev[2] = -999999999999.;
-									// get minimum image distance
-									minimum_image (atom1, atom3, &temp);
-									rik = temp.rimg;
-									ik.set (temp.dimg[0], temp.dimg[1], temp.dimg[2]);
-
-									// reset fake pair ptr
-									temp.d_prev[0] = temp.d_prev[1] = temp.d_prev[2] = -999999999999.;
-									// get minimum image distance
-									minimum_image (atom2, atom3, &temp);
-									rjk = temp.rimg;
-									jk.set (temp.dimg[0], temp.dimg[1], temp.dimg[2]);
-
-									cos_part = 3;
-
-									a = -1.0 * ij;
-									b = -1.0 * ik;
-
-									cos_part *= (a * b) / (a.norm() * b.norm());
-
-									a = ij;
-									b = -1.0*jk;
-
-									cos_part *= (a * b) / (a.norm() * b.norm());
-
-									a = ik;
-									b = jk;
-
-									cos_part *= (a * b) / (a.norm() * b.norm());
-
-									potential += c9 * ((1.0 + cos_part) / pow(rij*rik*rjk, 3));
-								}
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-	// We're counting each pair 6 times
-	potential = potential / 6;
-	return potential;
-}
-
-
-
-
-
-
 //   Silvera-Goldman H2 potential   /////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -1770,6 +1707,65 @@ double System::sg() {
 	Molecule * molecule_ptr = nullptr;
 	Atom     * atom_ptr = nullptr;
 	Pair     * pair_ptr = nullptr;
+	double     potential = 0;
+
+
+	if (verlet_list) {
+		for (int i = 0; i < natoms; i++) {
+			for (int e = verlet_list_start[i]; e < verlet_list_start[i + 1]; e++) {
+				pair_ptr = verlet_list_pair[e];
+				if (pair_ptr->recalculate_energy)
+					sg_pair(molecule_array[i], atom_array[i], pair_ptr);
+				potential += pair_ptr->rd_energy;
+			}
+		}
+		return potential;
+	}
+
+	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
+		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
+			for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next)
+				if (pair_ptr->recalculate_energy)
+					sg_pair(molecule_ptr, atom_ptr, pair_ptr);
+
+	potential = 0;
+	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
+		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
+			for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next)
+				potential += pair_ptr->rd_energy;
+
+	return potential;
+
+}
+
+// recompute the cached Silvera-Goldman energy of a single pair
+void System::sg_pair(Molecule * molecule_ptr, Atom * atom_ptr, Pair * pair_ptr) {
+
+	double     rimg = 0,
+		fh_term = 0;
+	int        t = atom_ptr->mixing_type,
+		u = pair_ptr->atom->mixing_type;
+
+	pair_ptr->rd_energy = 0;
+	rimg = pair_ptr->rimg;
+
+	if (rimg < pbc.cutoff) {
+
+		// classical pairwise part 
+		if (!pair_table_lookup(PAIR_TABLE_ENERGY, t, u, rimg, pbc.cutoff, pair_ptr->rd_energy))
+			pair_ptr->rd_energy = sg_kernel(rimg, nullptr);
+
+		if (feynman_hibbs) {
+			if (!pair_table_lookup(PAIR_TABLE_FH, t, u, rimg, pbc.cutoff, fh_term))
+				fh_term = sg_fh_kernel(rimg, nullptr);
+			pair_ptr->rd_energy += pow(METER2ANGSTROM, 2)*(hBar*hBar / (24.0*kB*temperature*(AMU2KG*molecule_ptr->mass)))*fh_term;
+		}
+	}
+}
+
+// the classical Silvera-Goldman energy (K) at separation r (angstroms)
+double System::sg_kernel(double r, const double *) {
+
 	double     rimg = 0,
 		r6 = 0,
 		r8 = 0,
@@ -1778,87 +1774,81 @@ double System::sg() {
 		r_rm = 0,
 		repulsive_term = 0,
 		multipole_term = 0,
-		exponential_term = 0,
-		first_r_diff_term = 0,
-		second_r_diff_term = 0,
-		first_derivative = 0,
-		second_derivative = 0,
-		potential_classical = 0,
-		potential_fh_second_order = 0,
-		potential = 0;
-
-
-	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
-		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
-			for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next) {
-
-				if (pair_ptr->recalculate_energy) {
-
-					pair_ptr->rd_energy = 0;
-					rimg = pair_ptr->rimg;
-
-					if (rimg < pbc.cutoff) {
+		exponential_term = 0;
 
-						// convert units to Bohr radii 
-						rimg /= AU2ANGSTROM;
+	// convert units to Bohr radii 
+	rimg = r / AU2ANGSTROM;
 
-						// classical pairwise part 
-						repulsive_term = exp(ALPHA - BETA * rimg - GAMMA * rimg*rimg);
+	repulsive_term = exp(ALPHA - BETA * rimg - GAMMA * rimg*rimg);
 
-						r6 = pow(rimg, 6);
-						r8 = pow(rimg, 8);
-						r9 = pow(rimg, 9);
-						r10 = pow(rimg, 10);
-						multipole_term = C6 / r6 + C8 / r8 + C10 / r10 - C9 / r9;
+	r6 = pow(rimg, 6);
+	r8 = pow(rimg, 8);
+	r9 = pow(rimg, 9);
+	r10 = pow(rimg, 10);
+	multipole_term = C6 / r6 + C8 / r8 + C10 / r10 - C9 / r9;
 
 
-						r_rm = RM / rimg;
-						if (rimg < RM)
-							exponential_term = exp(-pow((r_rm - 1.0), 2));
-						else
-							exponential_term = 1.0;
+	r_rm = RM / rimg;
+	if (rimg < RM)
+		exponential_term = exp(-pow((r_rm - 1.0), 2));
+	else
+		exponential_term = 1.0;
 
-						potential_classical = (repulsive_term - multipole_term * exponential_term);
-						pair_ptr->rd_energy += potential_classical;
+	// convert units from Hartrees back to Kelvin 
+	return (repulsive_term - multipole_term * exponential_term) * HARTREE2KELVIN;
+}
 
-						if (feynman_hibbs) {
+// the derivatives in the second-order Feynman-Hibbs correction to sg_kernel(), u'' + 2u'/r (with r in
+// a.u., and u in K), to be multiplied by hbar^2/(24 kT m)
+double System::sg_fh_kernel(double r, const double *) {
 
-							// FIRST DERIVATIVE 
-							first_derivative = (-BETA - 2.0*GAMMA*rimg)*repulsive_term;
-							first_derivative += (6.0*C6 / pow(rimg, 7) + 8.0*C8 / pow(rimg, 9) - 9.0*C9 / pow(rimg, 10) + 10.0*C10 / pow(rimg, 11))*exponential_term;
-							first_r_diff_term = (r_rm*r_rm - r_rm) / rimg;
-							first_derivative += -2.0*multipole_term*exponential_term*first_r_diff_term;
+	double     rimg = 0,
+		r6 = 0,
+		r8 = 0,
+		r9 = 0,
+		r10 = 0,
+		r_rm = 0,
+		repulsive_term = 0,
+		multipole_term = 0,
+		exponential_term = 0,
+		first_r_diff_term = 0,
+		second_r_diff_term = 0,
+		first_derivative = 0,
+		second_derivative = 0;
 
-							// SECOND DERIVATIVE
-							second_derivative = (pow((BETA + 2.0*GAMMA*rimg), 2) - 2.0*GAMMA)*repulsive_term;
-							second_derivative += (-exponential_term)*(42.0*C6 / pow(rimg, 8) + 72.0*C8 / pow(rimg, 10) - 90.0*C9 / pow(rimg, 11) + 110.0*C10 / pow(rimg, 10));
-							second_derivative += exponential_term * first_r_diff_term*(12.0*C6 / pow(rimg, 7) + 16.0*C8 / pow(rimg, 9) - 18.0*C9 / pow(rimg, 10) + 20.0*C10 / pow(rimg, 11));
-							second_derivative += exponential_term * pow(first_r_diff_term, 2)*4.0*multipole_term;
-							second_r_diff_term = (3.0*r_rm*r_rm - 2.0*r_rm) / (rimg*rimg);
-							second_derivative += exponential_term * second_r_diff_term*2.0*multipole_term;
-
-							potential_fh_second_order = pow(METER2ANGSTROM, 2)*(hBar*hBar / (24.0*kB*temperature*(AMU2KG*molecule_ptr->mass)))*(second_derivative + 2.0*first_derivative / rimg);
-							pair_ptr->rd_energy += potential_fh_second_order;
-						}
+	// convert units to Bohr radii 
+	rimg = r / AU2ANGSTROM;
 
-						// convert units from Hartrees back to Kelvin 
-						pair_ptr->rd_energy *= HARTREE2KELVIN;
+	repulsive_term = exp(ALPHA - BETA * rimg - GAMMA * rimg*rimg);
 
-					}
+	r6 = pow(rimg, 6);
+	r8 = pow(rimg, 8);
+	r9 = pow(rimg, 9);
+	r10 = pow(rimg, 10);
+	multipole_term = C6 / r6 + C8 / r8 + C10 / r10 - C9 / r9;
 
-				} // recalculate
-			} // pair
-		} // atom
-	} // molecule
+	r_rm = RM / rimg;
+	if (rimg < RM)
+		exponential_term = exp(-pow((r_rm - 1.0), 2));
+	else
+		exponential_term = 1.0;
 
-	potential = 0;
-	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
-		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
-			for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next)
-				potential += pair_ptr->rd_energy;
+	// FIRST DERIVATIVE 
+	first_derivative = (-BETA - 2.0*GAMMA*rimg)*repulsive_term;
+	first_derivative += (6.0*C6 / pow(rimg, 7) + 8.0*C8 / pow(rimg, 9) - 9.0*C9 / pow(rimg, 10) + 10.0*C10 / pow(rimg, 11))*exponential_term;
+	first_r_diff_term = (r_rm*r_rm - r_rm) / rimg;
+	first_derivative += -2.0*multipole_term*exponential_term*first_r_diff_term;
 
-	return potential;
+	// SECOND DERIVATIVE
+	second_derivative = (pow((BETA + 2.0*GAMMA*rimg), 2) - 2.0*GAMMA)*repulsive_term;
+	second_derivative += (-exponential_term)*(42.0*C6 / pow(rimg, 8) + 72.0*C8 / pow(rimg, 10) - 90.0*C9 / pow(rimg, 11) + 110.0*C10 / pow(rimg, 10));
+	second_derivative += exponential_term * first_r_diff_term*(12.0*C6 / pow(rimg, 7) + 16.0*C8 / pow(rimg, 9) - 18.0*C9 / pow(rimg, 10) + 20.0*C10 / pow(rimg, 11));
+	second_derivative += exponential_term * pow(first_r_diff_term, 2)*4.0*multipole_term;
+	second_r_diff_term = (3.0*r_rm*r_rm - 2.0*r_rm) / (rimg*rimg);
+	second_derivative += exponential_term * second_r_diff_term*2.0*multipole_term;
 
+	// convert units from Hartrees back to Kelvin 
+	return (second_derivative + 2.0*first_derivative / rimg) * HARTREE2KELVIN;
 }
 
 // same as above, but no periodic boundary conditions 
@@ -1934,6 +1924,7 @@ double System::sg_nopbc(Molecule * molecules) {
 double System::disp_expansion()
 {
 	double potential = 0.0;
+	bool   lrc_pairs = rd_lrc && !lrc_by_type();  // otherwise the LRC comes from the atom counts (System.TailCorrection.cpp)
 
 	Molecule * molecule_ptr;
 	Atom     * atom_ptr;
@@ -1946,41 +1937,21 @@ double System::disp_expansion()
 				if (pair_ptr->recalculate_energy) {
 
 					// pair LRC
-					if (rd_lrc)
+					if (lrc_pairs)
 						pair_ptr->lrc = disp_expansion_lrc(pair_ptr, pbc.cutoff);
 
-					// make sure we're not excluded or beyond the cutoff
-					if (!(pair_ptr->rd_excluded || pair_ptr->frozen)) {
+					// make sure we're not excluded. the cell list culls distant pairs without imaging them,
+					// so with it, pairs beyond the cutoff are dropped as its LRC assumes
+					if (!(pair_ptr->rd_excluded || pair_ptr->frozen) && (!cell_list || (pair_ptr->rimg - SMALL_dR < pbc.cutoff))) {
 						const double r = pair_ptr->rimg;
-						const double r2 = r * r;
-						const double r4 = r2 * r2;
-						const double r6 = r4 * r2;
-						const double r8 = r6 * r2;
-						const double r10 = r8 * r2;
-
-						double c6 = pair_ptr->c6;
-						const double c8 = pair_ptr->c8;
-						const double c10 = pair_ptr->c10;
-
-						if (disp_expansion_mbvdw == 1)
-							c6 = 0.0;
 
-						double repulsion = 0.0;
-
-						// F0 = 0.001 Eh/bohr aka a.u.
-						// .001/3.166811429E-6*1.8897161646321 = 596.725194095
-
-						if (pair_ptr->epsilon != 0.0    &&    pair_ptr->sigma != 0.0)
-							repulsion = 596.725194095 * 1.0 / pair_ptr->epsilon * exp(-pair_ptr->epsilon*(r - pair_ptr->sigma)); // K = 10^-3 H ~= 316 K
-
-						if (damp_dispersion)
-							pair_ptr->rd_energy = -tt_damping(6, pair_ptr->epsilon*r)*c6 / r6 - tt_damping(8, pair_ptr->epsilon*r)*c8 / r8 - tt_damping(10, pair_ptr->epsilon*r)*c10 / r10 + repulsion;
-						else
-							pair_ptr->rd_energy = -c6 / r6 - c8 / r8 - c10 / r10 + repulsion;
+						if (!pair_table_lookup(PAIR_TABLE_ENERGY, atom_ptr->mixing_type, pair_ptr->atom->mixing_type, r, pbc.cutoff, pair_ptr->rd_energy))
+							pair_ptr->rd_energy = pair_kernel(disp_expansion_kernel, pair_ptr, r);
 
 						if (cavity_autoreject_repulsion != 0.0)
-							if (repulsion > cavity_autoreject_repulsion)
-								pair_ptr->rd_energy = MAXVALUE;
+							if (pair_ptr->epsilon != 0.0 && pair_ptr->sigma != 0.0)
+								if (596.725194095 * 1.0 / pair_ptr->epsilon * exp(-pair_ptr->epsilon*(r - pair_ptr->sigma)) > cavity_autoreject_repulsion)
+									pair_ptr->rd_energy = MAXVALUE;
 					}
 
 				}
@@ -1996,7 +1967,7 @@ double System::disp_expansion()
 	}
 
 	// calculate self LRC interaction 
-	if (rd_lrc)
+	if (lrc_pairs)
 	{
 		for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
 		{
@@ -2007,6 +1978,8 @@ double System::disp_expansion()
 			}
 		}
 	}
+	else if (rd_lrc)
+		potential += lrc_from_counts(LRC_TERMS_RD, pbc.cutoff);
 
 	return potential;
 }
@@ -2028,6 +2001,37 @@ double System::disp_expansion_lrc(Pair * pair_ptr, const double cutoff) // ignor
 
 
 
+// the dispersion expansion pair energy at separation r
+double System::disp_expansion_kernel(double r, const double * param)
+{
+	const double r2 = r * r;
+	const double r4 = r2 * r2;
+	const double r6 = r4 * r2;
+	const double r8 = r6 * r2;
+	const double r10 = r8 * r2;
+
+	const double sigma = param[PAIR_KERNEL_SIGMA];
+	const double epsilon = param[PAIR_KERNEL_EPSILON];
+	const double c6 = param[PAIR_KERNEL_C6];
+	const double c8 = param[PAIR_KERNEL_C8];
+	const double c10 = param[PAIR_KERNEL_C10];
+
+	double repulsion = 0.0;
+
+	// F0 = 0.001 Eh/bohr aka a.u.
+	// .001/3.166811429E-6*1.8897161646321 = 596.725194095
+
+	if (epsilon != 0.0    &&    sigma != 0.0)
+		repulsion = 596.725194095 * 1.0 / epsilon * exp(-epsilon*(r - sigma)); // K = 10^-3 H ~= 316 K
+
+	if (param[PAIR_KERNEL_DAMPING] != 0.0)
+		return -tt_damping(6, epsilon*r)*c6 / r6 - tt_damping(8, epsilon*r)*c8 / r8 - tt_damping(10, epsilon*r)*c10 / r10 + repulsion;
+	else
+		return -c6 / r6 - c8 / r8 - c10 / r10 + repulsion;
+}
+
+
+
 double System::tt_damping(int n, double br)
 {
 	double sum = 1.0, running_br = br;
@@ -2095,11 +2099,7 @@ double System::dreiding() {
 	Molecule * molecule_ptr = nullptr;
 	Atom     * atom_ptr = nullptr;
 	Pair     * pair_ptr = nullptr;
-	double     gamma = DREIDING_GAMMA,
-		r_over_sigma = 0,
-		termexp = 0,
-		term6 = 0,
-		potential = 0,
+	double     potential = 0,
 		potential_classical = 0;
 
 #ifdef XXX
@@ -2121,23 +2121,9 @@ double System::dreiding() {
 					// make sure we're not excluded or beyond the cutoff 
 					if (!((pair_ptr->rimg > pbc.cutoff) || pair_ptr->rd_excluded || pair_ptr->frozen)) {
 
-						r_over_sigma = pair_ptr->rimg / pair_ptr->sigma;
-
 						// the DREIDING potential
-						term6 = pow(r_over_sigma, -6);
-						term6 *= gamma / (gamma - 6.0);
-
-						if (pair_ptr->attractive_only)
-							termexp = 0;
-						else {
-							if (pair_ptr->rimg < 0.4*pair_ptr->sigma)
-								termexp = MAXVALUE;
-							else {
-								termexp = exp(gamma*(1.0 - r_over_sigma));
-								termexp *= (6.0 / (gamma - 6.0));
-							}
-						}
-						potential_classical = pair_ptr->epsilon*(termexp - term6);
+						if (!pair_table_lookup(PAIR_TABLE_ENERGY, atom_ptr->mixing_type, pair_ptr->atom->mixing_type, pair_ptr->rimg, pbc.cutoff, potential_classical))
+							potential_classical = pair_kernel(dreiding_kernel, pair_ptr, pair_ptr->rimg);
 
 						pair_ptr->rd_energy += potential_classical;
 
@@ -2205,6 +2191,31 @@ double System::dreiding() {
 }
 
 
+// the DREIDING pair energy at separation r
+double System::dreiding_kernel(double r, const double * param) {
+
+	double     gamma = DREIDING_GAMMA,
+		r_over_sigma = r / param[PAIR_KERNEL_SIGMA],
+		termexp = 0,
+		term6 = 0;
+
+	term6 = pow(r_over_sigma, -6);
+	term6 *= gamma / (gamma - 6.0);
+
+	if (param[PAIR_KERNEL_ATTRACTIVE_ONLY] != 0.0)
+		termexp = 0;
+	else {
+		if (r < 0.4*param[PAIR_KERNEL_SIGMA])
+			termexp = MAXVALUE;
+		else {
+			termexp = exp(gamma*(1.0 - r_over_sigma));
+			termexp *= (6.0 / (gamma - 6.0));
+		}
+	}
+	return param[PAIR_KERNEL_EPSILON]*(termexp - term6);
+}
+
+
 // same as above, but no periodic boundary conditions 
 double System::dreiding_nopbc(Molecule *molecules) {
 
@@ -2268,13 +2279,9 @@ double System::exp_repulsion()
 	Molecule * molecule_ptr;
 	Atom     * atom_ptr;
 	Pair     * pair_ptr;
-	double     r = 0,
-		term = 0,
-		potential = 0,
-		potential_classical = 0,
+	double     potential = 0,
 		cutoff = 0;
-	int        i[3] = { 0 };
-	double     a[3] = { 0 };
+	bool       lrc_pairs = rd_lrc && !lrc_by_type();  // otherwise the LRC comes from the atom counts (System.TailCorrection.cpp)
 
 	//set the cutoff
 	if (rd_crystal)
@@ -2283,64 +2290,53 @@ double System::exp_repulsion()
 		cutoff = pbc.cutoff;
 
 	potential = 0;
-	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
-		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
-			for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next) {
+	if (verlet_list) {
+
+		// pairs beyond the list radius contribute only their LRC, which is re-summed whenever the list is rebuilt
+		if (lrc_pairs && verlet_list_lrc_stale) {
+			verlet_list_lrc = 0;
+			for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
+				for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
+					for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next) {
+						pair_ptr->lrc = exp_lrc_corr(atom_ptr, pair_ptr, cutoff);
+						verlet_list_lrc += pair_ptr->lrc;
+					}
+			verlet_list_lrc_stale = 0;
+		}
 
-				if (pair_ptr->recalculate_energy) {
+		for (int i = 0; i < natoms; i++) {
+			for (int e = verlet_list_start[i]; e < verlet_list_start[i + 1]; e++) {
+				pair_ptr = verlet_list_pair[e];
+				if (pair_ptr->recalculate_energy)
+					exp_repulsion_pair(molecule_array[i], atom_array[i], pair_ptr, cutoff);
+				potential += pair_ptr->rd_energy;
+			}
+		}
+		if (lrc_pairs)
+			potential += verlet_list_lrc;
 
-					pair_ptr->rd_energy = 0;
+	} else {
 
-					// pair LRC 
-					if (rd_lrc) pair_ptr->lrc = exp_lrc_corr(atom_ptr, pair_ptr, cutoff);
-
-					// to include a contribution, we require
-					if ((pair_ptr->rimg - SMALL_dR < cutoff)  //inside cutoff?
-						&& (!pair_ptr->rd_excluded || rd_crystal) //either not excluded OR rd_crystal is ON
-						&& !pair_ptr->frozen) //not frozen
-					{
-
-						//loop over unit cells
-						if (rd_crystal) {
-							term = 0;
-							for (i[0] = -(rd_crystal_order); i[0] <= rd_crystal_order; i[0]++)
-								for (i[1] = -(rd_crystal_order); i[1] <= rd_crystal_order; i[1]++)
-									for (i[2] = -(rd_crystal_order); i[2] <= rd_crystal_order; i[2]++) {
-										if (!i[0] && !i[1] && !i[2] && pair_ptr->rd_excluded)
-											continue; //no i=j=k=0 for excluded pairs (intra-molecular)
-										//calculate pair separation (atom with it's image)
-										for (int p = 0; p < 3; p++) {
-											a[p] = 0;
-											for (int q = 0; q < 3; q++)
-												a[p] += pbc.basis[q][p] * i[q];
-											a[p] += atom_ptr->pos[p] - pair_ptr->atom->pos[p];
-										}
-										r = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
-
-										if (r + SMALL_dR > cutoff)	continue;
-										term += exp(-r / (2.0*pair_ptr->epsilon));
-									}
-						}
-						else //otherwise, calculate as normal
-							term = exp(-pair_ptr->rimg / (2.0*pair_ptr->epsilon));
+		for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
+			for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
+				for (pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next) {
 
-						potential_classical = pair_ptr->sigma*term;
-						pair_ptr->rd_energy += potential_classical;
+					if (pair_ptr->recalculate_energy) {
 
-						if (feynman_hibbs)
-							pair_ptr->rd_energy +=
-							exp_fh_corr(molecule_ptr, pair_ptr, feynman_hibbs_order, potential_classical);
+						// pair LRC 
+						if (lrc_pairs) pair_ptr->lrc = exp_lrc_corr(atom_ptr, pair_ptr, cutoff);
 
-					} //count contributions
+						exp_repulsion_pair(molecule_ptr, atom_ptr, pair_ptr, cutoff);
 
-				} // if recalculate
+					} // if recalculate
 
-				// sum all of the pairwise terms
-				potential += pair_ptr->rd_energy + pair_ptr->lrc;
+					// sum all of the pairwise terms
+					potential += pair_ptr->rd_energy + pair_ptr->lrc;
 
-			} // pair 
-		} // atom
-	} // molecule
+				} // pair 
+			} // atom
+		} // molecule
+	}
 
 	// molecule self-energy for rd_crystal -> energy of molecule interacting with its periodic neighbors 
 
@@ -2350,10 +2346,12 @@ double System::exp_repulsion()
 				potential += exp_crystal_self(atom_ptr, cutoff);
 
 	// calculate self LRC interaction
-	if (rd_lrc)
+	if (lrc_pairs)
 		for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next)
 			for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
 				potential += exp_lrc_self(atom_ptr, cutoff);
+	else if (rd_lrc)
+		potential += lrc_from_counts(LRC_TERMS_RD, cutoff);
 
 	return(potential);
 
@@ -2361,6 +2359,70 @@ double System::exp_repulsion()
 
 
 
+void System::exp_repulsion_pair(Molecule * molecule_ptr, Atom * atom_ptr, Pair * pair_ptr, double cutoff)
+{
+// recompute the cached exponential repulsion energy of a single pair
+
+	double     r = 0,
+		term = 0,
+		potential_classical = 0;
+	int        i[3] = { 0 };
+	double     a[3] = { 0 };
+	int        t = atom_ptr->mixing_type,
+		u = pair_ptr->atom->mixing_type;
+
+	pair_ptr->rd_energy = 0;
+
+	// to include a contribution, we require
+	if ((pair_ptr->rimg - SMALL_dR < cutoff)  //inside cutoff?
+		&& (!pair_ptr->rd_excluded || rd_crystal) //either not excluded OR rd_crystal is ON
+		&& !pair_ptr->frozen) //not frozen
+	{
+
+		//loop over unit cells
+		if (rd_crystal) {
+			for (i[0] = -(rd_crystal_order); i[0] <= rd_crystal_order; i[0]++)
+				for (i[1] = -(rd_crystal_order); i[1] <= rd_crystal_order; i[1]++)
+					for (i[2] = -(rd_crystal_order); i[2] <= rd_crystal_order; i[2]++) {
+						if (!i[0] && !i[1] && !i[2] && pair_ptr->rd_excluded)
+							continue; //no i=j=k=0 for excluded pairs (intra-molecular)
+						//calculate pair separation (atom with it's image)
+						for (int p = 0; p < 3; p++) {
+							a[p] = 0;
+							for (int q = 0; q < 3; q++)
+								a[p] += pbc.basis[q][p] * i[q];
+							a[p] += atom_ptr->pos[p] - pair_ptr->atom->pos[p];
+						}
+						r = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+
+						if (r + SMALL_dR > cutoff)	continue;
+						if (!pair_table_lookup(PAIR_TABLE_ENERGY, t, u, r, cutoff, term))
+							term = pair_ptr->sigma*exp(-r / (2.0*pair_ptr->epsilon));
+						potential_classical += term;
+					}
+		}
+		else if (!pair_table_lookup(PAIR_TABLE_ENERGY, t, u, pair_ptr->rimg, cutoff, potential_classical)) //otherwise, calculate as normal
+			potential_classical = pair_ptr->sigma*exp(-pair_ptr->rimg / (2.0*pair_ptr->epsilon));
+
+		pair_ptr->rd_energy += potential_classical;
+
+		if (feynman_hibbs)
+			pair_ptr->rd_energy +=
+			exp_fh_corr(molecule_ptr, pair_ptr, feynman_hibbs_order, potential_classical);
+
+	} //count contributions
+}
+
+
+
+// the exponential repulsion pair energy at separation r
+double System::exp_repulsion_kernel(double r, const double * param)
+{
+	return param[PAIR_KERNEL_SIGMA]*exp(-r / (2.0*param[PAIR_KERNEL_EPSILON]));
+}
+
+
+
 double System::exp_lrc_corr(Atom * atom_ptr, Pair * pair_ptr, double cutoff)
 {
 
@@ -2719,7 +2781,7 @@ void System::thole_amatrix() {
 				}
 				break;
 			case DAMPING_EXPONENTIAL:
-				explr = exp(-l * r);
+				explr = exp_neg_lookup(l * r);
 				damp1 = 1.0 - explr * (0.5*l2*r2 + l * r + 1.0);
 				damp2 = damp1 - explr * (l3*r2*r / 6.0);
 				if (polar_wolf_full) { //subtract off damped interaction at r_cutoff
@@ -2825,53 +2887,42 @@ void System::recip_term() {
 
 	Molecule * mptr = nullptr;
 	Atom     * aptr = nullptr;
-	int        l[3] = { 0 },
-		kmax = ewald_kmax;
-	double     ea = polar_ewald_alpha, //actually sqrt(ea)
-		k[3] = { 0 },
-		k2 = 0,
+	int        n = 0;
+	double   * k = nullptr,
 		kweight[3] = { 0 },
 		float1 = 0,
 		float2 = 0;
 
+	if (ewald_spme) {
+		spme_recip_field();
+		return;
+	}
 
 	//k-space sum (symmetry for k -> -k, so we sum over hemisphere, avoiding double-counting on the face)
-	for (l[0] = 0; l[0] <= kmax; l[0]++) {
-		for (l[1] = (!l[0] ? 0 : -kmax); l[1] <= kmax; l[1]++) {
-			for (l[2] = ((!l[0] && !l[1]) ? 1 : -kmax); l[2] <= kmax; l[2]++) {
-
-				// if |l|^2 > kmax^2, then it doesn't contribute (outside the k-space cutoff)
-				if (UsefulMath::iidotprod(l, l) > kmax*kmax) continue;
-
-				for (int p = 0; p < 3; p++) {
-					k[p] = 0;
-					for (int q = 0; q < 3; q++)
-						k[p] += 2.0 * pi * pbc.reciprocal_basis[p][q] * l[q];
-				}
-				k2 = UsefulMath::dddotprod(k, k);
+	ewald_kvectors_update();
+	n = ewald_phases_begin(false);
+	for (int kk = 0; kk < ewald_nk; kk++) {
 
-				kweight[0] = k[0] / k2 * exp(-k2 / (4.0*ea*ea));
-				kweight[1] = k[1] / k2 * exp(-k2 / (4.0*ea*ea));
-				kweight[2] = k[2] / k2 * exp(-k2 / (4.0*ea*ea));
+		k = ewald_kvec + 3 * kk;
+		kweight[0] = k[0] * ewald_kvec_polar_weight[kk];
+		kweight[1] = k[1] * ewald_kvec_polar_weight[kk];
+		kweight[2] = k[2] * ewald_kvec_polar_weight[kk];
 
-				float1 = float2 = 0;
-				for (mptr = molecules; mptr; mptr = mptr->next)
-					for (aptr = mptr->atoms; aptr; aptr = aptr->next) {
-						float1 += aptr->charge * cos(UsefulMath::dddotprod(k, aptr->pos));
-						float2 += aptr->charge * sin(UsefulMath::dddotprod(k, aptr->pos));
-					}
+		ewald_phases_at(kk);
 
-				for (mptr = molecules; mptr; mptr = mptr->next)
-					for (aptr = mptr->atoms; aptr; aptr = aptr->next) {
-						for (int p = 0; p < 3; p++) {
-							aptr->ef_static[p] += kweight[p] * sin(UsefulMath::dddotprod(k, aptr->pos)) * float1;
-							aptr->ef_static[p] -= kweight[p] * cos(UsefulMath::dddotprod(k, aptr->pos)) * float2;
-						}
-					}
+		float1 = float2 = 0;
+		for (int j = 0; j < n; j++) {
+			float1 += ewald_phase_atom[j]->charge * ewald_phase_re[j];
+			float2 += ewald_phase_atom[j]->charge * ewald_phase_im[j];
+		}
 
-			} //l2
-		} //l1
-	} //l0
+		for (int j = 0; j < n; j++) {
+			for (int p = 0; p < 3; p++) {
+				ewald_phase_atom[j]->ef_static[p] += kweight[p] * ewald_phase_im[j] * float1;
+				ewald_phase_atom[j]->ef_static[p] -= kweight[p] * ewald_phase_re[j] * float2;
+			}
+		}
+	} //k
 
 	for (mptr = molecules; mptr; mptr = mptr->next) {
 		for (aptr = mptr->atoms; aptr; aptr = aptr->next) {
@@ -2908,7 +2959,7 @@ void System::real_term() {
 				r2 = r * r;
 				if (pptr->es_excluded) {
 					//need to subtract self-term (interaction between a site and a neighbor's screening charge (on the same molecule)
-					factor = (2.0 * a * OneOverSqrtPi * exp(-a * a*r2) * r - erf(a*r)) / (r*r2);
+					factor = (2.0 * a * OneOverSqrtPi * exp_neg_lookup(a * a*r2) * r - erf_lookup(a*r)) / (r*r2);
 					for (int p = 0; p < 3; p++) {
 						aptr->ef_static[p] += factor * pptr->atom->charge * pptr->dimg[p];
 						pptr->atom->ef_static[p] -= factor * aptr->charge * pptr->dimg[p];
@@ -2916,7 +2967,7 @@ void System::real_term() {
 				} //excluded
 				else { //not excluded
 
-					factor = (2.0 * a * OneOverSqrtPi * exp(-a * a*r2) * r + erfc(a*r)) / (r2*r);
+					factor = (2.0 * a * OneOverSqrtPi * exp_neg_lookup(a * a*r2) * r + erfc_lookup(a*r)) / (r2*r);
 					for (int p = 0; p < 3; p++) { // for each dim, add e-field contribution for the pair
 						aptr->ef_static[p] += factor * pptr->atom->charge * pptr->dimg[p];
 						pptr->atom->ef_static[p] -= factor * aptr->charge * pptr->dimg[p];
@@ -2963,70 +3014,48 @@ void System::clear_ef_induced() {
 
 
 void System::induced_recip_term() {
-	Molecule * mptr = nullptr;
-	Atom     * aptr = nullptr,
-		** aarray = nullptr;
-	int        NAtoms = 0,
-		l[3] = { 0 },
-		kmax = ewald_kmax;
+
+	Atom    ** aarray = nullptr;
+	int        NAtoms = 0;
 	double     Psin = 0,
 		Pcos = 0,
-		kweight = 0,
-		a = polar_ewald_alpha,
+		kweight[3] = { 0 },
 		dotprod1 = 0,
-		dotprod2 = 0,
-		k[3] = { 0 },
-		k2 = 0;
+		* k = nullptr;
 
-	//make atom array
-	for (mptr = molecules; mptr; mptr = mptr->next) {
-		for (aptr = mptr->atoms; aptr; aptr = aptr->next) {
-			SafeOps::realloc(aarray, sizeof(Atom *) * (NAtoms + 1), __LINE__, __FILE__);
-			aarray[NAtoms] = aptr;
-			NAtoms++;
-		}
+	if (ewald_spme) {
+		spme_induced_field();
+		return;
 	}
 
 	//k-space sum (symmetry for k -> -k, so we sum over hemisphere, avoiding double-counting on the face)
-	for (l[0] = 0; l[0] <= kmax; l[0]++)
-		for (l[1] = (!l[0] ? 0 : -kmax); l[1] <= kmax; l[1]++)
-			for (l[2] = ((!l[0] && !l[1]) ? 1 : -kmax); l[2] <= kmax; l[2]++) {
+	ewald_kvectors_update();
+	NAtoms = ewald_phases_begin(false);
+	aarray = ewald_phase_atom;
 
-				// if |l|^2 > kmax^2, then it doesn't contribute (outside the k-space cutoff)
-				if (UsefulMath::iidotprod(l, l) > kmax*kmax) continue;
+	for (int kk = 0; kk < ewald_nk; kk++) {
 
-				for (int p = 0; p < 3; p++) {
-					k[p] = 0;
-					for (int q = 0; q < 3; q++)
-						k[p] += 2.0 * pi * pbc.reciprocal_basis[p][q] * l[q];
-				}
-				k2 = UsefulMath::dddotprod(k, k);
-
-				for (int p = 0; p < 3; p++)
-					kweight = 8.0 * pi / pbc.volume * exp(-k2 / (4.0*a*a)) / k2 * k[p];
-
-				//calculate Pcos, Psin for this k-point
-				Pcos = Psin = 0;
-				for (int j = 0; j < NAtoms; j++) {
-					dotprod1 = UsefulMath::dddotprod(k, aarray[j]->mu);
-					dotprod2 = UsefulMath::dddotprod(k, aarray[j]->pos);
-					Pcos += dotprod1 * cos(dotprod2);
-					Psin += dotprod1 * sin(dotprod2);
-				}
-
-				//calculate ef_induced over atom array
-				for (int i = 0; i < NAtoms; i++) {
-					//for each cartesian dimension
-					for (int p = 0; p < 3; p++) {
+		k = ewald_kvec + 3 * kk;
+		for (int p = 0; p < 3; p++)
+			kweight[p] = 8.0 * pi / pbc.volume * ewald_kvec_polar_weight[kk] * k[p];
 
-						dotprod1 = UsefulMath::dddotprod(k, aarray[i]->pos);
-						aarray[i]->ef_induced[p] += kweight * (-sin(dotprod1)*Psin - cos(dotprod1)*Pcos);
+		ewald_phases_at(kk);
 
-					} //dim
-				} //ef_incuded over atom array
-			} //kspace	
+		//calculate Pcos, Psin for this k-point
+		Pcos = Psin = 0;
+		for (int j = 0; j < NAtoms; j++) {
+			dotprod1 = UsefulMath::dddotprod(k, aarray[j]->mu);
+			Pcos += dotprod1 * ewald_phase_re[j];
+			Psin += dotprod1 * ewald_phase_im[j];
+		}
 
-	free(aarray);
+		//calculate ef_induced over atom array
+		for (int i = 0; i < NAtoms; i++) {
+			//for each cartesian dimension
+			for (int p = 0; p < 3; p++)
+				aarray[i]->ef_induced[p] += kweight[p] * (-ewald_phase_im[i] * Psin - ewald_phase_re[i] * Pcos);
+		} //ef_incuded over atom array
+	} //kspace	
 
 	return;
 }
@@ -3059,8 +3088,8 @@ void System::induced_real_term() {
 				//some things we'll need
 				r = pptr->rimg;
 				ir = 1.0 / r; ir3 = ir * ir*ir; ir5 = ir * ir*ir3;
-				erfcar = erfc(a*r);
-				expa2r2 = exp(-a * a*r*r);
+				erfcar = erfc_lookup(a*r);
+				expa2r2 = exp_neg_lookup(a * a*r*r);
 
 				//E_static_realspace_i = sum(i!=j) d_xi d_xj erfc(a*r)/r u_j 
 				s2 = erfcar + 2.0*a*r*OneOverSqrtPi * expa2r2 + 4.0*a*a*a*r*r*r / 3.0*OneOverSqrtPi*expa2r2 - damp_factor(l*r, 3);
@@ -3102,7 +3131,7 @@ double System::damp_factor(double t, int i) {
 	if (i == 3)
 		temp += t * t*t / 6.0;
 
-	return temp * exp(-t);
+	return temp * exp_neg_lookup(t);
 }
 
 
@@ -3263,6 +3292,12 @@ void System::thole_field() {
 	Molecule * molecule_ptr = nullptr;
 	Atom     * atom_ptr = nullptr;
 
+	// the specialized energy pipeline has already summed the field, along with the pair energies
+	if (ef_static_fused) {
+		ef_static_fused = 0;
+		return;
+	}
+
 	// zero the field vectors 
 	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
 		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
@@ -3341,8 +3376,8 @@ void System::thole_field_wolf() {
 		bigmess = 0;
 
 	//init lookup table if needed
-	if (polar_wolf_alpha_lookup && !(polar_wolf_alpha_table))
-		polar_wolf_alpha_table = polar_wolf_alpha_lookup_init();
+	if (polar_wolf_alpha_lookup && !polar_wolf_alpha_table.built())
+		polar_wolf_alpha_lookup_init();
 
 	for (molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
 		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
@@ -3362,7 +3397,7 @@ void System::thole_field_wolf() {
 					if ((a != 0) & polar_wolf_alpha_lookup)
 						bigmess = polar_wolf_alpha_getval(r);
 					else if (a != 0) //no lookup  
-						bigmess = (erfc(a*r)*rr*rr + 2.0*a*OneOverSqrtPi*exp(-a * a*r*r)*rr);
+						bigmess = (erfc_lookup(a*r)*rr*rr + 2.0*a*OneOverSqrtPi*exp_neg_lookup(a * a*r*r)*rr);
 
 					for (int p = 0; p < 3; p++) {
 						//see JCP 124 (234104)
@@ -3399,41 +3434,6 @@ void System::ewald_estatic() {
 
 
 
-// the point of this is to store all the polar_wolf_alpha calculations in a big array, and then just look shit up
-// that way we don't need to calculate erfc's and exp's over and over and over
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-double * System::polar_wolf_alpha_lookup_init () {
-	double * rval = nullptr;
-	int      i = 0;
-	double   a = polar_wolf_alpha,
-		r = 0,
-		rr = 0;
-
-	polar_wolf_alpha_table_max = (int)(ceil(polar_wolf_alpha_lookup_cutoff)) * 1000;
-	SafeOps::malloc(rval, sizeof(double) * polar_wolf_alpha_table_max, __LINE__, __FILE__);
-
-	for (i = 1; i < polar_wolf_alpha_table_max; i++) {
-		r = (double)i / 1000.;
-		rr = 1.0 / r;
-		rval[i] = erfc(a*r)*rr*rr + 2.0*a*OneOverSqrtPi*exp(-a * a*r*r)*rr;
-	}
-	//store the zeroth component without blowing up
-	rval[0] = rval[1];
-
-
-	return rval;
-}
-
-double System::polar_wolf_alpha_getval(double r) {
-
-	int i = (int)(r * 1000);
-
-	if (i >= polar_wolf_alpha_table_max)
-		return 0.0; //answer will be zero if cutoff is large enough
-
-	return polar_wolf_alpha_table[i];
-}
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
 // iterative solver of the dipole field tensor returns the number of iterations required 
@@ -0,0 +1,456 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Output.h"
+#include "Pair.h"
+#include "System.h"
+
+
+
+// Force-field configurations resolved at compile time.
+//
+// energy() picks its repulsion/dispersion and electrostatic models from the input flags on every
+// call, and the per-pair kernels then test most of the remaining flags (rd_crystal, spectre,
+// polarvdw, cdvdw_sig_repulsion, feynman_hibbs, rd_lrc) for every pair. Once the input has been
+// validated, energy_pipeline_select() matches the configuration against the combinations that are
+// instantiated below, and points energy_pipeline at the one that fits. The flags are then template
+// parameters, which the compiler folds away, leaving each kernel free to be inlined (and vectorized)
+// as a whole. Configurations that aren't covered leave energy_pipeline null, and energy() takes the
+// generic path.
+//
+//   RD   repulsion/dispersion model: PIPELINE_RD_LJ, _LJ_POLARVDW (repulsion only), _LJ_SIGREP
+//        (cdvdw_sig_repulsion, which implies polarvdw) or _EXP_REPULSION (cdvdw_exp_repulsion)
+//   ES   electrostatics: PIPELINE_ES_NONE (rd_only), _EWALD or _WOLF
+//   FH   Feynman-Hibbs order: 0 (off), 2 or 4
+//   LRC  rd_lrc
+//
+// The repulsion/dispersion, the real-space electrostatics and (with polarization) the static field
+// that thole_field() would compute are all gathered in a single pass over the pairs, which loads each
+// pair's separation once rather than three times. The dipoles and polarvdw are still solved after
+// the pairwise terms, as before; thole_field() skips its own pass when it finds the field in place.
+
+static const char * rd_model_names[] = { "LJ", "LJ (repulsion only)", "LJ (C6*sig^6 repulsion)", "exponential repulsion" };
+static const char * es_model_names[] = { "no electrostatics", "Ewald", "Wolf" };
+
+
+
+
+// Cutoff-dependent constants of the per-pair kernels, evaluated once per pass.
+struct PairPassConstants {
+	double cutoff,
+	       wolf_iR,              // coulombic_wolf()
+	       wolf_erfaR_over_R,
+	       field_rR,             // thole_field_wolf()
+	       field_cutoffterm;
+	int    field;                // energy_pipeline_field
+};
+
+
+
+
+template< int RD, int ES, int FH, bool LRC >
+void System::energy_pipeline_run( double &rd_energy, double &coulombic_energy ) {
+// The pairwise terms of energy(), for one configuration.
+
+	double real = 0;
+
+	pair_pass<RD, ES, FH, LRC>( rd_energy, real );
+	coulombic_energy = 0;
+
+	if( ES == PIPELINE_ES_WOLF )
+		coulombic_energy = real;
+
+	else if( ES == PIPELINE_ES_EWALD ) {
+		double reciprocal = coulombic_reciprocal(),
+		       self       = coulombic_self();
+
+		// delta_energy() updates the real-space part incrementally, so it needs this part on its own
+		observables->kspace_energy = reciprocal + self;
+		coulombic_energy = real + reciprocal + self;
+	}
+}
+
+
+
+
+template< int RD, int ES, int FH, bool LRC >
+void System::pair_pass( double &rd_energy, double &es_real_energy ) {
+// lj() or exp_repulsion() (without rd_crystal or spectre), the real-space part of coulombic() or
+// coulombic_wolf(), and with polarization the pairwise part of thole_field(), in a single visit to
+// each pair. The sums are taken in the same order as the separate passes would take them.
+
+	Molecule          * molecule_ptr;
+	Atom              * atom_ptr;
+	Pair              * pair_ptr;
+	PairPassConstants   k;
+	double              rd = 0,
+	                    es = 0;
+
+	// without Feynman-Hibbs, LJ pairs are evaluated in vectorized blocks (System.LJBlock.cpp)
+	const bool batched = (RD != PIPELINE_RD_EXP_REPULSION) && (FH == 0);
+
+	k.cutoff            = pbc.cutoff;
+	k.wolf_iR           = 1.0 / k.cutoff;
+	k.wolf_erfaR_over_R = (ES == PIPELINE_ES_WOLF) ? erf(ewald_alpha*k.cutoff) / k.cutoff : 0;
+	k.field             = energy_pipeline_field;
+	if( k.field != PIPELINE_FIELD_NONE )
+		ef_static_pass_begin( k );
+
+	if( verlet_list ) {
+
+		// intra-molecular pairs are always listed, so the self-interaction terms are all visited
+		for( int i = 0; i < natoms; i++ ) {
+			for( int e = verlet_list_start[i]; e < verlet_list_start[i + 1]; e++ ) {
+				pair_ptr = verlet_list_pair[e];
+
+				es += es_field_pair<ES, FH>( molecule_array[i], atom_array[i], pair_ptr, k );
+
+				if( pair_ptr->recalculate_energy ) {
+					if( batched ) {
+						rd += lj_block_queue( pair_ptr, k.cutoff );
+						continue;
+					}
+					rd_pair<RD, FH>( molecule_array[i], atom_array[i], pair_ptr, k.cutoff );
+				}
+				rd += pair_ptr->rd_energy;
+			}
+		}
+
+	} else {
+
+		for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+			for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+				for( pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next ) {
+
+					es += es_field_pair<ES, FH>( molecule_ptr, atom_ptr, pair_ptr, k );
+
+					if( pair_ptr->recalculate_energy ) {
+						if( batched ) {
+							rd += lj_block_queue( pair_ptr, k.cutoff );
+							continue;
+						}
+						rd_pair<RD, FH>( molecule_ptr, atom_ptr, pair_ptr, k.cutoff );
+					}
+
+					rd += pair_ptr->rd_energy;
+				}
+			}
+		}
+	}
+	if( batched )
+		rd += lj_block_flush();
+
+	// the pair and self LRC, from the atom counts (there is no spectre here, see lrc_by_type())
+	if( LRC )
+		rd += lrc_from_counts( LRC_TERMS_RD, k.cutoff );
+
+	// thole_field() will find the static field already in place
+	if( k.field != PIPELINE_FIELD_NONE )
+		ef_static_fused = 1;
+
+	rd_energy      = rd;
+	es_real_energy = es;
+}
+
+
+
+
+template< int ES, int FH >
+inline double System::es_field_pair( Molecule *molecule_ptr, Atom *atom_ptr, Pair *pair_ptr, const PairPassConstants &k ) {
+// The pair's real-space electrostatic energy, (re)calculated if need be, and its contribution to
+// the static field.
+
+	double potential = 0,
+	       r, ir;
+
+	if( ES == PIPELINE_ES_EWALD ) {
+		if( pair_ptr->recalculate_energy )
+			coulombic_real_pair_fh<FH>( molecule_ptr, atom_ptr, pair_ptr );
+		potential = pair_ptr->es_real_energy - pair_ptr->es_self_intra_energy;
+	}
+	else if( ES == PIPELINE_ES_WOLF ) {
+		// coulombic_wolf()
+		if( pair_ptr->recalculate_energy ) {
+			pair_ptr->es_real_energy = 0;
+			r  = pair_ptr->rimg;
+			ir = 1.0 / r;
+			if( (!pair_ptr->frozen) && (!pair_ptr->es_excluded) && (r < k.cutoff) )
+				pair_ptr->es_real_energy = atom_ptr->charge * pair_ptr->atom->charge * (ir - k.wolf_erfaR_over_R - k.wolf_iR * k.wolf_iR*(k.cutoff - r));
+		}
+		potential = pair_ptr->es_real_energy;
+	}
+
+	if( k.field != PIPELINE_FIELD_NONE )
+		ef_static_pair( molecule_ptr, atom_ptr, pair_ptr, k );
+
+	return potential;
+}
+
+
+
+
+template< int RD, int FH >
+inline void System::rd_pair( Molecule *molecule_ptr, Atom *atom_ptr, Pair *pair_ptr, double cutoff ) {
+// lj_pair() or exp_repulsion_pair()
+
+	double sigma_over_r, sigma_over_r6, sigma_over_r12, term6, term12, potential_classical;
+
+	pair_ptr->rd_energy = 0;
+
+	// to include a contribution, we require that the pair is inside the cutoff, not excluded and not frozen
+	if( !(pair_ptr->rimg - SMALL_dR < cutoff)  ||  pair_ptr->rd_excluded  ||  pair_ptr->frozen )
+		return;
+
+	if( RD == PIPELINE_RD_EXP_REPULSION ) {
+		if( !pair_table_lookup(PAIR_TABLE_ENERGY, atom_ptr->mixing_type, pair_ptr->atom->mixing_type, pair_ptr->rimg, cutoff, potential_classical) )
+			potential_classical = pair_ptr->sigma * exp( -pair_ptr->rimg / (2.0*pair_ptr->epsilon) );
+		pair_ptr->rd_energy = potential_classical;
+		if( FH )
+			pair_ptr->rd_energy += exp_fh_corr( molecule_ptr, pair_ptr, FH, potential_classical );
+		return;
+	}
+
+	sigma_over_r    = fabs(pair_ptr->sigma) / pair_ptr->rimg;
+	sigma_over_r6   = sigma_over_r * sigma_over_r * sigma_over_r;
+	sigma_over_r6  *= sigma_over_r6;
+	sigma_over_r12  = sigma_over_r6 * sigma_over_r6;
+
+	term6  = (RD == PIPELINE_RD_LJ)     ? sigma_over_r6 : 0.0;  // with polarvdw, the dispersion is calc'd by vdw()
+	term12 = pair_ptr->attractive_only  ? 0.0           : sigma_over_r12;
+
+	if( RD == PIPELINE_RD_LJ_SIGREP )
+		potential_classical = pair_ptr->sigrep*term12;  //C6*sig^6/r^12
+	else
+		potential_classical = 4.0*pair_ptr->epsilon*(term12 - term6);
+
+	pair_ptr->rd_energy = potential_classical;
+	if( FH )
+		pair_ptr->rd_energy += lj_fh_corr( molecule_ptr, pair_ptr, FH, term12, term6 );
+}
+
+
+
+
+
+template< int FH >
+inline void System::coulombic_real_pair_fh( Molecule *molecule_ptr, Atom *atom_ptr, Pair *pair_ptr ) {
+// coulombic_real_pair()
+
+	double alpha = ewald_alpha,
+	       r     = pair_ptr->rimg,
+	       erfc_term;
+
+	pair_ptr->es_real_energy = 0;
+
+	if( pair_ptr->frozen )
+		return;
+
+	if( !((r > pbc.cutoff) || pair_ptr->es_excluded) ) { // unit cell part
+		erfc_term = erfc_lookup(alpha*r);
+		pair_ptr->es_real_energy = atom_ptr->charge * pair_ptr->atom->charge * erfc_term / r;
+		if( FH )
+			pair_ptr->es_real_energy += coulombic_real_FH( molecule_ptr, pair_ptr, exp_neg_lookup(alpha * alpha*r*r), erfc_term );
+	}
+	else if( pair_ptr->es_excluded ) // calculate the charge-to-screen interaction (unless coulombic_self() has it)
+		pair_ptr->es_self_intra_energy = es_intra_by_type() ? 0.0 : atom_ptr->charge * pair_ptr->atom->charge * erf_lookup(alpha*pair_ptr->r) / pair_ptr->r;
+}
+
+
+
+
+void System::ef_static_pass_begin( PairPassConstants &k ) {
+// thole_field(), up to the pairwise part: zero the field and add in anything that isn't pairwise.
+
+	Molecule * molecule_ptr;
+	Atom     * atom_ptr;
+	double     a = polar_wolf_alpha,
+	           R = k.cutoff;
+
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			for( int p = 0; p < 3; p++ ) {
+				atom_ptr->ef_static[p]      = 0;
+				atom_ptr->ef_static_self[p] = 0;
+			}
+
+	// recip_term() rescales the whole field when it is done, so it must come before the real-space part
+	if( k.field == PIPELINE_FIELD_EWALD )
+		recip_term();
+
+	k.field_rR         = 1. / R;
+	k.field_cutoffterm = 0;
+	if( k.field == PIPELINE_FIELD_WOLF ) {
+		k.field_cutoffterm = erfc(a*R)*k.field_rR*k.field_rR + 2.0*a*OneOverSqrtPi*exp(-a * a*R*R)*k.field_rR;
+		if( polar_wolf_alpha_lookup  &&  !polar_wolf_alpha_table.built() )
+			polar_wolf_alpha_lookup_init();
+	}
+}
+
+
+
+
+inline void System::ef_static_pair( Molecule *molecule_ptr, Atom *atom_ptr, Pair *pair_ptr, const PairPassConstants &k ) {
+// One pair's share of real_term(), thole_field_wolf() or thole_field_nopbc().
+
+	double r = pair_ptr->rimg,
+	       rr, r2, factor,
+	       a, rR, bigmess = 0;
+
+	if( pair_ptr->frozen )
+		return;  // frozen pairs (i.e. MOF-MOF interactions) don't contribute to polar
+
+	if( k.field == PIPELINE_FIELD_EWALD ) {
+		if( (r > k.cutoff) || (r == 0.0) )
+			return;
+		a  = polar_ewald_alpha;
+		r2 = r * r;
+		if( pair_ptr->es_excluded )
+			// subtract the interaction between a site and a neighbor's screening charge (on the same molecule)
+			factor = (2.0 * a * OneOverSqrtPi * exp_neg_lookup(a * a*r2) * r - erf_lookup(a*r)) / (r*r2);
+		else
+			factor = (2.0 * a * OneOverSqrtPi * exp_neg_lookup(a * a*r2) * r + erfc_lookup(a*r)) / (r2*r);
+		for( int p = 0; p < 3; p++ ) {
+			atom_ptr->ef_static[p]       += factor * pair_ptr->atom->charge * pair_ptr->dimg[p];
+			pair_ptr->atom->ef_static[p] -= factor * atom_ptr->charge * pair_ptr->dimg[p];
+		}
+		return;
+	}
+
+	// don't let molecules polarize themselves, and stay inclusive near the cutoff
+	if( molecule_ptr == pair_ptr->molecule )
+		return;
+	if( !((r - SMALL_dR < k.cutoff) && (r != 0.)) )
+		return;
+
+	if( k.field == PIPELINE_FIELD_NOPBC ) {
+		for( int p = 0; p < 3; p++ ) {
+			atom_ptr->ef_static[p]       += pair_ptr->atom->charge*pair_ptr->dimg[p] / (r*r*r);
+			pair_ptr->atom->ef_static[p] -= atom_ptr->charge*pair_ptr->dimg[p] / (r*r*r);
+		}
+		return;
+	}
+
+	// see JCP 124 (234104)
+	a  = polar_wolf_alpha;
+	rr = 1. / r;
+	rR = k.field_rR;
+	if( (a != 0) && polar_wolf_alpha_lookup )
+		bigmess = polar_wolf_alpha_getval(r);
+	else if( a != 0 )
+		bigmess = (erfc_lookup(a*r)*rr*rr + 2.0*a*OneOverSqrtPi*exp_neg_lookup(a * a*r*r)*rr);
+
+	for( int p = 0; p < 3; p++ ) {
+		if( a == 0 ) {
+			atom_ptr->ef_static[p]       += (pair_ptr->atom->charge)*(rr*rr - rR * rR)*pair_ptr->dimg[p] * rr;
+			pair_ptr->atom->ef_static[p] -= (atom_ptr->charge)*(rr*rr - rR * rR)*pair_ptr->dimg[p] * rr;
+		} else {
+			atom_ptr->ef_static[p]       += pair_ptr->atom->charge*(bigmess - k.field_cutoffterm)*pair_ptr->dimg[p] * rr;
+			pair_ptr->atom->ef_static[p] -= atom_ptr->charge*(bigmess - k.field_cutoffterm)*pair_ptr->dimg[p] * rr;
+		}
+	}
+}
+
+
+
+
+// Map the run-time configuration onto an instantiation, one template parameter at a time.
+
+template< int RD, int ES, int FH >
+static System::energy_pipeline_fn pipeline_for_lrc( bool lrc ) {
+	if( lrc )
+		return &System::energy_pipeline_run< RD, ES, FH, true >;
+	return &System::energy_pipeline_run< RD, ES, FH, false >;
+}
+
+template< int RD, int ES >
+static System::energy_pipeline_fn pipeline_for_fh( int fh, bool lrc ) {
+	switch( fh ) {
+		case 0:  return pipeline_for_lrc< RD, ES, 0 >( lrc );
+		case 2:  return pipeline_for_lrc< RD, ES, 2 >( lrc );
+		case 4:  return pipeline_for_lrc< RD, ES, 4 >( lrc );
+		default: return nullptr;
+	}
+}
+
+template< int RD >
+static System::energy_pipeline_fn pipeline_for_es( int es, int fh, bool lrc ) {
+	switch( es ) {
+		case PIPELINE_ES_NONE:  return pipeline_for_fh< RD, PIPELINE_ES_NONE  >( fh, lrc );
+		case PIPELINE_ES_EWALD: return pipeline_for_fh< RD, PIPELINE_ES_EWALD >( fh, lrc );
+		case PIPELINE_ES_WOLF:  return pipeline_for_fh< RD, PIPELINE_ES_WOLF  >( fh, lrc );
+		default:                return nullptr;
+	}
+}
+
+static System::energy_pipeline_fn pipeline_for( int rd, int es, int fh, bool lrc ) {
+	switch( rd ) {
+		case PIPELINE_RD_LJ:            return pipeline_for_es< PIPELINE_RD_LJ            >( es, fh, lrc );
+		case PIPELINE_RD_LJ_POLARVDW:   return pipeline_for_es< PIPELINE_RD_LJ_POLARVDW   >( es, fh, lrc );
+		case PIPELINE_RD_LJ_SIGREP:     return pipeline_for_es< PIPELINE_RD_LJ_SIGREP     >( es, fh, lrc );
+		case PIPELINE_RD_EXP_REPULSION: return pipeline_for_es< PIPELINE_RD_EXP_REPULSION >( es, fh, lrc );
+		default:                        return nullptr;
+	}
+}
+
+
+
+
+void System::energy_pipeline_select() {
+// Resolve the force-field configuration to a specialized energy pipeline, if there is one for it.
+// Must be called again if any of the flags it depends on change.
+
+	char linebuf[maxLine];
+	int  rd, es, fh;
+
+	energy_pipeline       = nullptr;
+	energy_pipeline_field = PIPELINE_FIELD_NONE;
+	ef_static_fused       = 0;
+
+	// these all take the generic path
+	if( rd_anharmonic || use_sg || use_dreiding || using_lj_buffered_14_7 || using_disp_expansion || gwp )
+		return;
+	if( rd_crystal || spectre || feynman_kleinert )
+		return;
+
+	if( cdvdw_exp_repulsion )
+		rd = PIPELINE_RD_EXP_REPULSION;
+	else if( cdvdw_sig_repulsion )
+		rd = PIPELINE_RD_LJ_SIGREP;
+	else if( polarvdw )
+		rd = PIPELINE_RD_LJ_POLARVDW;
+	else
+		rd = PIPELINE_RD_LJ;
+
+	if( use_sg || rd_only )
+		es = PIPELINE_ES_NONE;
+	else if( wolf )
+		es = PIPELINE_ES_WOLF;
+	else
+		es = PIPELINE_ES_EWALD;
+
+	fh = feynman_hibbs ? feynman_hibbs_order : 0;
+	if( fh  &&  es == PIPELINE_ES_WOLF )  // coulombic_wolf() rejects FH, so leave that to the generic path
+		return;
+
+	energy_pipeline = pipeline_for( rd, es, fh, rd_lrc != 0 );
+	if( ! energy_pipeline )
+		return;
+
+	// fold the pairwise part of thole_field() into the pass, unless polar() doesn't call it (ewald_full(), CUDA)
+	if( polarization  &&  es != PIPELINE_ES_NONE  &&  !polar_ewald_full  &&  !cuda ) {
+		if( polar_ewald )
+			energy_pipeline_field = PIPELINE_FIELD_EWALD;
+		else if( polar_wolf || polar_wolf_full )
+			energy_pipeline_field = PIPELINE_FIELD_WOLF;
+		else
+			energy_pipeline_field = PIPELINE_FIELD_NOPBC;
+	}
+
+	if( fh )
+		sprintf( linebuf, "SYSTEM: energy pipeline specialized for %s + %s + FH%d%s%s\n", rd_model_names[rd], es_model_names[es], fh, rd_lrc ? " + LRC" : "", energy_pipeline_field ? " + static field" : "" );
+	else
+		sprintf( linebuf, "SYSTEM: energy pipeline specialized for %s + %s%s%s\n", rd_model_names[rd], es_model_names[es], rd_lrc ? " + LRC" : "", energy_pipeline_field ? " + static field" : "" );
+	Output::out1( linebuf );
+}
@@ -0,0 +1,414 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "SafeOps.h"
+#include "System.h"
+#include "UsefulMath.h"
+
+
+
+// Precomputed k-vectors and structure-factor phases for the Ewald reciprocal sums.
+//
+// coulombic_reciprocal(), recip_term() and induced_recip_term() all sum over the same half-space of
+// reciprocal lattice vectors k = 2*pi*reciprocal_basis*l, |l| <= ewald_kmax, and need e^{i k.r} for
+// every atom at every k. ewald_kvectors_update() lists the k-vectors, along with |k|^2 and their
+// Gaussian weights for both ewald_alpha and polar_ewald_alpha. It regenerates them only when the
+// cell (or kmax or either alpha) has changed since they were made, i.e. after volume_change(), its
+// reversal, or a Gibbs volume exchange.
+//
+// For the phases, k.r = l0*theta_0 + l1*theta_1 + l2*theta_2, with theta_q = 2*pi*(column q of
+// reciprocal_basis).r. ewald_phases_begin() tabulates e^{i m theta_q}, m = 0..kmax, for each atom
+// by repeated multiplication (negative m are the conjugates), and ewald_phases_at() then assembles
+// e^{i k.r} from three table entries, reusing the product of the first two while l0 and l1 stay
+// the same, which they do along each row of the k-vector list. No cos() or sin() is called beyond
+// the three per atom that start the tables.
+//
+//   ewald_kvec[3*kk], ewald_kvec_l[3*kk]             k-vector kk and its lattice indices
+//   ewald_eimq_re/im[ (3*j + q)*(kmax+1) + m ]        e^{i m theta_q} for ewald_phase_atom[j]
+//   ewald_phase_re/im[j]                              e^{i k.r_j} for the last k passed to ewald_phases_at()
+//   ewald_sf_re/im[kk]                                S(k), for the configuration it was last brought up to date with
+//
+// coulombic_reciprocal() also keeps the structure factor S(k) = sum_j q_j e^{i k.r_j} of the mobile
+// charges between calls. When make_move() has displaced, inserted or removed a single molecule
+// since it was summed, ewald_sf_update() subtracts the molecule's old contribution and adds its new
+// one, which costs O(n_mol K) in place of O(N K). The values from before the move are kept, and
+// restore() puts them back if the move is rejected. Any other change to the configuration (volume
+// moves, Gibbs and path-integral moves, which don't go through make_move()) leaves no record, so
+// without one S(k) is summed in full; and it is summed in full every ewald_sf_refresh updates in
+// any case, so that rounding errors can't accumulate.
+
+static const int ewald_sf_refresh = 1000;  // incremental updates between full summations
+
+
+
+
+void System::ewald_kvectors_update() {
+
+	int    kmax  = ewald_kmax,
+	       l[3]  = { 0 },
+	       n     = 0;
+	double *k;
+
+	if(   (kmax == ewald_kvec_kmax)
+	   && (ewald_alpha == ewald_kvec_alpha)
+	   && (polar_ewald_alpha == ewald_kvec_polar_alpha)
+	   && ! memcmp( ewald_kvec_basis, pbc.reciprocal_basis, sizeof(ewald_kvec_basis) )
+	)
+		return;
+
+	// hemisphere of the k-space sphere, skipping half of the face to avoid double-counting
+	for( l[0] = 0; l[0] <= kmax; l[0]++ ) {
+		for( l[1] = (!l[0] ? 0 : -kmax); l[1] <= kmax; l[1]++ ) {
+			for( l[2] = ((!l[0] && !l[1]) ? 1 : -kmax); l[2] <= kmax; l[2]++ ) {
+
+				if( UsefulMath::iidotprod(l, l) > kmax*kmax )
+					continue;
+
+				if( n == ewald_nk_allocd ) {
+					ewald_nk_allocd = ewald_nk_allocd ? 2*ewald_nk_allocd : 256;
+					SafeOps::realloc( ewald_kvec_l,            3 * ewald_nk_allocd * sizeof(int),    __LINE__, __FILE__ );
+					SafeOps::realloc( ewald_kvec,              3 * ewald_nk_allocd * sizeof(double), __LINE__, __FILE__ );
+					SafeOps::realloc( ewald_kvec_k2,               ewald_nk_allocd * sizeof(double), __LINE__, __FILE__ );
+					SafeOps::realloc( ewald_kvec_weight,           ewald_nk_allocd * sizeof(double), __LINE__, __FILE__ );
+					SafeOps::realloc( ewald_kvec_polar_weight,     ewald_nk_allocd * sizeof(double), __LINE__, __FILE__ );
+				}
+
+				k = ewald_kvec + 3*n;
+				for( int p = 0; p < 3; p++ ) {
+					ewald_kvec_l[3*n + p] = l[p];
+					k[p] = 0;
+					for( int q = 0; q < 3; q++ )
+						k[p] += 2.0 * pi * pbc.reciprocal_basis[p][q] * l[q];
+				}
+				ewald_kvec_k2[n]           = UsefulMath::dddotprod( k, k );
+				ewald_kvec_weight[n]       = exp( -ewald_kvec_k2[n] / (4.0*ewald_alpha*ewald_alpha) ) / ewald_kvec_k2[n];
+				ewald_kvec_polar_weight[n] = exp( -ewald_kvec_k2[n] / (4.0*polar_ewald_alpha*polar_ewald_alpha) ) / ewald_kvec_k2[n];
+				n++;
+			}
+		}
+	}
+
+	ewald_nk               = n;
+	ewald_kvec_kmax        = kmax;
+	ewald_kvec_alpha       = ewald_alpha;
+	ewald_kvec_polar_alpha = polar_ewald_alpha;
+	memcpy( ewald_kvec_basis, pbc.reciprocal_basis, sizeof(ewald_kvec_basis) );
+
+	// the running structure factor refers to the old k-vectors
+	ewald_sf_valid = 0;
+}
+
+
+
+
+int System::ewald_phases_begin( bool charged_only, Molecule *only ) {
+// Collect the atoms that take part in the sum (only the mobile, charged ones with charged_only) into
+// ewald_phase_atom, and tabulate their e^{i m theta_q}. Returns the number of atoms collected. With
+// only, just that molecule's atoms are collected (whether or not it is in the system).
+
+	Molecule * molecule_ptr,
+	         * first = only ? only : molecules;
+	Atom     * atom_ptr;
+	int        kmax  = ewald_kvec_kmax,
+	           width = kmax + 1,
+	           n     = 0;
+	double     theta, c1, s1, *re, *im;
+
+	for( molecule_ptr = first; molecule_ptr; molecule_ptr = only ? nullptr : molecule_ptr->next )
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			n++;
+
+	if( (n > ewald_phase_allocd) || (width > ewald_phase_width) ) {
+		ewald_phase_allocd = (n > ewald_phase_allocd)     ? n     : ewald_phase_allocd;
+		ewald_phase_width  = (width > ewald_phase_width)  ? width : ewald_phase_width;
+		SafeOps::realloc( ewald_phase_atom,  ewald_phase_allocd * sizeof(Atom *), __LINE__, __FILE__ );
+		SafeOps::realloc( ewald_eimq_re,     ewald_phase_allocd * 3 * ewald_phase_width * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( ewald_eimq_im,     ewald_phase_allocd * 3 * ewald_phase_width * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( ewald_phase01_re,  ewald_phase_allocd * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( ewald_phase01_im,  ewald_phase_allocd * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( ewald_phase_re,    ewald_phase_allocd * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( ewald_phase_im,    ewald_phase_allocd * sizeof(double), __LINE__, __FILE__ );
+	}
+
+	n = 0;
+	for( molecule_ptr = first; molecule_ptr; molecule_ptr = only ? nullptr : molecule_ptr->next ) {
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+
+			if( charged_only  &&  (atom_ptr->frozen || (atom_ptr->charge == 0.0)) )
+				continue;
+
+			for( int q = 0; q < 3; q++ ) {
+				theta = 0;
+				for( int p = 0; p < 3; p++ )
+					theta += 2.0 * pi * ewald_kvec_basis[p][q] * atom_ptr->pos[p];
+				c1 = cos( theta );
+				s1 = sin( theta );
+
+				re = ewald_eimq_re + (3*n + q) * width;
+				im = ewald_eimq_im + (3*n + q) * width;
+				re[0] = 1.0;
+				im[0] = 0.0;
+				for( int m = 1; m <= kmax; m++ ) {
+					re[m] = re[m-1]*c1 - im[m-1]*s1;
+					im[m] = re[m-1]*s1 + im[m-1]*c1;
+				}
+			}
+			ewald_phase_atom[n++] = atom_ptr;
+		}
+	}
+
+	ewald_phase_natoms = n;
+	ewald_phase_l01[0] = -1;  // no partial products yet
+	return n;
+}
+
+
+
+
+void System::ewald_phases_at( int kk ) {
+// Set ewald_phase_re/im[j] to e^{i k.r_j} for k-vector kk and each collected atom.
+
+	const int * l     = ewald_kvec_l + 3*kk;
+	int         width = ewald_kvec_kmax + 1,
+	            m1    = abs( l[1] ),
+	            m2    = abs( l[2] );
+	double      sign1 = (l[1] < 0) ? -1.0 : 1.0,   // negative indices take the conjugate
+	            sign2 = (l[2] < 0) ? -1.0 : 1.0,
+	            re0, im0, re1, im1, re2, im2;
+
+	if( (l[0] != ewald_phase_l01[0])  ||  (l[1] != ewald_phase_l01[1]) ) {
+		for( int j = 0; j < ewald_phase_natoms; j++ ) {
+			re0 = ewald_eimq_re[ (3*j    )*width + l[0] ];
+			im0 = ewald_eimq_im[ (3*j    )*width + l[0] ];
+			re1 = ewald_eimq_re[ (3*j + 1)*width + m1   ];
+			im1 = ewald_eimq_im[ (3*j + 1)*width + m1   ] * sign1;
+			ewald_phase01_re[j] = re0*re1 - im0*im1;
+			ewald_phase01_im[j] = re0*im1 + im0*re1;
+		}
+		ewald_phase_l01[0] = l[0];
+		ewald_phase_l01[1] = l[1];
+	}
+
+	for( int j = 0; j < ewald_phase_natoms; j++ ) {
+		re2 = ewald_eimq_re[ (3*j + 2)*width + m2 ];
+		im2 = ewald_eimq_im[ (3*j + 2)*width + m2 ] * sign2;
+		ewald_phase_re[j] = ewald_phase01_re[j]*re2 - ewald_phase01_im[j]*im2;
+		ewald_phase_im[j] = ewald_phase01_re[j]*im2 + ewald_phase01_im[j]*re2;
+	}
+}
+
+
+
+
+void System::ewald_sf_sum() {
+// S(k) from scratch.
+
+	int n;
+
+	ewald_sf_reserve();
+	n = ewald_phases_begin( true );
+	for( int kk = 0; kk < ewald_nk; kk++ ) {
+		ewald_phases_at( kk );
+		ewald_sf_re[kk] = 0;
+		ewald_sf_im[kk] = 0;
+		for( int j = 0; j < n; j++ ) {
+			ewald_sf_re[kk] += ewald_phase_atom[j]->charge * ewald_phase_re[j];
+			ewald_sf_im[kk] += ewald_phase_atom[j]->charge * ewald_phase_im[j];
+		}
+	}
+
+	ewald_sf_valid   = 1;
+	ewald_sf_pending = 0;
+	ewald_sf_updates = 0;
+}
+
+
+
+
+void System::ewald_sf_update() {
+// Bring S(k) up to date, incrementally if make_move() moved a single molecule since it was summed.
+
+	ewald_kvectors_update();
+	ewald_sf_reserve();
+
+	if( ! ewald_sf_pending ) {
+		ewald_sf_sum();
+		return;
+	}
+
+	// keep the pre-move values in case of a rejection
+	memcpy( ewald_sf_saved_re, ewald_sf_re, ewald_nk * sizeof(double) );
+	memcpy( ewald_sf_saved_im, ewald_sf_im, ewald_nk * sizeof(double) );
+	ewald_sf_rollback = 1;
+
+	if( !ewald_sf_valid  ||  (ewald_sf_updates >= ewald_sf_refresh) ) {
+		ewald_sf_sum();
+		return;
+	}
+
+	// the backup holds the molecule as it was (none for insertions), and the altered molecule is as it now is (none for removals)
+	if( checkpoint->molecule_backup )
+		ewald_sf_add_molecule( checkpoint->molecule_backup, -1.0 );
+	if( checkpoint->molecule_altered )
+		ewald_sf_add_molecule( checkpoint->molecule_altered, 1.0 );
+
+	ewald_sf_pending = 0;
+	ewald_sf_updates++;
+}
+
+
+
+
+void System::ewald_sf_add_molecule( Molecule *molecule, double sign ) {
+
+	int    n = ewald_phases_begin( true, molecule );
+	double q;
+
+	if( ! n )
+		return;
+
+	for( int kk = 0; kk < ewald_nk; kk++ ) {
+		ewald_phases_at( kk );
+		for( int j = 0; j < n; j++ ) {
+			q = sign * ewald_phase_atom[j]->charge;
+			ewald_sf_re[kk] += q * ewald_phase_re[j];
+			ewald_sf_im[kk] += q * ewald_phase_im[j];
+		}
+	}
+}
+
+
+
+
+void System::ewald_sf_move_made() {
+// Called by make_move() once the move is done.
+
+	int movetype = checkpoint->movetype;
+
+	ewald_sf_rollback = 0;
+
+	// SPECTRE moves alter the charges of every molecule, and insertions from an insertion list rebuild the end of the molecule list
+	if(   ewald_sf_valid  &&  !spectre
+	   && (   movetype == MOVETYPE_DISPLACE  ||  movetype == MOVETYPE_ADIABATIC  ||  movetype == MOVETYPE_REMOVE
+	       || ((movetype == MOVETYPE_INSERT)  &&  !num_insertion_molecules) )
+	)
+		ewald_sf_pending = 1;
+	else
+		ewald_sf_valid = 0;
+}
+
+
+
+
+void System::ewald_sf_restore() {
+// Called by restore(): roll S(k) back to the values from before the rejected move.
+
+	if( ewald_sf_rollback ) {
+		memcpy( ewald_sf_re, ewald_sf_saved_re, ewald_nk * sizeof(double) );
+		memcpy( ewald_sf_im, ewald_sf_saved_im, ewald_nk * sizeof(double) );
+	} else
+		ewald_sf_valid = 0;  // whatever was last summed may have been the rejected configuration
+
+	ewald_sf_pending  = 0;
+	ewald_sf_rollback = 0;
+}
+
+
+
+
+void System::ewald_sf_accept() {
+// Called by do_checkpoint(): the current configuration is the one to keep.
+
+	// a move that was never evaluated was never added in
+	if( ewald_sf_pending )
+		ewald_sf_valid = 0;
+
+	ewald_sf_pending  = 0;
+	ewald_sf_rollback = 0;
+}
+
+
+
+
+void System::ewald_sf_reserve() {
+
+	if( ewald_nk <= ewald_sf_allocd )
+		return;
+
+	SafeOps::realloc( ewald_sf_re,       ewald_nk * sizeof(double), __LINE__, __FILE__ );
+	SafeOps::realloc( ewald_sf_im,       ewald_nk * sizeof(double), __LINE__, __FILE__ );
+	SafeOps::realloc( ewald_sf_saved_re, ewald_nk * sizeof(double), __LINE__, __FILE__ );
+	SafeOps::realloc( ewald_sf_saved_im, ewald_nk * sizeof(double), __LINE__, __FILE__ );
+	ewald_sf_allocd = ewald_nk;
+	ewald_sf_valid  = 0;
+}
+
+
+
+
+void System::ewald_kspace_free() {
+
+	if( ewald_kvec_l            ) free( ewald_kvec_l            );
+	if( ewald_kvec              ) free( ewald_kvec              );
+	if( ewald_kvec_k2           ) free( ewald_kvec_k2           );
+	if( ewald_kvec_weight       ) free( ewald_kvec_weight       );
+	if( ewald_kvec_polar_weight ) free( ewald_kvec_polar_weight );
+	if( ewald_phase_atom        ) free( ewald_phase_atom        );
+	if( ewald_eimq_re           ) free( ewald_eimq_re           );
+	if( ewald_eimq_im           ) free( ewald_eimq_im           );
+	if( ewald_phase01_re        ) free( ewald_phase01_re        );
+	if( ewald_phase01_im        ) free( ewald_phase01_im        );
+	if( ewald_phase_re          ) free( ewald_phase_re          );
+	if( ewald_phase_im          ) free( ewald_phase_im          );
+	if( ewald_sf_re             ) free( ewald_sf_re             );
+	if( ewald_sf_im             ) free( ewald_sf_im             );
+	if( ewald_sf_saved_re       ) free( ewald_sf_saved_re       );
+	if( ewald_sf_saved_im       ) free( ewald_sf_saved_im       );
+
+	ewald_kspace_init();
+}
+
+
+
+
+void System::ewald_kspace_init() {
+// Empty caches; the k-vectors are generated on first use.
+
+	ewald_nk                = 0;
+	ewald_nk_allocd         = 0;
+	ewald_kvec_kmax         = -1;
+	ewald_kvec_alpha        = 0;
+	ewald_kvec_polar_alpha  = 0;
+	memset( ewald_kvec_basis, 0, sizeof(ewald_kvec_basis) );
+	ewald_kvec_l            = nullptr;
+	ewald_kvec              = nullptr;
+	ewald_kvec_k2           = nullptr;
+	ewald_kvec_weight       = nullptr;
+	ewald_kvec_polar_weight = nullptr;
+
+	ewald_phase_natoms      = 0;
+	ewald_phase_allocd      = 0;
+	ewald_phase_width       = 0;
+	ewald_phase_l01[0]      = -1;
+	ewald_phase_l01[1]      = 0;
+	ewald_phase_atom        = nullptr;
+	ewald_eimq_re           = nullptr;
+	ewald_eimq_im           = nullptr;
+	ewald_phase01_re        = nullptr;
+	ewald_phase01_im        = nullptr;
+	ewald_phase_re          = nullptr;
+	ewald_phase_im          = nullptr;
+
+	ewald_sf_valid          = 0;
+	ewald_sf_pending        = 0;
+	ewald_sf_rollback       = 0;
+	ewald_sf_updates        = 0;
+	ewald_sf_allocd         = 0;
+	ewald_sf_re             = nullptr;
+	ewald_sf_im             = nullptr;
+	ewald_sf_saved_re       = nullptr;
+	ewald_sf_saved_im       = nullptr;
+}
@@ -0,0 +1,208 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Output.h"
+#include "System.h"
+
+
+
+// Automatic choice of the Ewald parameters for a target accuracy (ewald_precision, in K).
+//
+// The truncation errors of the two halves of the sum are estimated as by Kolafa and Perram
+// (Mol. Sim. 9, 351 (1992)), from Q = sum q^2, the cutoff rc and the cell:
+//
+//   real space        Q sqrt(rc/(2V)) exp(-alpha^2 rc^2) / (alpha rc)^2
+//   reciprocal space  Q alpha/pi^2 kmax^(-3/2) exp(-(pi kmax/(alpha L))^2)
+//
+// with L the longest cell vector. The error budget can be split between the two in any proportion
+// (in quadrature); for each of several splits, alpha is the smallest that meets the real-space share
+// and kmax (or, with ewald_spme, the mesh tolerance) the least that meets the reciprocal share. Each
+// candidate is timed on the actual system, and the fastest is kept. polar_ewald_alpha follows
+// ewald_alpha unless it was set in the input.
+//
+// ewald_tune() runs once the pair lists are first made, and again from do_checkpoint() whenever
+// the volume has drifted far enough from the one it was tuned at that the choice may no longer hold
+// (unless ewald_retune is off). Since the choice rests on timings, runs from the same seed may differ
+// in their parameters; each choice is logged, and ewald_retune off keeps the first one for the run.
+
+static const double retune_volume_drift = 0.10;  // relative change in volume that prompts a re-tune
+static const int    timing_repeats      = 3;     // best of this many evaluations is taken as the cost
+static const int    kmax_limit          = 50;
+static const double split_fractions[]   = { 0.3, 0.5, 0.7, 0.8, 0.9, 0.95 };  // real-space share of the error
+
+
+
+
+static double real_space_error( double Q, double alpha, double cutoff, double volume ) {
+	double arc = alpha * cutoff;
+	return Q * sqrt( 0.5 * cutoff / volume ) * exp( -arc*arc ) / (arc*arc);
+}
+
+
+
+
+static double reciprocal_error( double Q, double alpha, int kmax, double length ) {
+	double x = pi * kmax / (alpha * length);
+	return Q * alpha / (pi*pi) * pow( (double) kmax, -1.5 ) * exp( -x*x );
+}
+
+
+
+
+static double alpha_for( double Q, double target, double cutoff, double volume ) {
+// The smallest alpha whose real-space error is within target (the error falls as alpha grows).
+
+	double lower = 0.1 / cutoff,
+	       upper = 10.0 / cutoff,
+	       middle;
+
+	if( real_space_error( Q, upper, cutoff, volume ) > target )
+		return upper;
+
+	for( int i = 0; i < 60; i++ ) {
+		middle = 0.5 * (lower + upper);
+		if( real_space_error( Q, middle, cutoff, volume ) > target )
+			lower = middle;
+		else
+			upper = middle;
+	}
+	return upper;
+}
+
+
+
+
+double System::ewald_time_evaluation() {
+// Seconds taken by one real-space and one reciprocal-space evaluation (the best of a few).
+
+	struct timeval start, finish;
+	double         best = 0,
+	               seconds;
+
+	for( int i = 0; i < timing_repeats; i++ ) {
+		flag_all_pairs();
+		ewald_sf_valid = 0;
+		Output::GetTimeOfDay( &start );
+		coulombic_real();
+		coulombic_reciprocal();
+		Output::GetTimeOfDay( &finish );
+
+		seconds = Output::calctimediff( finish, start );
+		if( !i  ||  (seconds < best) )
+			best = seconds;
+	}
+	return best;
+}
+
+
+
+
+void System::ewald_tune() {
+
+	char       linebuf[maxLine];
+	Molecule * molecule_ptr;
+	Atom     * atom_ptr;
+	double     Q              = 0,
+	           length         = 0,
+	           cutoff         = pbc.cutoff,
+	           volume         = pbc.volume,
+	           best_time      = 0,
+	           best_alpha     = 0,
+	           best_tolerance = 0,
+	           alpha, tolerance, real_target, recip_target, seconds, vector2;
+	int        kmax,
+	           best_kmax      = 0;
+	bool       found          = false;
+
+	if( (ewald_precision <= 0)  ||  wolf  ||  use_sg  ||  rd_only )
+		return;
+
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			Q += atom_ptr->charge * atom_ptr->charge;
+	if( Q == 0.0 )
+		return;
+
+	for( int q = 0; q < 3; q++ ) {
+		vector2 = pbc.basis[q][0]*pbc.basis[q][0] + pbc.basis[q][1]*pbc.basis[q][1] + pbc.basis[q][2]*pbc.basis[q][2];
+		if( vector2 > length*length )
+			length = sqrt( vector2 );
+	}
+
+	// the separations have to be current for the real-space timing
+	pairs();
+
+	for( double f : split_fractions ) {
+		real_target  = ewald_precision * f;
+		recip_target = ewald_precision * sqrt( 1.0 - f*f );
+
+		alpha = alpha_for( Q, real_target, cutoff, volume );
+		for( kmax = 1; kmax < kmax_limit; kmax++ )
+			if( reciprocal_error( Q, alpha, kmax, length ) <= recip_target )
+				break;
+		// the mesh tolerance is relative to the size of the reciprocal-space terms, ~ Q alpha/sqrt(pi)
+		tolerance = recip_target / (Q * alpha * OneOverSqrtPi);
+		tolerance = (tolerance < 1.0e-12) ? 1.0e-12 : ((tolerance > 1.0e-2) ? 1.0e-2 : tolerance);
+
+		ewald_alpha          = alpha;
+		ewald_kmax           = kmax;
+		ewald_spme_tolerance = tolerance;
+		if( ! polar_ewald_alpha_set )
+			polar_ewald_alpha = alpha;
+
+		seconds = ewald_time_evaluation();
+		if( !found  ||  (seconds < best_time) ) {
+			found          = true;
+			best_time      = seconds;
+			best_alpha     = alpha;
+			best_kmax      = kmax;
+			best_tolerance = tolerance;
+		}
+	}
+
+	ewald_alpha          = best_alpha;
+	ewald_kmax           = best_kmax;
+	ewald_spme_tolerance = best_tolerance;
+	if( ! polar_ewald_alpha_set )
+		polar_ewald_alpha = best_alpha;
+	ewald_tuned_volume   = volume;
+
+	// every cached term was made with some other alpha
+	flag_all_pairs();
+	ewald_sf_valid     = 0;
+	delta_energy_count = delta_energy_refresh;
+
+	if( ewald_spme )
+		sprintf( linebuf, "SYSTEM: Ewald tuned to %.2e K: alpha = %f A^-1, SPME tolerance = %.2e (%.3f ms per evaluation)\n",
+		         ewald_precision, ewald_alpha, ewald_spme_tolerance, 1000.0 * best_time );
+	else
+		sprintf( linebuf, "SYSTEM: Ewald tuned to %.2e K: alpha = %f A^-1, kmax = %d (%.3f ms per evaluation)\n",
+		         ewald_precision, ewald_alpha, ewald_kmax, 1000.0 * best_time );
+	Output::out1( linebuf );
+}
+
+
+
+
+bool System::ewald_tune_check() {
+// Called by do_checkpoint(): re-tune if the volume has drifted far from the one last tuned for.
+// Returns true if the parameters were chosen again, after which every energy must be re-evaluated.
+
+	char   linebuf[maxLine];
+	double drift;
+
+	if( (ewald_precision <= 0)  ||  (ewald_tuned_volume <= 0)  ||  !ewald_retune )
+		return false;
+
+	drift = pbc.volume / ewald_tuned_volume - 1.0;
+	if( fabs( drift ) <= retune_volume_drift )
+		return false;
+
+	sprintf( linebuf, "SYSTEM: step %d: volume has drifted %+.1f%% since the Ewald parameters were chosen; re-tuning (ewald_retune off keeps them fixed)\n",
+	         step, 100.0 * drift );
+	Output::out1( linebuf );
+	ewald_tune();
+	return true;
+}
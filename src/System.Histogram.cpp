@@ -161,24 +161,10 @@ void System::compute_bin( double *cart_coords, int *bin_vector )
 
 void System::wrap1coord( double *unwrapped, double *wrapped ) 
 {
-	double unit  [3] = {0},
-	       offset[3] = {0},
-	       frac  [3] = {0};
+	double offset[3] = {0};
 
-	// put coords in fractional representation 
-	for( int i=0; i<3; i++ )
-		for( int j=0; j<3; j++ ) 
-			//we use transpose(recip_basis), because transpose(recip_basis).basis_vector = <1,0,0> , <0,1,0> or <0,0,1>
-			frac[i] += pbc.reciprocal_basis[j][i]*unwrapped[j];
-
-	// any fractional coord > .5 or < -.5 round to 1,-1 etc. 
-	for( int i=0; i<3; i++ )
-		unit[i] = rint(frac[i]);
-
-	// multiply this rounded fractional unit vector by basis 
-	for( int i=0; i<3; i++ )
-		for( int j=0; j<3; j++ )
-			offset[i] += pbc.basis[j][i] * unit[j];
+	// any fractional coord > .5 or < -.5 rounds to 1,-1 etc., and that lattice vector is the offset
+	pbc.image_offset( unwrapped, offset );
 
 	// subtract this distance from the incoming vector 
 	for( int i=0; i<3; i++ )
@@ -277,13 +263,7 @@ void System::frac2cart(double *answer, double *frac )
 void System::cart2frac(double *answer, double *cart ) 
 // Take a vector in cartesian coordinates (cart[]) and convert it to fractional coordinates. Store the answer in anwer[]
 {
-	for( int i=0; i<3; i++ )
-		answer[i] = 0.0;
-
-	for( int i=0; i<3; i++ )
-		for(int j=0; j<3; j++ )
-			//we use transpose(recip_basis), because transpose(recip_basis).basis_vector = <1,0,0> , <0,1,0> or <0,0,1>
-			answer[i] += pbc.reciprocal_basis[j][i] * cart[j];
+	pbc.cart_to_frac( cart, answer );
 
 	return;
 }
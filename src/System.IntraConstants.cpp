@@ -0,0 +1,218 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Output.h"
+#include "System.h"
+
+
+
+// Ewald self and intra-molecular terms of each molecule type.
+//
+// coulombic_self() takes alpha q^2/sqrt(pi) away for every (mobile) atom, and coulombic_real() takes
+// away q_i q_j erf(alpha r_ij)/r_ij for every intra-molecular pair, the part of the reciprocal sum
+// that the intra-molecular exclusions leave out. Molecules are moved rigidly, so both depend only on
+// the molecule's type and on alpha, and with es_intra_by_type() they are computed once per type
+// (es_intra_molecule()) and summed by the number of molecules of each type in the system. The count
+// is adjusted as molecules enter and leave the system (resize_pair_rows()), so an insertion or
+// removal costs O(1), and coulombic_self() O(types), rather than O(atoms) and O(atoms_per_molecule^2)
+// per molecule. When alpha changes (as update_pbc() changes it with the volume), the terms of one
+// molecule of each type are computed again. coulombic_real_pair() leaves es_self_intra_energy at zero.
+//
+// Types are by name, as for vdw_eiso_energy. Inserted molecules are rigid copies of those read in
+// (the system's own, or the insertion templates), so each of those is checked once, by the first
+// es_intra_from_counts() after the input (or after the atomic parameters change): its terms are
+// computed and compared with those of the first molecule of its name. Molecules sharing a name but
+// not their terms (or SPECTRE charges, or gwp, which has no intra-molecular exclusions) put the system
+// back on the per-pair sums.
+
+static const double es_intra_tolerance = 1.0e-8;  // relative; rigid moves round the geometry a little
+
+
+
+
+static bool same( double a, double b ) {
+	return fabs(a - b) <= es_intra_tolerance * (fabs(a) + fabs(b));
+}
+
+
+
+
+double System::es_intra_molecule( const Molecule *molecule ) {
+// The self terms of a molecule's atoms and the charge-to-screen terms of its intra-molecular pairs,
+// as coulombic_self() and coulombic_real_pair() evaluate them.
+
+	double alpha  = ewald_alpha,
+	       energy = 0;
+
+	for( const Atom *atom_ptr = molecule->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+
+		if( ! atom_ptr->frozen )
+			energy -= alpha * atom_ptr->charge * atom_ptr->charge / sqrt(pi);
+
+		for( const Atom *other_ptr = atom_ptr->next; other_ptr; other_ptr = other_ptr->next ) {
+			if( atom_ptr->frozen && other_ptr->frozen )
+				continue;
+
+			double r2 = 0;
+			for( int p = 0; p < 3; p++ )
+				r2 += (atom_ptr->pos[p] - other_ptr->pos[p]) * (atom_ptr->pos[p] - other_ptr->pos[p]);
+			double r = sqrt(r2);
+
+			energy -= atom_ptr->charge * other_ptr->charge * erf_lookup(alpha*r) / r;
+		}
+	}
+
+	return energy;
+}
+
+
+
+
+void System::es_intra_counts_reset() {
+// Forget every type's terms (the atomic parameters may have changed) and count the molecules again.
+// The next es_intra_from_counts() checks the molecules afresh.
+
+	es_intra_energy.clear();
+	es_intra_count.clear();
+	es_intra_checked = 0;
+
+	for( Molecule *molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		es_intra_counts_add( molecule_ptr, 1 );
+}
+
+
+
+
+void System::es_intra_counts_add( Molecule *molecule, int sign ) {
+// Count a molecule entering (sign > 0) or leaving (sign < 0) the system.
+
+	int t = molecule->moleculetype_id;
+
+	es_intra_reserve( t );
+	es_intra_count[t] += sign;
+}
+
+
+
+
+void System::es_intra_reserve( int t ) {
+// Room for the terms and count of type t.
+
+	if( t < (int) es_intra_count.size() )
+		return;
+
+	int n = TypeRegistry::molecule_type_count();
+	if( n <= t )
+		n = t + 1;
+	es_intra_energy.resize( n, NAN );
+	es_intra_count .resize( n, 0   );
+}
+
+
+
+
+double System::es_intra_check() {
+// Compute the terms of every molecule in the system and of every insertion template, for the current
+// alpha, and check each against the first molecule of its type. Returns the total for the molecules in
+// the system, which is their energy whether or not they agree (the pairs were evaluated without their
+// intra terms).
+
+	Molecule * molecule_ptr;
+	double     energy = 0,
+	           molecule_energy;
+	int        t;
+	bool       differ = false;
+
+	for( t = 0; t < (int) es_intra_energy.size(); t++ )
+		es_intra_energy[t] = NAN;
+	es_intra_alpha   = ewald_alpha;
+	es_intra_checked = 1;
+
+	for( int list = 0; list < 2; list++ ) {
+		for( molecule_ptr = list ? insertion_molecules : molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+			t               = molecule_ptr->moleculetype_id;
+			molecule_energy = es_intra_molecule( molecule_ptr );
+			if( ! list )
+				energy += molecule_energy;
+
+			es_intra_reserve( t );
+			if( isnan(es_intra_energy[t]) )
+				es_intra_energy[t] = molecule_energy;
+			else if( !differ  &&  !same(molecule_energy, es_intra_energy[t]) ) {
+				es_intra_differs( molecule_ptr );
+				differ = true;
+			}
+		}
+	}
+
+	return energy;
+}
+
+
+
+
+void System::es_intra_differs( const Molecule *molecule ) {
+// molecule's terms aren't those of its type: go back to the per-pair sums.
+
+	char linebuf[maxLine];
+
+	sprintf( linebuf, "SYSTEM: molecules of type %s differ in their charges or geometry; the Ewald intra-molecular terms will be summed per pair.\n", molecule->moleculetype() );
+	Output::out1( linebuf );
+
+	// the pairs (and the running totals of delta_energy()) were evaluated without their intra terms
+	es_intra_mixed     = 1;
+	delta_energy_count = delta_energy_refresh;
+	flag_all_pairs();
+}
+
+
+
+
+double System::es_intra_from_counts() {
+// The self and intra-molecular terms of every molecule in the system.
+
+	double energy  = 0;
+	int    ntypes  = (int) es_intra_count.size(),
+	       pending = 0;
+
+	if( ! es_intra_checked )
+		return es_intra_check();
+
+	// for a new alpha, the terms of each type present are computed for one molecule of that type
+	if( es_intra_alpha != ewald_alpha ) {
+		for( int t = 0; t < ntypes; t++ ) {
+			es_intra_energy[t] = NAN;
+			if( es_intra_count[t] )
+				pending++;
+		}
+		es_intra_alpha = ewald_alpha;
+
+		for( Molecule *molecule_ptr = molecules; molecule_ptr && pending; molecule_ptr = molecule_ptr->next ) {
+			int t = molecule_ptr->moleculetype_id;
+			if( isnan(es_intra_energy[t]) ) {
+				es_intra_energy[t] = es_intra_molecule( molecule_ptr );
+				pending--;
+			}
+		}
+	}
+
+	for( int t = 0; t < ntypes; t++ )
+		if( es_intra_count[t] )
+			energy += es_intra_count[t] * es_intra_energy[t];
+
+	return energy;
+}
+
+
+
+
+void System::es_intra_init() {
+
+	es_intra_energy.clear();
+	es_intra_count.clear();
+	es_intra_alpha   = 0;
+	es_intra_checked = 0;
+	es_intra_mixed   = 0;
+}
@@ -0,0 +1,207 @@
+#include <math.h>
+
+#include "Pair.h"
+#include "SafeOps.h"
+#include "Simd.h"
+#include "System.h"
+
+
+
+// Batched Lennard-Jones.
+//
+// lj_pair() tests the configuration (rd_crystal, spectre, polarvdw, cdvdw_sig_repulsion,
+// feynman_hibbs) and the pair's own flags (attractive_only, the exclusions) for every pair it is
+// handed. When neither rd_crystal nor feynman_hibbs is in use, lj() instead queues the pairs due for
+// recalculation with lj_block_queue(), which folds all of these into a coefficient and a repulsion
+// flag per pair. lj_block_flush() then evaluates the block in a single branch-free loop,
+//
+//     rd_energy = coef * ( repulsive ? (sigma/r)^12 : 0  -  attractive ? (sigma/r)^6 : 0 )
+//
+// with coef = 4*epsilon (sigrep with cdvdw_sig_repulsion, 1 for SPECTRE), and attractive fixed by
+// the configuration. The operations are those of lj_pair(), in the same order, so the results agree
+// bit for bit. An AVX-512 or AVX2 kernel is used when the CPU supports it.
+
+static const int lj_block_size = 512;
+
+typedef void (*lj_kernel)( int n, const double *rimg, const double *sigma, const double *coef, const double *repulsive, bool attractive, double *energy, int start );
+
+
+
+
+static void lj_block_scalar( int n, const double *rimg, const double *sigma, const double *coef, const double *repulsive, bool attractive, double *energy, int start ) {
+// Also finishes off whatever the vector kernels leave over, from start on.
+
+	double sigma_over_r, sigma_over_r6, sigma_over_r12, term6, term12;
+
+	for( int k = start; k < n; k++ ) {
+		sigma_over_r    = sigma[k] / rimg[k];
+		sigma_over_r6   = sigma_over_r * sigma_over_r * sigma_over_r;
+		sigma_over_r6  *= sigma_over_r6;
+		sigma_over_r12  = sigma_over_r6 * sigma_over_r6;
+
+		term12    = (repulsive[k] != 0.0) ? sigma_over_r12 : 0.0;
+		term6     = attractive            ? sigma_over_r6  : 0.0;
+		energy[k] = coef[k] * (term12 - term6);
+	}
+}
+
+
+
+
+#ifdef SIMD_X86
+
+SIMD_TARGET_AVX2 static void lj_block_avx2( int n, const double *rimg, const double *sigma, const double *coef, const double *repulsive, bool attractive, double *energy, int start ) {
+
+	const __m256d zero   = _mm256_setzero_pd(),
+	              attr   = attractive ? _mm256_castsi256_pd( _mm256_set1_epi64x(-1) ) : zero;
+	__m256d       sr, sr6, sr12, rep;
+	int           k      = start;
+
+	for( ; k + 4 <= n; k += 4 ) {
+		sr   = _mm256_div_pd( _mm256_loadu_pd(sigma + k), _mm256_loadu_pd(rimg + k) );
+		sr6  = _mm256_mul_pd( _mm256_mul_pd(sr, sr), sr );
+		sr6  = _mm256_mul_pd( sr6, sr6 );
+		sr12 = _mm256_mul_pd( sr6, sr6 );
+
+		rep  = _mm256_cmp_pd( _mm256_loadu_pd(repulsive + k), zero, _CMP_NEQ_UQ );
+		_mm256_storeu_pd( energy + k, _mm256_mul_pd( _mm256_loadu_pd(coef + k), _mm256_sub_pd( _mm256_and_pd(sr12, rep), _mm256_and_pd(sr6, attr) )));
+	}
+
+	lj_block_scalar( n, rimg, sigma, coef, repulsive, attractive, energy, k );
+}
+
+
+
+
+SIMD_TARGET_AVX512 static void lj_block_avx512( int n, const double *rimg, const double *sigma, const double *coef, const double *repulsive, bool attractive, double *energy, int start ) {
+
+	const __m512d  zero   = _mm512_setzero_pd();
+	const __mmask8 attr   = attractive ? 0xFF : 0x00;
+	__m512d        sr, sr6, sr12;
+	__mmask8       rep;
+	int            k      = start;
+
+	for( ; k + 8 <= n; k += 8 ) {
+		sr   = _mm512_div_pd( _mm512_loadu_pd(sigma + k), _mm512_loadu_pd(rimg + k) );
+		sr6  = _mm512_mul_pd( _mm512_mul_pd(sr, sr), sr );
+		sr6  = _mm512_mul_pd( sr6, sr6 );
+		sr12 = _mm512_mul_pd( sr6, sr6 );
+
+		rep  = _mm512_cmp_pd_mask( _mm512_loadu_pd(repulsive + k), zero, _CMP_NEQ_UQ );
+		_mm512_storeu_pd( energy + k, _mm512_mul_pd( _mm512_loadu_pd(coef + k), _mm512_sub_pd( _mm512_maskz_mov_pd(rep, sr12), _mm512_maskz_mov_pd(attr, sr6) )));
+	}
+
+	lj_block_scalar( n, rimg, sigma, coef, repulsive, attractive, energy, k );
+}
+
+#endif // SIMD_X86
+
+
+
+
+static lj_kernel select_lj_kernel() {
+
+	#ifdef SIMD_X86
+		switch( Simd::isa() ) {
+			case Simd::AVX512: return lj_block_avx512;
+			case Simd::AVX2:   return lj_block_avx2;
+			default:           break;
+		}
+	#endif
+
+	return lj_block_scalar;
+}
+
+
+
+
+bool System::lj_block_supported() {
+// rd_crystal sums over periodic images, and the Feynman-Hibbs terms need the molecular masses
+	return !rd_crystal && !feynman_hibbs;
+}
+
+
+
+
+double System::lj_block_queue( Pair *pair_ptr, double cutoff ) {
+// Queue a pair for recalculation, as lj_pair() would do it. Returns the energy of the block that
+// had to be flushed to make room, if any.
+
+	double flushed = 0;
+	int    k;
+
+	pair_ptr->rd_energy = 0;
+
+	// to include a contribution, we require that the pair is inside the cutoff, not excluded and not frozen
+	if( !(pair_ptr->rimg - SMALL_dR < cutoff)  ||  pair_ptr->rd_excluded  ||  pair_ptr->frozen )
+		return 0;
+
+	if( ! lj_block_pair ) {
+		SafeOps::calloc( lj_block_pair,      lj_block_size, sizeof(Pair *), __LINE__, __FILE__ );
+		SafeOps::calloc( lj_block_rimg,      lj_block_size, sizeof(double), __LINE__, __FILE__ );
+		SafeOps::calloc( lj_block_sigma,     lj_block_size, sizeof(double), __LINE__, __FILE__ );
+		SafeOps::calloc( lj_block_coef,      lj_block_size, sizeof(double), __LINE__, __FILE__ );
+		SafeOps::calloc( lj_block_repulsive, lj_block_size, sizeof(double), __LINE__, __FILE__ );
+		SafeOps::calloc( lj_block_energy,    lj_block_size, sizeof(double), __LINE__, __FILE__ );
+	}
+	if( lj_block_count == lj_block_size )
+		flushed = lj_block_flush();
+
+	k = lj_block_count++;
+	lj_block_pair [k] = pair_ptr;
+	lj_block_rimg [k] = pair_ptr->rimg;
+	lj_block_sigma[k] = fabs( pair_ptr->sigma );
+
+	if( spectre ) {
+		lj_block_coef     [k] = 1.0;
+		lj_block_repulsive[k] = 1.0;
+	} else {
+		lj_block_coef     [k] = cdvdw_sig_repulsion ? pair_ptr->sigrep : 4.0*pair_ptr->epsilon;
+		lj_block_repulsive[k] = pair_ptr->attractive_only ? 0.0 : 1.0;
+	}
+
+	return flushed;
+}
+
+
+
+
+double System::lj_block_flush() {
+// Evaluate the queued pairs, store their energies, and return the sum.
+
+	static const lj_kernel kernel = select_lj_kernel();
+
+	bool   attractive = !( spectre || polarvdw || cdvdw_sig_repulsion );
+	double potential  = 0;
+
+	kernel( lj_block_count, lj_block_rimg, lj_block_sigma, lj_block_coef, lj_block_repulsive, attractive, lj_block_energy, 0 );
+
+	for( int k = 0; k < lj_block_count; k++ ) {
+		lj_block_pair[k]->rd_energy = lj_block_energy[k];
+		potential += lj_block_energy[k];
+	}
+	lj_block_count = 0;
+
+	return potential;
+}
+
+
+
+
+void System::lj_block_free() {
+
+	if( lj_block_pair      ) free( lj_block_pair      );
+	if( lj_block_rimg      ) free( lj_block_rimg      );
+	if( lj_block_sigma     ) free( lj_block_sigma     );
+	if( lj_block_coef      ) free( lj_block_coef      );
+	if( lj_block_repulsive ) free( lj_block_repulsive );
+	if( lj_block_energy    ) free( lj_block_energy    );
+
+	lj_block_pair      = nullptr;
+	lj_block_rimg      = nullptr;
+	lj_block_sigma     = nullptr;
+	lj_block_coef      = nullptr;
+	lj_block_repulsive = nullptr;
+	lj_block_energy    = nullptr;
+	lj_block_count     = 0;
+}
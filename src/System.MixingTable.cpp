@@ -0,0 +1,167 @@
+#include <cstring>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Pair.h"
+#include "SafeOps.h"
+#include "System.h"
+
+
+
+// Type x type cache of pair exclusions and mixed parameters.
+//
+// Apart from the intra-molecular exclusions, everything pair_exclusions() assigns to a pair depends
+// only on the per-atom parameters of its two atoms. Atoms whose parameters are identical therefore
+// share a mixing type (Atom::mixing_type), and the exclusions and mixed parameters are computed once
+// per pair of types and copied into each pair as it is updated.
+//
+//   mixing_type_params[nparams*t]   the atomic parameters that define type t
+//   mixing_table[t*ntypes + u]      a Pair holding the exclusions and mixed parameters for types t,u
+//
+// Types are interned as molecules enter the system (allocate_pair_lists(), insertions). Anything that
+// alters the atomic parameters of atoms already in the system must call mixing_table_reset().
+
+static const int mixing_nparams = 9;
+
+
+
+
+void System::mixing_table_apply( Molecule *molecule_i, Molecule *molecule_j, Atom *atom_i, Atom *atom_j, Pair *pair_ptr ) {
+// Equivalent to pair_exclusions(), but a table lookup.
+
+	// SPECTRE charges fluctuate, and the exclusions along with them
+	if( spectre ) {
+		pair_exclusions( molecule_i, molecule_j, atom_i, atom_j, pair_ptr );
+		return;
+	}
+
+	if( atom_i->mixing_type < 0 )
+		atom_i->mixing_type = mixing_type_intern( atom_i );
+	if( atom_j->mixing_type < 0 )
+		atom_j->mixing_type = mixing_type_intern( atom_j );
+
+	const Pair &mixed = mixing_table[ atom_i->mixing_type * mixing_ntypes + atom_j->mixing_type ];
+
+	if(   (molecule_i == molecule_j)  &&  !gwp   ) {
+		pair_ptr->rd_excluded = 1;
+		pair_ptr->es_excluded = 1;
+	} else {
+		pair_ptr->rd_excluded = mixed.rd_excluded;
+		pair_ptr->es_excluded = mixed.es_excluded;
+	}
+
+	pair_ptr->frozen          = mixed.frozen;
+	pair_ptr->attractive_only = mixed.attractive_only;
+	pair_ptr->sigma           = mixed.sigma;
+	pair_ptr->epsilon         = mixed.epsilon;
+	pair_ptr->sigrep          = mixed.sigrep;
+	pair_ptr->c6              = mixed.c6;
+	pair_ptr->c8              = mixed.c8;
+	pair_ptr->c10             = mixed.c10;
+}
+
+
+
+
+void System::mixing_types_assign( Molecule *molecule ) {
+// (Re)assign the mixing types of a molecule's atoms. Molecules arriving from elsewhere (templates,
+// other Gibbs/PI systems) may carry ids that refer to some other table, so existing ids are ignored.
+
+	for( Atom *atom_ptr = molecule->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+		atom_ptr->mixing_type = mixing_type_intern( atom_ptr );
+}
+
+
+
+
+int System::mixing_type_intern( Atom *atom ) {
+// Return the id of the type matching atom's parameters, adding a new type if there is none.
+
+	double params[ mixing_nparams ] = {
+		atom->epsilon,
+		atom->sigma,
+		atom->omega,
+		atom->polarizability,
+		atom->c6,
+		atom->c8,
+		atom->c10,
+		(double) (atom->charge == 0.0),
+		(double) atom->frozen
+	};
+	int t;
+
+	for( t = 0; t < mixing_ntypes; t++ )
+		if( ! std::memcmp( params, mixing_type_params + mixing_nparams*t, sizeof(params) ) )
+			return t;
+
+	// a new type: grow the tables and recompute every entry
+	mixing_ntypes++;
+	SafeOps::realloc( mixing_type_params, mixing_ntypes * mixing_nparams * sizeof(double), __LINE__, __FILE__ );
+	std::memcpy( mixing_type_params + mixing_nparams*t, params, sizeof(params) );
+
+	delete [] mixing_table;
+	mixing_table = new Pair[ mixing_ntypes * mixing_ntypes ];
+
+	Atom     type_i, type_j;
+	Molecule molecule_i, molecule_j;  // distinct molecules, so that no intra-molecular exclusions are applied
+	for( int u = 0; u < mixing_ntypes; u++ ) {
+		mixing_type_atom( u, &type_i );
+		for( int v = 0; v < mixing_ntypes; v++ ) {
+			mixing_type_atom( v, &type_j );
+			pair_exclusions( &molecule_i, &molecule_j, &type_i, &type_j, &mixing_table[ u*mixing_ntypes + v ] );
+		}
+	}
+
+	return t;
+}
+
+
+
+
+void System::mixing_type_atom( int t, Atom *atom ) {
+// Give atom the parameters that define type t.
+
+	double *params = mixing_type_params + mixing_nparams*t;
+
+	atom->epsilon        = params[0];
+	atom->sigma          = params[1];
+	atom->omega          = params[2];
+	atom->polarizability = params[3];
+	atom->c6             = params[4];
+	atom->c8             = params[5];
+	atom->c10            = params[6];
+	atom->charge         = (params[7] != 0.0) ? 0.0 : 1.0;
+	atom->frozen         = (int) params[8];
+}
+
+
+
+
+void System::mixing_table_reset() {
+// Forget every type and re-intern all of the atoms in the system. The next pairs() then copies the
+// new parameters into every pair, and recomputes every pair energy.
+
+	mixing_table_free();
+	rd_ewald_ntypes = -1;
+	pair_tables_free();
+	for( Molecule *molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		mixing_types_assign( molecule_ptr );
+	lrc_counts_reset();
+	es_intra_counts_reset();
+
+	pair_lists_changed = 1;
+	flag_all_pairs();
+}
+
+
+
+
+void System::mixing_table_free() {
+
+	if( mixing_type_params ) free( mixing_type_params );
+	delete [] mixing_table;
+
+	mixing_type_params = nullptr;
+	mixing_table       = nullptr;
+	mixing_ntypes      = 0;
+}
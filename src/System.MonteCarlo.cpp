@@ -30,6 +30,10 @@ bool System::mc() {
 	observables->volume = pbc.volume; // set volume observable
 	initial_energy = mc_initial_energy();
 	mpiData mpi = setup_mpi();
+
+	// every move below marks the molecules it perturbs, so pairs() need only revisit those. SPECTRE
+	// renormalizes the charges of the whole system on every move, so it always needs the full sweep.
+	dirty_tracking = !spectre;
 	count_autorejects = 0;
 	
 	// save the initial state 
@@ -46,7 +50,10 @@ bool System::mc() {
 		make_move();
 
 		// calculate the energy change 
-		final_energy = energy();
+		if( use_delta_energy )
+			final_energy = delta_energy( checkpoint->molecule_altered );
+		else
+			final_energy = energy();
 
 		#ifdef QM_ROTATION
 			// solve for the rotational energy levels 
@@ -72,10 +79,9 @@ bool System::mc() {
 
 			/////////// ACCEPT
 
-			current_energy = final_energy;
-
-			// checkpoint 
+			// checkpoint (which re-evaluates the energy if it re-tunes the Ewald sum)
 			do_checkpoint();
+			current_energy = observables->energy;
 			register_accept();
 
 			// SA 
@@ -285,9 +291,16 @@ void System::setup_mpi_dataStructs( mpiData &md ) {
 	           * prev_molecule_ptr              = nullptr;
 
 
+	// choose the Ewald parameters again if the volume has drifted; the energy of the current state is
+	// then re-evaluated with them, so that it is the one the next move is measured against
+	if( ewald_tune_check() )
+		energy();
+
 	// save the current observables 
 	/////////////////////////////////////////////////////////////////////////////////////////////
 	std::memcpy( checkpoint->observables, observables, sizeof(observables_t) );
+	ewald_sf_accept();
+	axilrod_teller_accept();
 
 	// Count exchangeable and adiabatic molecules, then allocate an array whose size is 
 	// determined by said count. Populate the array with pointers to the molecules that
@@ -441,14 +454,9 @@ void System::setup_mpi_dataStructs( mpiData &md ) {
 
 				// if removing a molecule in a multi sorbate system, we also need to record the type
 				if(  num_insertion_molecules   &&   checkpoint->movetype == MOVETYPE_REMOVE  ) {
-					alt = 0;
-					for( int j=0; j<sorbateCount; j++ ) {
-						if ( SafeOps::iequals( sorbateInfo[j].id, ptr_array_exchange[altered]->moleculetype ) ) {
-							sorbateInsert = alt;
-							break;
-						}
-						alt++;
-					}
+					alt = sorbate_index( ptr_array_exchange[altered] );
+					if( alt >= 0 )
+						sorbateInsert = alt;
 				}	// multi-sorbate remove
 			} // MOVETYPE_DISPLACE / REMOVE / SPINFLIP / VOLUME
 		} //end non-adiabatic
@@ -656,14 +664,9 @@ int System::pick_Gibbs_move( std::vector<System*> &sys ) {
 
 				// if removing a molecule in a multi sorbate system, we also need to record the type
 				if (sys[i]->num_insertion_molecules   &&   sys[i]->checkpoint->movetype == MOVETYPE_REMOVE) {
-					alt = 0;
-					for (int j = 0; j<sys[i]->sorbateCount; j++) {
-						if (SafeOps::iequals(sys[i]->sorbateInfo[j].id, ptr_array_exchange[i][altered]->moleculetype)) {
-							sys[i]->sorbateInsert = alt;
-							break;
-						}
-						alt++;
-					}
+					alt = sys[i]->sorbate_index(ptr_array_exchange[i][altered]);
+					if (alt >= 0)
+						sys[i]->sorbateInsert = alt;
 				}	// multi-sorbate remove
 			} // MOVETYPE_DISPLACE / REMOVE / SPINFLIP / VOLUME
 		} //end non-adiabatic
@@ -745,9 +748,7 @@ void System::make_move() {
 	double      com [3]                = {0},
 	            rand[3]                = {0};
 	cavity_t  * cavities_array         = nullptr;
-	Molecule  * molecule_ptr           = nullptr;
 	Atom      * atom_ptr               = nullptr;
-	Pair      * pair_ptr               = nullptr;
 
 	// update the cavity grid prior to making a move 
 	if( cavity_bias ) {
@@ -831,18 +832,7 @@ void System::make_move() {
 			checkpoint->molecule_backup  = nullptr;
 
 			if( num_insertion_molecules ) { //multi sorbate
-				// Free all pair memory in the list
-				for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
-					for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
-						pair_ptr = atom_ptr->pairs;
-						while( pair_ptr ) {
-							Pair *temp = pair_ptr;
-							pair_ptr = pair_ptr->next;
-							free( temp );
-						}
-					}
-				}
-				// Generate new pairs lists for all atoms in system
+				// Generate new pairs lists for all atoms in system (the old lists are freed along the way)
 				allocate_pair_lists();
 			} // only one sorbate
 			else		
@@ -895,11 +885,13 @@ void System::make_move() {
 					displace( checkpoint->molecule_altered, pbc, move_factor, rot_factor );
 			} else
 				displace( checkpoint->molecule_altered, pbc, move_factor, rot_factor);
+			checkpoint->molecule_altered->dirty = 1;
 		break;
 
 		case MOVETYPE_ADIABATIC :
 			// change coords of 'altered' 
 			displace( checkpoint->molecule_altered, pbc, adiabatic_probability, 1.0 );
+			checkpoint->molecule_altered->dirty = 1;
 	
 		break;
 		case MOVETYPE_SPINFLIP :
@@ -927,6 +919,11 @@ void System::make_move() {
 			Output::err("MC_MOVES: invalid mc move\n");
 			throw invalid_monte_carlo_move;
 	}
+
+	// let the running Ewald structure factor, three-body energy and volume scaling sums know what changed
+	ewald_sf_move_made();
+	axilrod_teller_move_made();
+	volume_scale_move_made();
 }
 
 
@@ -947,7 +944,7 @@ void System::make_move_Gibbs(std::vector<System*> &sys) {
 
 		case MOVETYPE_DISPLACE:
 		
-			for( int i=0; i<2; i++ )
+			for( int i=0; i<2; i++ ) {
 				// change coords of 'altered' 
 				if( sys[i]->rd_anharmonic )
 					sys[i]->displace_1D( sys[i]->checkpoint->molecule_altered, sys[i]->move_factor );
@@ -963,6 +960,8 @@ void System::make_move_Gibbs(std::vector<System*> &sys) {
 				}
 				else
 					sys[i]->displace( sys[i]->checkpoint->molecule_altered, sys[i]->pbc, sys[i]->move_factor, sys[i]->rot_factor );
+				sys[i]->checkpoint->molecule_altered->dirty = 1;
+			}
 			break;
 			
 
@@ -990,9 +989,7 @@ void System::make_move_Gibbs(std::vector<System*> &sys) {
 				{
 
 					cavity_t  * cavities_array = nullptr;
-					Molecule  * molecule_ptr   = nullptr;
 					Atom      * atom_ptr       = nullptr;
-					Pair      * pair_ptr       = nullptr;
 
 					int         random_index           = 0;
 					double      com[3]                 = { 0 },
@@ -1081,18 +1078,7 @@ void System::make_move_Gibbs(std::vector<System*> &sys) {
 					sys[s]->checkpoint->molecule_backup = nullptr;
 
 					if (sys[s]->num_insertion_molecules) { //multi sorbate
-						// Free all pair memory in the list
-						for (molecule_ptr = sys[s]->molecules; molecule_ptr; molecule_ptr = molecule_ptr->next) {
-							for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
-								pair_ptr = atom_ptr->pairs;
-								while (pair_ptr) {
-									Pair *temp = pair_ptr;
-									pair_ptr = pair_ptr->next;
-									free(temp);
-								}
-							}
-						}
-						// Generate new pairs lists for all atoms in system
+						// Generate new pairs lists for all atoms in system (the old lists are freed along the way)
 						sys[s]->allocate_pair_lists();
 					} // only one sorbate
 					else
@@ -1283,6 +1269,9 @@ void System::volume_change() {
 		new_volume=exp( log_new_volume );
 	}
 
+	// single-site Lennard-Jones systems can take the trial energy from cached sums (System.VolumeScaling.cpp)
+	volume_scale_prepare( new_volume );
+
 	//scale basis
 	basis_scale_factor = pow(new_volume/pbc.volume,1.0/3.0);
 	for ( int i=0; i<3; i++ )
@@ -1308,6 +1297,9 @@ void System::volume_change() {
 		}
 	}		
 
+	// every separation has changed
+	pairs_sweep_all = 1;
+
 	return;
 }
 
@@ -1366,6 +1358,9 @@ void System::volume_change_Gibbs(std::vector<System*> &sys) {
 				}
 			}
 		}
+
+		// every separation has changed
+		sys[s]->pairs_sweep_all = 1;
 	}
 }
 
@@ -1542,6 +1537,8 @@ void System::restore() {
 	
 	// restore the remaining observables 
 	std::memcpy( observables, checkpoint->observables, sizeof(observables_t) );
+	ewald_sf_restore();
+	axilrod_teller_restore();
 
 	// restore state by undoing the steps of make_move()
 	switch ( checkpoint->movetype ) {
@@ -1596,9 +1593,10 @@ void System::restore() {
 			else
 				checkpoint->head->next = checkpoint->molecule_backup;
 			checkpoint->molecule_backup->next = checkpoint->tail;
-			// Delete the molecule configuration that was rejected. The pair list pointer is zeroed in order to keep
-			// the pair list intact as it was transferred to the accepted molecule and is needed. 
-			checkpoint->molecule_altered->wipe_pair_refs();
+			// the backup brings its own atoms and pair nodes, so its pairs must be revisited
+			checkpoint->molecule_backup->dirty = 1;
+			// Delete the molecule configuration that was rejected, along with its pair lists (the backup was
+			// given its own copies when it was made).
 			delete checkpoint->molecule_altered;
 			checkpoint->molecule_altered = nullptr;
 			// wipe "backup" reference, since this molecule is now linked into the system list
@@ -1620,45 +1618,11 @@ void System::restore() {
 
 void System::unupdate_pairs_insert() {
 // if an insert move is rejected, remove the pairs that were previously added
-	int        n            = 0,
-	           m            = 0;
-	Molecule * molecule_ptr = nullptr;
-	Atom     * atom_ptr     = nullptr;
-	Pair     * pair_ptr     = nullptr, 
-	        ** pair_array   = nullptr; 
-
-
-	// count the number of atoms per molecule
-	for(atom_ptr = checkpoint->molecule_altered->atoms; atom_ptr; atom_ptr = atom_ptr->next)
-		++n;
-
-	// remove n number of pairs for all molecules ahead of the removal point
-	SafeOps::calloc( pair_array, 1, sizeof(Pair *), __LINE__, __FILE__ );
-
-	for( molecule_ptr = molecules;   molecule_ptr != checkpoint->tail;   molecule_ptr = molecule_ptr->next ) {
-		for( atom_ptr = molecule_ptr->atoms;   atom_ptr;   atom_ptr = atom_ptr->next ) {
-
-			// build the pair pointer array
-			for( m=0, pair_ptr = atom_ptr->pairs;  pair_ptr;  pair_ptr = pair_ptr->next, m++ ) {
 
-				SafeOps::realloc( pair_array, sizeof(Pair *)*(m + 1), __LINE__, __FILE__ );
-				pair_array[m] = pair_ptr;
-			}
-
-			for( int i = (m - n); i < m; i++)
-				free(pair_array[i]);
-
-			// handle the end of the list
-			if((m - n) > 0)
-				pair_array[(m - n - 1)]->next = nullptr;
-			else
-				atom_ptr->pairs = nullptr;
+	pair_lists_changed = 1;
 
-		}
-	}
-
-	// free our temporary array
-	free(pair_array);
+	// remove the altered molecule's pairs for all molecules ahead of the removal point
+	resize_pair_rows( checkpoint->molecule_altered, checkpoint->tail, -1 );
 }
 
 
@@ -1668,46 +1632,10 @@ void System::unupdate_pairs_remove() {
 // if a remove is rejected and a molecule that was removed from the system has been added back
 // to the molecule list, then add back the number of pair nodes that were previously removed.
 
-	int         n            = 0;       // The number of atoms/sites in the molecule that is to be added.
-	Molecule  * molecule_ptr = nullptr;
-	Atom      * atom_ptr     = nullptr;
-	Pair      * pair_ptr     = nullptr;
-
-
-	// count the number of atoms per molecule
-	for( atom_ptr = checkpoint->molecule_backup->atoms; atom_ptr; atom_ptr = atom_ptr->next)
-		++n;
-
-	// add n number of pairs to altered and all molecules ahead of it in the list
-	for( molecule_ptr = molecules; molecule_ptr != checkpoint->molecule_backup; molecule_ptr = molecule_ptr->next ) {
-		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
-
-			// go to the end of the pair list
-			if( atom_ptr->pairs ) {
+	pair_lists_changed = 1;
 
-				// go to the end of the pair list 
-				for( pair_ptr = atom_ptr->pairs; pair_ptr->next; pair_ptr = pair_ptr->next);
-
-				// tag on the extra pairs
-				for( int i = 0; i < n; i++) {
-					SafeOps::calloc( pair_ptr->next, 1, sizeof(Pair), __LINE__, __FILE__ );
-					pair_ptr = pair_ptr->next;
-				}
-
-			} else {
-
-				// needs a new list
-				SafeOps::calloc( atom_ptr->pairs, 1, sizeof(Pair), __LINE__, __FILE__ );
-				pair_ptr = atom_ptr->pairs;
-				for( int i = 0; i < (n - 1); i++) {
-					SafeOps::calloc( pair_ptr->next, 1, sizeof(Pair), __LINE__, __FILE__ );
-					pair_ptr = pair_ptr->next;
-				}
-
-			}
-
-		} // for atom
-	} // for molecule
+	// add the backup molecule's pairs to all molecules ahead of it in the list
+	resize_pair_rows( checkpoint->molecule_backup, checkpoint->molecule_backup, 1 );
 }
 
 
@@ -1724,6 +1652,10 @@ void System::revert_volume_change() {
 	            delta_pos[3]       = {0};
 	
 	// int i,j;
+
+	// put back exactly, if the trial energy came from the scaled sums
+	if( volume_scale_restore() )
+		return;
 	
 	for ( int i=0; i<3; i++ )
 		for ( int j=0; j<3; j++ )
@@ -1749,6 +1681,9 @@ void System::revert_volume_change() {
 		}
 	}
 
+	// every separation has changed
+	pairs_sweep_all = 1;
+
 	return;
 }
 
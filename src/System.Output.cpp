@@ -696,8 +696,8 @@ void System::write_states() {
 
 			fprintf(fp, "ATOM  ");
 			fprintf(fp, "%5d", i);		// give each one a unique id
-			fprintf(fp, " %-4.45s", atom_ptr->atomtype);
-			fprintf(fp, " %-3.3s ", molecule_ptr->moleculetype);
+			fprintf(fp, " %-4.45s", atom_ptr->atomtype());
+			fprintf(fp, " %-3.3s ", molecule_ptr->moleculetype());
 			if(atom_ptr->adiabatic)
 				fprintf(fp, "%-1.1s", "A");
 			else if(atom_ptr->frozen)
@@ -859,7 +859,7 @@ void System::write_molecules_xyz(FILE* fp)
 	fprintf(fp, "%d\n\n", countNatoms());
 	for (molecule_ptr = molecules, i = 1, j = 1; molecule_ptr; molecule_ptr = molecule_ptr->next, j++) {
 		for (atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next, i++) {
-			fprintf(fp, " %-4.45s", atom_ptr->atomtype);
+			fprintf(fp, " %-4.45s", atom_ptr->atomtype());
 			/* Regular (PDB compliant) Coordinate Output */
 			if (wrapall)
 			{
@@ -931,8 +931,8 @@ int System::write_molecules(FILE * fp) {
 
 			fprintf(fp, "ATOM  ");
 			fprintf(fp, "%5d", i);		/* give each one a unique id */
-			fprintf(fp, " %-4.45s", atom_ptr->atomtype);
-			fprintf(fp, " %-3.3s ", molecule_ptr->moleculetype);
+			fprintf(fp, " %-4.45s", atom_ptr->atomtype());
+			fprintf(fp, " %-3.3s ", molecule_ptr->moleculetype());
 			if(atom_ptr->adiabatic)
 				fprintf(fp, "%-1.1s", "A");
 			else if(atom_ptr->frozen)
@@ -1226,6 +1226,7 @@ int System::write_performance( int i ) {
 	char       linebuf[maxLine] = {'\0'};
 	double     sec_step         = 0;
 	static int last_step        = 0;
+	static int last_rebuilds    = 0;
 
 	Output::GetTimeOfDay( &current_time );
 	
@@ -1254,9 +1255,16 @@ int System::write_performance( int i ) {
 		sprintf(linebuf, "OUTPUT: %.3lf sec/step, ETA = %.3lf hrs\n", sec_step, sec_step*(numsteps - i)/3600.0);
 		Output::out( linebuf );
 
+		if( verlet_list ) {
+			int rebuilds = verlet_list_rebuilds - last_rebuilds;
+			sprintf(linebuf, "OUTPUT: %d Verlet list rebuilds (%.3lf per step)\n", rebuilds, rebuilds / ((double)(i - last_step)));
+			Output::out( linebuf );
+		}
+
 	}	
 
 	last_step = i;
+	last_rebuilds = verlet_list_rebuilds;
 	last_time.tv_sec = current_time.tv_sec;
 	last_time.tv_usec = current_time.tv_usec;
 
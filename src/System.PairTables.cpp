@@ -0,0 +1,184 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Output.h"
+#include "Pair.h"
+#include "SafeOps.h"
+#include "SplineTable.h"
+#include "System.h"
+
+
+
+// Tabulated pair kernels for the analytic repulsion/dispersion models.
+//
+// sg(), disp_expansion() (with its Tang-Toennies damping), dreiding(), lj_buffered_14_7() and
+// exp_repulsion() evaluate a closed form of the pair separation for every pair they recompute, and
+// sg() a second one for its Feynman-Hibbs correction. Each of those forms is a static *_kernel()
+// function of r and a PAIR_KERNEL_* parameter array, and depends on nothing but the mixed parameters
+// of the pair's two atoms, i.e. on their mixing types (see System.MixingTable.cpp). With
+// pair_table_tolerance set, pair_tables_init() picks the kernels of the configured model, and
+// pair_table_lookup() tabulates each of them per pair of mixing types, the first time that pair of
+// types is seen, as a SplineTable on [r_start, cutoff) accurate to pair_table_tolerance (the
+// Feynman-Hibbs tables to that tolerance before their temperature/mass prefactor is applied).
+// r_start is where the kernel, coming in from the cutoff, first exceeds pair_table_energy_max;
+// pairs closer than that, or beyond the cutoff the table was made for, are evaluated directly.
+//
+// Kernels without a simple derivative get their slopes by differences (see SplineTable::build()).
+
+static const double pair_table_energy_max = 1.0e5;   // K; the tables stop short of the hard core
+static const int    pair_table_scan_steps = 4096;    // resolution of the search for r_start
+
+
+
+
+static void report( int kind, int t, int u, const SplineTable &table ) {
+
+	char linebuf[maxLine];
+
+	sprintf( linebuf, "SYSTEM: pair table (%s) for mixing types %d,%d: %d segments on [%g, %g), spacing %.3e, max error %.2e\n",
+	         (kind == PAIR_TABLE_FH) ? "Feynman-Hibbs" : "energy", t, u, table.intervals, table.x_min, table.x_max, table.spacing, table.max_error );
+	Output::out1( linebuf );
+}
+
+
+
+
+void System::pair_tables_init() {
+// Choose the kernels to tabulate for the configured model, if pair_table_tolerance asks for tables.
+// The tables themselves are made by pair_table_lookup(), as pairs of mixing types turn up.
+
+	pair_tables_free();
+	for( int k = 0; k < PAIR_TABLE_KINDS; k++ )
+		pair_table_kernel[k] = nullptr;
+
+	if( pair_table_tolerance <= 0 )
+		return;
+
+	// the same precedence as energy()
+	if( rd_anharmonic )
+		;
+	else if( use_sg ) {
+		pair_table_kernel[PAIR_TABLE_ENERGY] = sg_kernel;
+		if( feynman_hibbs )
+			pair_table_kernel[PAIR_TABLE_FH] = sg_fh_kernel;
+	}
+	else if( use_dreiding )
+		pair_table_kernel[PAIR_TABLE_ENERGY] = dreiding_kernel;
+	else if( using_lj_buffered_14_7 )
+		pair_table_kernel[PAIR_TABLE_ENERGY] = lj_buffered_14_7_kernel;
+	else if( using_disp_expansion )
+		pair_table_kernel[PAIR_TABLE_ENERGY] = disp_expansion_kernel;
+	else if( cdvdw_exp_repulsion )
+		pair_table_kernel[PAIR_TABLE_ENERGY] = exp_repulsion_kernel;
+
+	if( pair_table_kernel[PAIR_TABLE_ENERGY] )
+		Output::out1( "SYSTEM: pair kernels will be tabulated per pair of mixing types.\n" );
+	else
+		Output::out1( "SYSTEM: pair_table_tolerance is set, but the repulsion/dispersion model has no tabulated kernel.\n" );
+}
+
+
+
+
+void System::pair_tables_reserve( int ntypes ) {
+// Lay the tables out for (at least) ntypes mixing types, keeping the ones already made.
+
+	int          n     = (ntypes > 2*pair_table_ntypes) ? ntypes : 2*pair_table_ntypes;  // types tend to arrive one at a time
+	SplineTable *table = new SplineTable[ n * n * PAIR_TABLE_KINDS ];
+	signed char *state = nullptr;
+
+	SafeOps::calloc( state, n * n * PAIR_TABLE_KINDS, sizeof(signed char), __LINE__, __FILE__ );
+
+	for( int t = 0; t < pair_table_ntypes; t++ )
+		for( int u = t; u < pair_table_ntypes; u++ )
+			for( int k = 0; k < PAIR_TABLE_KINDS; k++ ) {
+				int from = (t*pair_table_ntypes + u)*PAIR_TABLE_KINDS + k,
+				    to   = (t*n + u)*PAIR_TABLE_KINDS + k;
+				table[to] = pair_tables[from];
+				state[to] = pair_table_state[from];
+			}
+
+	delete [] pair_tables;
+	if( pair_table_state ) free( pair_table_state );
+
+	pair_tables       = table;
+	pair_table_state  = state;
+	pair_table_ntypes = n;
+}
+
+
+
+
+bool System::pair_table_make( int kind, int t, int u, double cutoff ) {
+// Tabulate a kernel for mixing types t <= u over [r_start, cutoff). Returns false (and leaves the
+// pair of types to be evaluated directly) if the tolerance can't be met.
+
+	char                  linebuf[maxLine];
+	int                   i      = (t*pair_table_ntypes + u)*PAIR_TABLE_KINDS + kind;
+	SplineTable          &table  = pair_tables[i];
+	SplineTable::function energy = pair_table_kernel[PAIR_TABLE_ENERGY];
+	double                param[PAIR_KERNEL_NPARAMS],
+	                      dr     = cutoff / pair_table_scan_steps,
+	                      r_start;
+
+	pair_kernel_params( &mixing_table[ t * mixing_ntypes + u ], param );
+
+	// every kind of table for t,u starts where the energy passes pair_table_energy_max
+	r_start = cutoff;
+	while( (r_start - dr > dr)  &&  (fabs(energy(r_start - dr, param)) <= pair_table_energy_max) )
+		r_start -= dr;
+
+	if( (r_start >= cutoff)  ||  !table.build(pair_table_kernel[kind], nullptr, param, r_start, cutoff, pair_table_tolerance) ) {
+		sprintf( linebuf, "SYSTEM: pair table for mixing types %d,%d cannot reach a tolerance of %.2e (best %.2e); those pairs will be evaluated directly\n",
+		         t, u, pair_table_tolerance, table.max_error );
+		Output::out1( linebuf );
+		table.clear();
+		pair_table_state[i] = -1;
+		return false;
+	}
+
+	report( kind, t, u, table );
+	pair_table_state[i] = 1;
+	return true;
+}
+
+
+
+
+void System::pair_tables_free() {
+
+	delete [] pair_tables;
+	if( pair_table_state ) free( pair_table_state );
+
+	pair_tables       = nullptr;
+	pair_table_state  = nullptr;
+	pair_table_ntypes = 0;
+}
+
+
+
+
+void System::pair_kernel_params( const Pair *pair_ptr, double *param ) {
+// The PAIR_KERNEL_* parameters of a pair (or of a mixing_table entry).
+
+	param[PAIR_KERNEL_SIGMA]           = pair_ptr->sigma;
+	param[PAIR_KERNEL_EPSILON]         = pair_ptr->epsilon;
+	param[PAIR_KERNEL_C6]              = disp_expansion_mbvdw ? 0.0 : pair_ptr->c6;  // the many-body vdw has the C6 term
+	param[PAIR_KERNEL_C8]              = pair_ptr->c8;
+	param[PAIR_KERNEL_C10]             = pair_ptr->c10;
+	param[PAIR_KERNEL_ATTRACTIVE_ONLY] = pair_ptr->attractive_only;
+	param[PAIR_KERNEL_DAMPING]         = damp_dispersion;
+}
+
+
+
+
+double System::pair_kernel( SplineTable::function kernel, const Pair *pair_ptr, double r ) {
+// A kernel evaluated directly, for a pair that has no table (or lies outside of it).
+
+	double param[PAIR_KERNEL_NPARAMS];
+
+	pair_kernel_params( pair_ptr, param );
+	return kernel( r, param );
+}
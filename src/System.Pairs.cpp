@@ -12,38 +12,45 @@
 
 
 
-// Allocate a series of linked lists cataloging pairs of sites, one entry per pair
-//   E.g., pair linked list for A, B, C & D:
+// Allocate a series of pair lists cataloging pairs of sites, one entry per pair
+//   E.g., pair list for A, B, C & D:
 //     pairs[0]: B-> C-> D
 //     pairs[1]: C-> D
 //     pairs[2]: D
+// Each atom's list is a contiguous array (see Atom::resize_pairs()), so the pair between atom_array[i]
+// and atom_array[j], j > i, is simply atom_array[i]->pairs[j - i - 1].
+//
+// Pairs between two frozen atoms contribute nothing to the energy unless the frozen atoms' own
+// dipoles or positions enter into it (polarization, many-body vdW) or a kernel that does not skip
+// frozen pairs is in use. Otherwise they are not stored at all: the list of a frozen atom holds only
+// its pairs with the non-frozen atoms that follow it, and is indexed through pairs_mobile_before.
 
 void System::allocate_pair_lists() {
 
-	Pair *pair_ptr, *prev_pair_ptr;
+	int n_mobile = 0;
 
 	natoms = countNatoms();
+	pair_lists_changed = 1;
+
+	skip_frozen_pairs = !( polarization || polarvdw || use_sg || spectre || gwp );
 
 	// build atom and molecule arrays for easy-access references
 	rebuild_arrays();
 	int n = natoms;
 
 	// setup the pairs, top-right triangle (analogous to an upper/lower triangle matrix)
-	for(int i = 0; i < (n - 1); i++) {
-
-		SafeOps::calloc( atom_array[i]->pairs, 1, sizeof(Pair), __LINE__, __FILE__ );
-		pair_ptr = atom_array[i]->pairs;
-		prev_pair_ptr = pair_ptr;
-
-		for(int j = (i + 1); j < n; j++) {
-			SafeOps::calloc(pair_ptr->next, 1, sizeof(Pair), __LINE__, __FILE__ );
-			prev_pair_ptr = pair_ptr;
-			pair_ptr = pair_ptr->next;
-		}
-
-		prev_pair_ptr->next = nullptr;
-		free(pair_ptr);
+	for(int i = n - 1; i >= 0; i--) {
+		atom_array[i]->free_pairs();
+		if( skip_frozen_pairs && atom_array[i]->frozen )
+			atom_array[i]->resize_pairs( n_mobile );
+		else
+			atom_array[i]->resize_pairs( n - i - 1 );
+		if( ! atom_array[i]->frozen )
+			n_mobile++;
 	}
+
+	// intern the atom types for the exclusion/mixing table
+	mixing_table_reset();
 }
 
 
@@ -52,45 +59,10 @@ void System::allocate_pair_lists() {
 // add new pairs for when a new molecule is created */
 void System::update_pairs_insert() {
 
-	int         n = 0;
-	Molecule  * molecule_ptr;
-	Atom      * atom_ptr;
-	Pair      * pair_ptr;
-
-
-	// count the number of atoms per molecule
-	for( atom_ptr = checkpoint->molecule_altered->atoms; atom_ptr; atom_ptr = atom_ptr->next, n++);
-
-	// add n number of pairs to altered and all molecules ahead of it in the list
- 	for(molecule_ptr = molecules; molecule_ptr != checkpoint->tail; molecule_ptr = molecule_ptr->next) {
-		for(atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
-
-			// go to the end of the pair list
-			if(atom_ptr->pairs) {
-
-				// go to the end of the pair list
-				for(pair_ptr = atom_ptr->pairs; pair_ptr->next; pair_ptr = pair_ptr->next);
+	pair_lists_changed = 1;
 
-				// tag on the extra pairs
-				for(int i = 0; i < n; i++) {
-					SafeOps::calloc( pair_ptr->next, 1, sizeof(Pair), __LINE__, __FILE__);
-					pair_ptr = pair_ptr->next;
-				}
-
-			} else {
-
-				// needs a new list
-				SafeOps::calloc( atom_ptr->pairs, 1, sizeof(Pair), __LINE__, __FILE__ );
-				pair_ptr = atom_ptr->pairs;
-				for( int i = 0; i < (n - 1); i++) {
-					SafeOps::calloc( pair_ptr->next, 1, sizeof(Pair), __LINE__, __FILE__ );
-					pair_ptr = pair_ptr->next;
-				}
-
-			}
-
-		} // for atom 
-	} // for molecule
+	// add pairs with the new atoms to altered and all molecules ahead of it in the list
+	resize_pair_rows( checkpoint->molecule_altered, checkpoint->tail, 1 );
 }
 
 
@@ -100,53 +72,45 @@ void System::update_pairs_insert() {
 void System::update_pairs_remove() {
 
 	// When removing a molecule from the system, the number of atom-atom pairs in the system will
-	// be reduced and so the quantity of Pair nodes required to document these pairings is likewise reduced. 
-	// This function removes nodes from the atomic Pair lists of those atoms that will require fewer Pairs post-
+	// be reduced and so the quantity of Pair entries required to document these pairings is likewise reduced. 
+	// This function truncates the Pair lists of those atoms that will require fewer Pairs post-
 	// molecule-removal. The references stored in each pair list are no longer valid as references to the removed
-	// atoms are kept and references to extant atoms are deleted. Only the quantity of Pair nodes is
-	// adjusted, and these nodes will have to be re-populated with valid data at a later time. 
-
-	int         n            = 0,       // the number of atoms (or sites) in the removed molecule
-		        nPairs       = 0;       // A counter for Pair nodes in a given Pair list
-	Molecule  * molecule_ptr = nullptr;
-	Atom      * atom_ptr     = nullptr;
-	Pair      * pair_ptr     = nullptr,
-	         ** pair_array   = nullptr;
+	// atoms are kept and references to extant atoms are deleted. Only the quantity of Pair entries is
+	// adjusted, and these entries will have to be re-populated with valid data at a later time. 
 
+	pair_lists_changed = 1;
 
-	// count the number of atoms in the "backup" molecule, store result in n
-	for( atom_ptr = checkpoint->molecule_backup->atoms, n=0; atom_ptr; atom_ptr = atom_ptr->next)
-		++n;
+	// remove the "backup" molecule's Pair entries from the end of the Pair list for all molecules appearing
+	// before the molecule that is to be (or was) removed
+	resize_pair_rows( checkpoint->molecule_backup, checkpoint->tail, -1 );
+}
 
-	// remove n Pair nodes, from the Pair list for all molecules appearing before the Pair nodes
-	// that reference the atoms in the molecule to be removed. 
 
-	// Create an array for easy reference to the Pair nodes for the Pair list in question
-	SafeOps::calloc( pair_array, 1, sizeof(Pair *), __LINE__, __FILE__ );
 
-	for( molecule_ptr = molecules; molecule_ptr != checkpoint->tail; molecule_ptr = molecule_ptr->next) {
-	// We only examine the molecules that appear (or appeared) before the molecule that is to be (or was) removed
-		for(atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
-			for( pair_ptr = atom_ptr->pairs, nPairs = 0; pair_ptr; pair_ptr = pair_ptr->next, nPairs++) {
-				// update array length to reflect most current node count
-				SafeOps::realloc( pair_array, sizeof(Pair *)*(nPairs + 1), __LINE__, __FILE__ ); 
-				pair_array[nPairs] = pair_ptr; 
-			}
 
-			// delete n nodes from the end of the Pair list
-			for(int i = (nPairs - n); i < nPairs; i++)
-				free(pair_array[i]);
+void System::resize_pair_rows( Molecule *molecule, Molecule *stop, int sign ) {
+// Grow (sign > 0) or shrink (sign < 0) the pair list of every atom in the molecules preceding stop
+// by the number of pairs that atom forms with the atoms of molecule. The molecule's atoms are counted
+// in (or out of) lrc_type_count, and the molecule into (or out of) es_intra_count, along the way.
 
-			// Terminate the newly truncated Pair list
-			if((nPairs - n) > 0)
-				pair_array[(nPairs - n - 1)]->next = nullptr;
-			else
-				atom_ptr->pairs = nullptr;
+	int         n        = 0,       // the number of atoms (or sites) in molecule
+	            n_mobile = 0;       // ...of which are not frozen
+	Molecule  * molecule_ptr;
+	Atom      * atom_ptr;
 
-		}
+	for( atom_ptr = molecule->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+		++n;
+		if( ! atom_ptr->frozen )
+			++n_mobile;
 	}
 
-	// free our temporary array
-	free(pair_array);
+	// a molecule entering the system needs its atoms' mixing types
+	if( sign > 0 )
+		mixing_types_assign( molecule );
+	lrc_counts_add( molecule, sign );
+	es_intra_counts_add( molecule, sign );
 
-}
\ No newline at end of file
+	for( molecule_ptr = molecules; molecule_ptr != stop; molecule_ptr = molecule_ptr->next )
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			atom_ptr->resize_pairs( atom_ptr->pairs_count + sign * ((skip_frozen_pairs && atom_ptr->frozen) ? n_mobile : n) );
+}
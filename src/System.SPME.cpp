@@ -0,0 +1,540 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Atom.h"
+#include "FFT.h"
+#include "Molecule.h"
+#include "Output.h"
+#include "SafeOps.h"
+#include "System.h"
+
+
+
+// Smooth particle-mesh Ewald (Essmann et al., J. Chem. Phys. 103, 8577 (1995)).
+//
+// With ewald_spme on, coulombic_reciprocal() no longer sums over the k-vectors explicitly. Each
+// mobile charge is spread onto a mesh over the unit cell with cardinal B-splines of order
+// spme_order, in fractional coordinates s_q = (column q of reciprocal_basis).r, so triclinic cells
+// need nothing extra. The structure factor is then S(k) ~ b(m) F[Q](m), with F the discrete Fourier
+// transform of the mesh and b(m) the B-spline Euler factors, and the energy is
+//
+//   E = (2 pi/V) sum_{m != 0} exp(-k^2/(4 alpha^2))/k^2 |b(m)|^2 |F[Q](m)|^2 ,    k = 2 pi reciprocal_basis m
+//
+// which costs O(N p^3 + M log M) for N charges and M mesh points, instead of O(N K).
+//
+// Full Ewald polarization goes through the same mesh. With conv = F^-1[ G F[Q] ], for influence
+// function G (made with polar_ewald_alpha), the potential of whatever Q describes is
+// phi(r_j) = 2 sum_g theta_j(g) conv(g), and the field at atom j is minus its gradient, which only
+// needs the derivatives of atom j's B-spline weights. recip_term() spreads the charges and
+// induced_recip_term() spreads the dipoles, Q(g) = sum_j mu_j . grad theta_j(g); the field then costs
+// two FFTs and O(N p^3) per self-consistent iteration, instead of O(N K).
+//
+// The mesh and spline order are chosen from ewald_alpha (or polar_ewald_alpha, if larger and
+// polarization is on) and ewald_spme_tolerance: the order rises as the tolerance falls, and the mesh
+// is made fine enough that, for every k it resolves, the Gaussian factor times the leading aliasing
+// error of the splines, 2 (f/(2-f))^p with f = k/k_Nyquist, is within the tolerance. Everything is
+// remade when the cell changes, as with the k-vectors.
+
+static const int spme_orders_max = 8;
+
+
+
+
+static int spline_order( double tolerance ) {
+	if( tolerance >= 1.0e-4 )
+		return 4;
+	if( tolerance >= 1.0e-6 )
+		return 6;
+	return spme_orders_max;
+}
+
+
+
+
+static double mesh_cutoff( double alpha, double tolerance, int order ) {
+// The Nyquist wavenumber the mesh needs: the smallest for which the Gaussian factor times the
+// aliasing error is within the tolerance at every k it resolves (and beyond, where f = 1).
+
+	double k_nyquist = 2.0 * alpha * sqrt( -log(tolerance) ),
+	       f, error, worst;
+
+	for( ; ; k_nyquist *= 1.02 ) {
+		worst = 0;
+		for( int i = 1; i <= 100; i++ ) {
+			f     = 0.01 * i;
+			error = exp( -f*k_nyquist*f*k_nyquist / (4.0*alpha*alpha) ) * 2.0 * pow( f/(2.0 - f), order );
+			if( error > worst )
+				worst = error;
+		}
+		if( worst <= tolerance )
+			return k_nyquist;
+	}
+}
+
+
+
+
+static void bspline_fill( double w, int order, double *theta ) {
+// theta[i] = M_order(w + order - 1 - i), the weight of the (order-1-i)-th mesh point below, for
+// 0 <= w < 1. The recursion raises the order one step at a time, starting from the hat function.
+
+	double div;
+
+	theta[order - 1] = 0;
+	theta[1]         = w;
+	theta[0]         = 1.0 - w;
+
+	for( int j = 3; j <= order; j++ ) {
+		div          = 1.0 / (j - 1);
+		theta[j - 1] = div * w * theta[j - 2];
+		for( int k = 1; k <= j - 2; k++ )
+			theta[j - k - 1] = div * ((w + k) * theta[j - k - 2] + (j - k - w) * theta[j - k - 1]);
+		theta[0] = div * (1.0 - w) * theta[0];
+	}
+}
+
+
+
+
+static void bspline_derivatives( double w, int order, double *dtheta ) {
+// dtheta[i] = d theta[i]/dw, from M_n'(x) = M_{n-1}(x) - M_{n-1}(x-1).
+
+	double M[spme_orders_max];
+
+	bspline_fill( w, order - 1, M );
+
+	dtheta[0] = -M[0];
+	for( int i = 1; i < order - 1; i++ )
+		dtheta[i] = M[i - 1] - M[i];
+	dtheta[order - 1] = M[order - 2];
+}
+
+
+
+
+static void influence_function( double *G, const int *grid, double basis[3][3], double volume, double alpha, double * const *mod ) {
+// G(g) = (2 pi/V) exp(-k^2/(4 alpha^2))/k^2 |b(m)|^2, with the mesh index g standing for the
+// frequency m = g or g - K.
+
+	double k[3], k2;
+
+	for( int g0 = 0; g0 < grid[0]; g0++ ) {
+		int m0 = (2*g0 <= grid[0]) ? g0 : g0 - grid[0];
+		for( int g1 = 0; g1 < grid[1]; g1++ ) {
+			int m1 = (2*g1 <= grid[1]) ? g1 : g1 - grid[1];
+			for( int g2 = 0; g2 < grid[2]; g2++ ) {
+				int m2 = (2*g2 <= grid[2]) ? g2 : g2 - grid[2],
+				    g  = (g0*grid[1] + g1)*grid[2] + g2;
+
+				if( !m0 && !m1 && !m2 ) {
+					G[g] = 0;
+					continue;
+				}
+				for( int p = 0; p < 3; p++ )
+					k[p] = 2.0 * pi * (basis[p][0]*m0 + basis[p][1]*m1 + basis[p][2]*m2);
+				k2 = k[0]*k[0] + k[1]*k[1] + k[2]*k[2];
+
+				G[g] = 2.0 * pi / volume * exp( -k2 / (4.0*alpha*alpha) ) / k2 * mod[0][g0] * mod[1][g1] * mod[2][g2];
+			}
+		}
+	}
+}
+
+
+
+
+static void bspline_moduli( int order, int K, double *mod ) {
+// |b(m)|^2 = 1 / |sum_{k=0}^{order-2} M_order(k+1) e^{2 pi i m k/K}|^2 for m = 0..K-1.
+
+	double M[spme_orders_max], re, im, arg;
+
+	bspline_fill( 0.0, order, M );  // M[i] = M_order(order - 1 - i)
+
+	for( int m = 0; m < K; m++ ) {
+		re = 0;
+		im = 0;
+		for( int k = 0; k <= order - 2; k++ ) {
+			arg = 2.0 * pi * m * k / K;
+			re += M[order - 2 - k] * cos( arg );
+			im += M[order - 2 - k] * sin( arg );
+		}
+		mod[m] = re*re + im*im;
+	}
+
+	// for odd orders the sum vanishes at the Nyquist frequency; use the neighbours there
+	for( int m = 0; m < K; m++ )
+		if( mod[m] < 1.0e-10 )
+			mod[m] = 0.5 * (mod[(m + K - 1) % K] + mod[(m + 1) % K]);
+
+	for( int m = 0; m < K; m++ )
+		mod[m] = 1.0 / mod[m];
+}
+
+
+
+
+void System::spme_update() {
+// Choose the mesh and spline order for the current cell and remake the influence function, if
+// anything they depend on has changed since they were made.
+
+	char     linebuf[maxLine];
+	int      grid[3],
+	         order,
+	         points;
+	double   k_nyquist, length,
+	         alpha = ewald_alpha,
+	       * mod[3];
+
+	if(   spme_order
+	   && (spme_alpha == ewald_alpha)
+	   && (spme_polar_alpha == polar_ewald_alpha)
+	   && (spme_tolerance == ewald_spme_tolerance)
+	   && ! memcmp( spme_basis, pbc.reciprocal_basis, sizeof(spme_basis) )
+	)
+		return;
+
+	// the mesh has to resolve whichever Gaussian is narrower in k-space
+	if( polarization  &&  (polar_ewald_alpha > alpha) )
+		alpha = polar_ewald_alpha;
+
+	order     = spline_order( ewald_spme_tolerance );
+	k_nyquist = mesh_cutoff( alpha, ewald_spme_tolerance, order );
+	for( int q = 0; q < 3; q++ ) {
+		length  = sqrt( pbc.basis[q][0]*pbc.basis[q][0] + pbc.basis[q][1]*pbc.basis[q][1] + pbc.basis[q][2]*pbc.basis[q][2] );
+		grid[q] = (int) ceil( length * k_nyquist / pi );
+		grid[q] = FFT::good_size( (grid[q] > 2*order) ? grid[q] : 2*order );
+	}
+
+	if( (order != spme_order)  ||  ! spme_fft.planned( grid[0], grid[1], grid[2] ) ) {
+		sprintf( linebuf, "SYSTEM: SPME mesh %d x %d x %d, B-spline order %d\n", grid[0], grid[1], grid[2], order );
+		Output::out1( linebuf );
+	}
+
+	if( ! spme_fft.planned( grid[0], grid[1], grid[2] ) ) {
+		spme_fft.plan( grid[0], grid[1], grid[2] );
+		points = grid[0] * grid[1] * grid[2];
+		SafeOps::realloc( spme_mesh,            2 * points * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( spme_influence,           points * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( spme_polar_influence,     points * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( spme_bsp_mod,         (grid[0] + grid[1] + grid[2]) * sizeof(double), __LINE__, __FILE__ );
+	}
+
+	spme_order = order;
+	for( int q = 0; q < 3; q++ )
+		spme_grid[q] = grid[q];
+
+	mod[0] = spme_bsp_mod;
+	mod[1] = mod[0] + grid[0];
+	mod[2] = mod[1] + grid[1];
+	for( int q = 0; q < 3; q++ )
+		bspline_moduli( order, grid[q], mod[q] );
+
+	influence_function( spme_influence,       grid, pbc.reciprocal_basis, pbc.volume, ewald_alpha,       mod );
+	influence_function( spme_polar_influence, grid, pbc.reciprocal_basis, pbc.volume, polar_ewald_alpha, mod );
+
+	spme_alpha       = ewald_alpha;
+	spme_polar_alpha = polar_ewald_alpha;
+	spme_tolerance   = ewald_spme_tolerance;
+	memcpy( spme_basis, pbc.reciprocal_basis, sizeof(spme_basis) );
+}
+
+
+
+
+int System::spme_splines( bool charged_only, bool derivatives ) {
+// Collect the atoms that go onto the mesh (only the mobile, charged ones with charged_only) into
+// spme_atom, with the mesh index their weights start at and the weights themselves (and their
+// derivatives, if asked for) along each axis. Returns the number of atoms collected.
+
+	Molecule * molecule_ptr;
+	Atom     * atom_ptr;
+	int        order = spme_order,
+	           n     = 0,
+	           base;
+	double     s, u;
+
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next )
+			n++;
+
+	if( n > spme_allocd ) {
+		spme_allocd = n;
+		SafeOps::realloc( spme_atom,   spme_allocd * sizeof(Atom *),                       __LINE__, __FILE__ );
+		SafeOps::realloc( spme_base,   spme_allocd * 3 * sizeof(int),                      __LINE__, __FILE__ );
+		SafeOps::realloc( spme_theta,  spme_allocd * 3 * spme_orders_max * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( spme_dtheta, spme_allocd * 3 * spme_orders_max * sizeof(double), __LINE__, __FILE__ );
+	}
+
+	n = 0;
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+
+			if( charged_only  &&  (atom_ptr->frozen || (atom_ptr->charge == 0.0)) )
+				continue;
+
+			for( int q = 0; q < 3; q++ ) {
+				s  = spme_basis[0][q]*atom_ptr->pos[0] + spme_basis[1][q]*atom_ptr->pos[1] + spme_basis[2][q]*atom_ptr->pos[2];
+				s -= floor( s );
+				u  = s * spme_grid[q];
+				base = (int) u;
+				bspline_fill( u - base, order, spme_theta + (3*n + q)*order );
+				if( derivatives )
+					bspline_derivatives( u - base, order, spme_dtheta + (3*n + q)*order );
+
+				// theta[i] belongs to mesh point base - order + 1 + i
+				base += 1 - order;
+				while( base < 0 )
+					base += spme_grid[q];
+				while( base >= spme_grid[q] )
+					base -= spme_grid[q];
+				spme_base[3*n + q] = base;
+			}
+			spme_atom[n++] = atom_ptr;
+		}
+	}
+
+	spme_natoms = n;
+	return n;
+}
+
+
+
+
+void System::spme_spread_charges() {
+// Q(g) = sum_j q_j prod_q M(u_jq - g_q), for the atoms collected by spme_splines().
+
+	int            order  = spme_order,
+	               K1     = spme_grid[1],
+	               K2     = spme_grid[2],
+	               g0, g1, g2, row;
+	const double * theta;
+	double         w0, w01;
+
+	memset( spme_mesh, 0, 2 * spme_grid[0] * K1 * K2 * sizeof(double) );
+
+	for( int j = 0; j < spme_natoms; j++ ) {
+		theta = spme_theta + 3*j*order;
+		g0    = spme_base[3*j];
+		for( int i0 = 0; i0 < order; i0++, g0++ ) {
+			if( g0 == spme_grid[0] ) g0 = 0;
+			w0 = spme_atom[j]->charge * theta[i0];
+			g1 = spme_base[3*j + 1];
+			for( int i1 = 0; i1 < order; i1++, g1++ ) {
+				if( g1 == K1 ) g1 = 0;
+				w01 = w0 * theta[order + i1];
+				row = (g0*K1 + g1) * K2;
+				g2  = spme_base[3*j + 2];
+				for( int i2 = 0; i2 < order; i2++, g2++ ) {
+					if( g2 == K2 ) g2 = 0;
+					spme_mesh[2*(row + g2)] += w01 * theta[2*order + i2];
+				}
+			}
+		}
+	}
+}
+
+
+
+
+double System::spme_reciprocal() {
+// The reciprocal-space energy of the mobile charges, from the mesh.
+
+	int    points;
+	double potential = 0;
+
+	spme_update();
+	spme_splines( true );
+	spme_spread_charges();
+	spme_fft.forward( spme_mesh );
+
+	points = spme_grid[0] * spme_grid[1] * spme_grid[2];
+	for( int g = 0; g < points; g++ )
+		potential += spme_influence[g] * (spme_mesh[2*g]*spme_mesh[2*g] + spme_mesh[2*g + 1]*spme_mesh[2*g + 1]);
+
+	return potential;
+}
+
+
+
+
+void System::spme_spread_dipoles() {
+// Q(g) = sum_j mu_j . grad theta_j(g), for the atoms collected by spme_splines() with derivatives.
+
+	int            order  = spme_order,
+	               K1     = spme_grid[1],
+	               K2     = spme_grid[2],
+	               g0, g1, g2, row;
+	const double * theta, * dtheta;
+	double         mu[3];  // mu . grad u_q
+
+	memset( spme_mesh, 0, 2 * spme_grid[0] * K1 * K2 * sizeof(double) );
+
+	for( int j = 0; j < spme_natoms; j++ ) {
+		for( int q = 0; q < 3; q++ )
+			mu[q] = spme_grid[q] * (spme_basis[0][q]*spme_atom[j]->mu[0] + spme_basis[1][q]*spme_atom[j]->mu[1] + spme_basis[2][q]*spme_atom[j]->mu[2]);
+		if( !mu[0] && !mu[1] && !mu[2] )
+			continue;
+
+		theta  = spme_theta  + 3*j*order;
+		dtheta = spme_dtheta + 3*j*order;
+		g0     = spme_base[3*j];
+		for( int i0 = 0; i0 < order; i0++, g0++ ) {
+			if( g0 == spme_grid[0] ) g0 = 0;
+			g1 = spme_base[3*j + 1];
+			for( int i1 = 0; i1 < order; i1++, g1++ ) {
+				if( g1 == K1 ) g1 = 0;
+				double a  = mu[0] * dtheta[i0] * theta[order + i1]
+				       + mu[1] * theta[i0] * dtheta[order + i1],
+				       b  = mu[2] * theta[i0] * theta[order + i1];
+				row = (g0*K1 + g1) * K2;
+				g2  = spme_base[3*j + 2];
+				for( int i2 = 0; i2 < order; i2++, g2++ ) {
+					if( g2 == K2 ) g2 = 0;
+					spme_mesh[2*(row + g2)] += a * theta[2*order + i2] + b * dtheta[2*order + i2];
+				}
+			}
+		}
+	}
+}
+
+
+
+
+void System::spme_convolve( const double *influence ) {
+// Turn the mesh Q into conv = F^-1[ G F[Q] ] (real part only).
+
+	int points = spme_grid[0] * spme_grid[1] * spme_grid[2];
+
+	spme_fft.forward( spme_mesh );
+	for( int g = 0; g < points; g++ ) {
+		spme_mesh[2*g    ] *= influence[g];
+		spme_mesh[2*g + 1] *= influence[g];
+	}
+	spme_fft.backward( spme_mesh );
+}
+
+
+
+
+void System::spme_field( int j, double *field ) {
+// The field at collected atom j, -grad phi = -2 sum_g grad theta_j(g) conv(g), from the convolved mesh.
+
+	int            order  = spme_order,
+	               K1     = spme_grid[1],
+	               K2     = spme_grid[2],
+	               g0, g1, g2, row;
+	const double * theta  = spme_theta  + 3*j*order,
+	             * dtheta = spme_dtheta + 3*j*order;
+	double         du[3] = { 0 },  // d phi/d u_q
+	               c;
+
+	g0 = spme_base[3*j];
+	for( int i0 = 0; i0 < order; i0++, g0++ ) {
+		if( g0 == spme_grid[0] ) g0 = 0;
+		g1 = spme_base[3*j + 1];
+		for( int i1 = 0; i1 < order; i1++, g1++ ) {
+			if( g1 == K1 ) g1 = 0;
+			row = (g0*K1 + g1) * K2;
+			g2  = spme_base[3*j + 2];
+			for( int i2 = 0; i2 < order; i2++, g2++ ) {
+				if( g2 == K2 ) g2 = 0;
+				c      = spme_mesh[2*(row + g2)];
+				du[0] += c * dtheta[i0] *  theta[order + i1] *  theta[2*order + i2];
+				du[1] += c *  theta[i0] * dtheta[order + i1] *  theta[2*order + i2];
+				du[2] += c *  theta[i0] *  theta[order + i1] * dtheta[2*order + i2];
+			}
+		}
+	}
+
+	for( int p = 0; p < 3; p++ )
+		field[p] = -2.0 * (  spme_basis[p][0] * spme_grid[0] * du[0]
+		                   + spme_basis[p][1] * spme_grid[1] * du[1]
+		                   + spme_basis[p][2] * spme_grid[2] * du[2] );
+}
+
+
+
+
+void System::spme_recip_field() {
+// recip_term() by mesh: the reciprocal-space field of all the charges, added to ef_static.
+
+	int    n;
+	double field[3];
+
+	spme_update();
+	n = spme_splines( false, true );
+	spme_spread_charges();
+	spme_convolve( spme_polar_influence );
+
+	for( int j = 0; j < n; j++ ) {
+		spme_field( j, field );
+		for( int p = 0; p < 3; p++ )
+			spme_atom[j]->ef_static[p] += field[p];
+	}
+}
+
+
+
+
+void System::spme_induced_field() {
+// induced_recip_term() by mesh: the reciprocal-space field of all the dipoles, added to ef_induced.
+
+	int    n;
+	double field[3];
+
+	spme_update();
+	n = spme_splines( false, true );
+	spme_spread_dipoles();
+	spme_convolve( spme_polar_influence );
+
+	for( int j = 0; j < n; j++ ) {
+		spme_field( j, field );
+		for( int p = 0; p < 3; p++ )
+			spme_atom[j]->ef_induced[p] += field[p];
+	}
+}
+
+
+
+
+void System::spme_free() {
+
+	if( spme_bsp_mod         ) free( spme_bsp_mod         );
+	if( spme_influence       ) free( spme_influence       );
+	if( spme_polar_influence ) free( spme_polar_influence );
+	if( spme_dtheta          ) free( spme_dtheta          );
+	if( spme_mesh            ) free( spme_mesh            );
+	if( spme_theta           ) free( spme_theta           );
+	if( spme_base            ) free( spme_base            );
+	if( spme_atom            ) free( spme_atom            );
+	spme_fft.clear();
+
+	spme_init();
+}
+
+
+
+
+void System::spme_init() {
+
+	spme_order           = 0;  // nothing made yet
+	spme_natoms          = 0;
+	spme_allocd          = 0;
+	spme_alpha           = 0;
+	spme_polar_alpha     = 0;
+	spme_tolerance       = 0;
+	for( int q = 0; q < 3; q++ )
+		spme_grid[q] = 0;
+	memset( spme_basis, 0, sizeof(spme_basis) );
+
+	spme_bsp_mod         = nullptr;
+	spme_influence       = nullptr;
+	spme_polar_influence = nullptr;
+	spme_dtheta          = nullptr;
+	spme_mesh            = nullptr;
+	spme_theta           = nullptr;
+	spme_base            = nullptr;
+	spme_atom            = nullptr;
+}
@@ -0,0 +1,130 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "Output.h"
+#include "SplineTable.h"
+#include "System.h"
+
+
+
+// Spline lookup tables for the special functions of the real-space kernels.
+//
+// coulombic_real_pair(), real_term(), induced_real_term() and the field in the energy pipeline call
+// erfc() and exp(-a^2 r^2) for every pair, and thole_amatrix() calls exp(-l r) for exponential
+// damping. With spline_tolerance set, spline_tables_init() tabulates erfc(x) and exp(-x) to within
+// that absolute error (see SplineTable), and those kernels go through erfc_lookup() and
+// exp_neg_lookup() instead. Arguments beyond the end of a table, where both functions are smaller
+// than any sensible tolerance anyway, are passed on to the library.
+//
+// The polar_wolf_alpha_lookup table is built the same way, on first use, from the whole Wolf field
+// kernel rather than from its parts.
+
+static const double erfc_table_end          = 6.0;    // erfc(6) = 2e-17
+static const double exp_table_end           = 40.0;   // exp(-40) = 4e-18
+static const double wolf_table_start        = 0.5;    // angstroms; closer pairs are evaluated directly
+static const double wolf_tolerance_default  = 1.0e-10;
+
+
+
+
+static double erfc_value( double x, const double * ) {
+	return erfc(x);
+}
+
+static double erfc_slope( double x, const double * ) {
+	return -2.0 * OneOverSqrtPi * exp(-x*x);
+}
+
+static double exp_neg_value( double x, const double * ) {
+	return exp(-x);
+}
+
+static double exp_neg_slope( double x, const double * ) {
+	return -exp(-x);
+}
+
+// the Wolf field kernel, erfc(a*r)/r^2 + 2*a*exp(-a^2*r^2)/(sqrt(pi)*r), with a = param[0]
+static double wolf_value( double r, const double *param ) {
+	double a  = param[0],
+	       rr = 1.0 / r;
+	return erfc(a*r)*rr*rr + 2.0*a*OneOverSqrtPi*exp(-a * a*r*r)*rr;
+}
+
+static double wolf_slope( double r, const double *param ) {
+	double a  = param[0],
+	       rr = 1.0 / r;
+	return -2.0*erfc(a*r)*rr*rr*rr - 2.0*a*OneOverSqrtPi*exp(-a * a*r*r)*(2.0*rr*rr + 2.0*a*a);
+}
+
+
+
+
+static void report( const char *name, const SplineTable &table ) {
+
+	char linebuf[maxLine];
+
+	sprintf( linebuf, "SYSTEM: spline table for %s: %d segments on [%g, %g), spacing %.3e, max error %.2e\n",
+	         name, table.intervals, table.x_min, table.x_max, table.spacing, table.max_error );
+	Output::out1( linebuf );
+}
+
+
+
+
+static void build( SplineTable &table, const char *name, SplineTable::function f, SplineTable::function df, const double *param, double lower, double upper, double tolerance ) {
+
+	char linebuf[maxLine];
+
+	if( ! table.build( f, df, param, lower, upper, tolerance ) ) {
+		sprintf( linebuf, "SYSTEM: spline table for %s cannot reach a tolerance of %.2e (best %.2e)\n", name, tolerance, table.max_error );
+		Output::err( linebuf );
+		throw invalid_setting;
+	}
+	report( name, table );
+}
+
+
+
+
+void System::spline_tables_init() {
+// Build the erfc/exp tables, if spline_tolerance asks for them, and report their resolution.
+
+	spline_erfc.clear();
+	spline_exp.clear();
+
+	if( spline_tolerance <= 0 )
+		return;
+
+	build( spline_erfc, "erfc(x)", erfc_value,    erfc_slope,    nullptr, 0.0, erfc_table_end, spline_tolerance );
+	build( spline_exp,  "exp(-x)", exp_neg_value, exp_neg_slope, nullptr, 0.0, exp_table_end,  spline_tolerance );
+}
+
+
+
+
+// the point of this is to store all the polar_wolf_alpha calculations in a table, and then just look them up
+// that way we don't need to calculate erfc's and exp's over and over and over
+void System::polar_wolf_alpha_lookup_init() {
+
+	double param[1]  = { polar_wolf_alpha },
+	       tolerance = (spline_tolerance > 0) ? spline_tolerance : wolf_tolerance_default;
+
+	if( polar_wolf_alpha_lookup_cutoff <= wolf_table_start )
+		return;  // nothing to tabulate; polar_wolf_alpha_getval() evaluates every pair directly
+	build( polar_wolf_alpha_table, "polar wolf alpha", wolf_value, wolf_slope, param, wolf_table_start, polar_wolf_alpha_lookup_cutoff, tolerance );
+}
+
+
+
+
+double System::polar_wolf_alpha_getval( double r ) {
+
+	if( r >= polar_wolf_alpha_lookup_cutoff )
+		return 0.0; //answer will be zero if cutoff is large enough
+	if( ! polar_wolf_alpha_table.covers(r) ) {
+		double param[1] = { polar_wolf_alpha };
+		return wolf_value( r, param );
+	}
+
+	return polar_wolf_alpha_table(r);
+}
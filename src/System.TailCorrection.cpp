@@ -0,0 +1,180 @@
+#include <stdlib.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Pair.h"
+#include "SafeOps.h"
+#include "System.h"
+
+
+
+// Long-range (tail) corrections from the number of atoms of each mixing type.
+//
+// The pair LRC of lj(), exp_repulsion() and disp_expansion() (and of the energy pipeline), and the
+// polarvdw correction of lr_vdw_corr(), depend on nothing but the mixed parameters of the pair, the
+// cutoff and the volume; the self terms only on the atom's own parameters. Intra-molecular pairs
+// count too, so summed over every pair of atoms in the system the correction is
+//
+//     sum_t N_t self(t)  +  sum_t N_t (N_t - 1)/2 pair(t,t)  +  sum_{t<u} N_t N_u pair(t,u)
+//
+// with N_t the number of atoms of mixing type t (see System.MixingTable.cpp). lrc_type_count holds
+// N_t, and is adjusted as molecules enter and leave the system (resize_pair_rows()), so an insertion,
+// a removal or a volume change costs O(types^2) rather than a pass over all O(N^2) pairs. The
+// per-type terms are evaluated with the same functions as the per-pair ones, for a pair of atoms
+// built from the types' parameters, and only again when the volume, the cutoff or the types change.
+//
+// SPECTRE pairs don't use the mixing table, so with spectre the corrections are summed per pair.
+
+
+
+
+void System::lrc_counts_reset() {
+// Count every atom in the system again, after its mixing types have been reassigned.
+
+	for( int t = 0; t < lrc_ntypes; t++ )
+		lrc_type_count[t] = 0;
+	for( int k = 0; k < LRC_TERMS_KINDS; k++ )
+		lrc_terms_ntypes[k] = 0;
+
+	for( Molecule *molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		lrc_counts_add( molecule_ptr, 1 );
+}
+
+
+
+
+void System::lrc_counts_add( Molecule *molecule, int sign ) {
+// Count the atoms of a molecule entering (sign > 0) or leaving (sign < 0) the system.
+
+	for( Atom *atom_ptr = molecule->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+
+		int t = atom_ptr->mixing_type;
+		if( t < 0 )
+			continue;
+
+		if( t >= lrc_ntypes ) {
+			SafeOps::realloc( lrc_type_count, (t + 1) * sizeof(int), __LINE__, __FILE__ );
+			for( int u = lrc_ntypes; u <= t; u++ )
+				lrc_type_count[u] = 0;
+			lrc_ntypes = t + 1;
+		}
+		lrc_type_count[t] += sign;
+	}
+}
+
+
+
+
+void System::lrc_terms_update( int kind, double cutoff ) {
+// (Re)evaluate the per-type terms of an LRC_TERMS_* correction, if the volume, cutoff or types changed.
+
+	int n = mixing_ntypes;
+
+	if( (lrc_terms_ntypes[kind] == n)  &&  (lrc_terms_volume[kind] == pbc.volume)  &&  (lrc_terms_cutoff[kind] == cutoff) )
+		return;
+
+	if( n > lrc_terms_allocd[kind] ) {
+		SafeOps::realloc( lrc_pair_term[kind], n * n * sizeof(double), __LINE__, __FILE__ );
+		SafeOps::realloc( lrc_self_term[kind], n * sizeof(double), __LINE__, __FILE__ );
+		lrc_terms_allocd[kind] = n;
+	}
+
+	Atom type_t, type_u;
+	for( int t = 0; t < n; t++ ) {
+		mixing_type_atom( t, &type_t );
+
+		for( int u = t; u < n; u++ ) {
+			mixing_type_atom( u, &type_u );
+
+			Pair pair( mixing_table[ t*n + u ] );
+			pair.atom        = &type_u;
+			pair.lrc         = 0;  // so that nothing cached is returned
+			pair.last_volume = 0;
+
+			double term;
+			if( kind == LRC_TERMS_VDW )
+				term = lr_vdw_pair( &type_t, &type_u, &pair );
+			else if( using_disp_expansion )
+				term = disp_expansion_lrc( &pair, cutoff );
+			else if( cdvdw_exp_repulsion )
+				term = exp_lrc_corr( &type_t, &pair, cutoff );
+			else
+				term = lj_lrc_corr( &type_t, &pair, cutoff );
+
+			lrc_pair_term[kind][ t*n + u ] = term;
+			lrc_pair_term[kind][ u*n + t ] = term;
+		}
+
+		type_t.lrc_self    = 0;
+		type_t.last_volume = 0;
+		if( kind == LRC_TERMS_VDW )
+			lrc_self_term[kind][t] = 0;
+		else if( using_disp_expansion )
+			lrc_self_term[kind][t] = disp_expansion_lrc_self( &type_t, cutoff );
+		else if( cdvdw_exp_repulsion )
+			lrc_self_term[kind][t] = exp_lrc_self( &type_t, cutoff );
+		else
+			lrc_self_term[kind][t] = lj_lrc_self( &type_t, cutoff );
+	}
+
+	lrc_terms_ntypes[kind] = n;
+	lrc_terms_volume[kind] = pbc.volume;
+	lrc_terms_cutoff[kind] = cutoff;
+}
+
+
+
+
+double System::lrc_from_counts( int kind, double cutoff ) {
+// The whole LRC_TERMS_RD (pairs and self terms) or LRC_TERMS_VDW correction of the system.
+
+	double lrc = 0;
+	int    n   = (lrc_ntypes < mixing_ntypes) ? lrc_ntypes : mixing_ntypes;
+
+	lrc_terms_update( kind, cutoff );
+
+	const double *pair = lrc_pair_term[kind],
+	             *self = lrc_self_term[kind];
+
+	for( int t = 0; t < n; t++ ) {
+		double n_t = lrc_type_count[t];
+		if( n_t == 0 )
+			continue;
+
+		lrc += n_t * self[t] + 0.5 * n_t * (n_t - 1.0) * pair[ t*mixing_ntypes + t ];
+		for( int u = t + 1; u < n; u++ )
+			lrc += n_t * lrc_type_count[u] * pair[ t*mixing_ntypes + u ];
+	}
+
+	return lrc;
+}
+
+
+
+
+void System::lrc_counts_init() {
+
+	lrc_ntypes     = 0;
+	lrc_type_count = nullptr;
+	for( int k = 0; k < LRC_TERMS_KINDS; k++ ) {
+		lrc_terms_ntypes[k] = 0;
+		lrc_terms_allocd[k] = 0;
+		lrc_terms_volume[k] = 0;
+		lrc_terms_cutoff[k] = 0;
+		lrc_pair_term[k]    = nullptr;
+		lrc_self_term[k]    = nullptr;
+	}
+}
+
+
+
+
+void System::lrc_counts_free() {
+
+	if( lrc_type_count ) free( lrc_type_count );
+	for( int k = 0; k < LRC_TERMS_KINDS; k++ ) {
+		if( lrc_pair_term[k] ) free( lrc_pair_term[k] );
+		if( lrc_self_term[k] ) free( lrc_self_term[k] );
+	}
+	lrc_counts_init();
+}
@@ -0,0 +1,147 @@
+#include <math.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Pair.h"
+#include "SafeOps.h"
+#include "System.h"
+
+
+
+// Verlet neighbor lists.
+//
+// Every non-frozen pair whose image separation is within pbc.cutoff + verlet_skin (along with all
+// intra-molecular pairs, whose self-interaction terms do not depend on the cutoff) is recorded in a
+// flat list, grouped by the first atom of the pair. lj(), exp_repulsion(), sg() and coulombic_real()
+// walk this list instead of the full pair lists. The list remains valid until some atom has moved
+// more than half the skin since it was built, at which point no unlisted pair can have come within
+// the cutoff.
+//
+//   verlet_list_start[i]    entries for atom_array[i] occupy [start[i], start[i+1])
+//   verlet_list_pair[e]     the listed Pair node
+//   verlet_list_offset[e]   position of that node within its owner's pair list
+//   verlet_list_atom[i]     owner atom at the time its entries were resolved
+//   verlet_list_ref_pos     atomic positions at the time of the last build
+
+
+
+
+void System::verlet_list_update( bool lists_changed ) {
+// Rebuilds the neighbor list if it may have been invalidated, otherwise refreshes the node pointers
+// of any atoms that have been replaced. Called from pairs(), once all image separations are current.
+
+	bool   rebuild = lists_changed  ||  !verlet_list_start  ||  (natoms != verlet_list_natoms)  ||  (pbc.volume != verlet_list_volume);
+	double half_skin_sq = 0.25 * verlet_skin * verlet_skin,
+	       dr, dr2;
+
+	// has anyone moved far enough to have crossed into the cutoff?
+	for( int i = 0; (i < natoms) && !rebuild; i++ ) {
+		if( atom_array[i]->frozen )
+			continue;
+		dr2 = 0;
+		for( int p = 0; p < 3; p++ ) {
+			dr   = atom_array[i]->pos[p] - verlet_list_ref_pos[3*i + p];
+			dr2 += dr*dr;
+		}
+		if( dr2 > half_skin_sq )
+			rebuild = true;
+	}
+
+	if( rebuild ) {
+		verlet_list_build();
+		return;
+	}
+
+	// a rejected move links a deep copy of the molecule back into the system, which brings its own pair nodes
+	for( int i = 0; i < natoms; i++ )
+		if( atom_array[i] != verlet_list_atom[i] )
+			verlet_list_resolve(i);
+}
+
+
+
+
+void System::verlet_list_build() {
+
+	int    k;
+	double range = pbc.cutoff + verlet_skin;
+	Pair * pair_ptr;
+
+	if( natoms > verlet_list_natoms_allocd ) {
+		SafeOps::realloc( verlet_list_start,   (natoms + 1) * sizeof(int),    __LINE__, __FILE__ );
+		SafeOps::realloc( verlet_list_atom,    natoms * sizeof(Atom *),       __LINE__, __FILE__ );
+		SafeOps::realloc( verlet_list_ref_pos, natoms * sizeof(double) * 3,   __LINE__, __FILE__ );
+		verlet_list_natoms_allocd = natoms;
+	}
+
+	verlet_list_count = 0;
+	for( int i = 0; i < natoms; i++ ) {
+
+		verlet_list_start[i] = verlet_list_count;
+		verlet_list_atom [i] = atom_array[i];
+		for( int p = 0; p < 3; p++ )
+			verlet_list_ref_pos[3*i + p] = atom_array[i]->pos[p];
+
+		for( pair_ptr = atom_array[i]->pairs, k = 0;   pair_ptr;   pair_ptr = pair_ptr->next, k++ ) {
+
+			if( pair_ptr->frozen )
+				continue;
+			if( (pair_ptr->rimg >= range) && (pair_ptr->molecule != molecule_array[i]) )
+				continue;
+
+			// grow the list as needed
+			if( verlet_list_count == verlet_list_allocd ) {
+				verlet_list_allocd = verlet_list_allocd ? 2*verlet_list_allocd : 1024;
+				SafeOps::realloc( verlet_list_pair,   verlet_list_allocd * sizeof(Pair *), __LINE__, __FILE__ );
+				SafeOps::realloc( verlet_list_offset, verlet_list_allocd * sizeof(int),    __LINE__, __FILE__ );
+			}
+			verlet_list_pair  [ verlet_list_count ] = pair_ptr;
+			verlet_list_offset[ verlet_list_count ] = k;
+			verlet_list_count++;
+
+			// unlisted pairs are not visited by the kernels, so a newly listed pair may hold a stale energy
+			pair_ptr->recalculate_energy = 1;
+		}
+	}
+	verlet_list_start[natoms] = verlet_list_count;
+
+	verlet_list_natoms    = natoms;
+	verlet_list_volume    = pbc.volume;
+	verlet_list_lrc_stale = 1;
+	verlet_list_rebuilds++;
+
+	// the flags raised above are not known to the dirty-molecule bookkeeping
+	pairs_sweep_all = 1;
+}
+
+
+
+
+void System::verlet_list_resolve( int i ) {
+// Re-point atom i's entries at the nodes in its current pair list.
+
+	for( int e = verlet_list_start[i]; e < verlet_list_start[i+1]; e++ )
+		verlet_list_pair[e] = atom_array[i]->pairs + verlet_list_offset[e];
+	verlet_list_atom[i] = atom_array[i];
+}
+
+
+
+
+void System::verlet_list_free() {
+
+	if( verlet_list_start   ) free( verlet_list_start   );
+	if( verlet_list_pair    ) free( verlet_list_pair    );
+	if( verlet_list_offset  ) free( verlet_list_offset  );
+	if( verlet_list_atom    ) free( verlet_list_atom    );
+	if( verlet_list_ref_pos ) free( verlet_list_ref_pos );
+
+	verlet_list_start         = nullptr;
+	verlet_list_pair          = nullptr;
+	verlet_list_offset        = nullptr;
+	verlet_list_atom          = nullptr;
+	verlet_list_ref_pos       = nullptr;
+	verlet_list_count         = 0;
+	verlet_list_allocd        = 0;
+	verlet_list_natoms_allocd = 0;
+}
@@ -0,0 +1,324 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "Atom.h"
+#include "Molecule.h"
+#include "Pair.h"
+#include "SafeOps.h"
+#include "System.h"
+
+
+
+// NPT volume moves by scaling cached inverse-power sums.
+//
+// volume_change() scales the cell and every molecule's center of mass, after which energy() would
+// image and recompute every pair, and the same again once a rejected move is reverted. When every
+// molecule is a single site, every pair separation scales with the cell, and the Lennard-Jones energy
+// (with no charges to go along with it) is a sum of pure inverse powers:
+//
+//     E(s) = sum_p s^-p S_p,    S_p = sum over the pairs inside the cutoff of A_p r^-p
+//
+// with s the linear scale factor, A_12 = 4 eps sigma^12 (or sigrep sigma^12) and A_6 = -4 eps sigma^6.
+// volume_scale_prepare() takes the S_p from the cached pair separations before the cell is scaled,
+// along with the pairs close enough to the (fixed) cutoff that a move could take them across it, and
+// energy() then evaluates the trial configuration from those in O(shell) (volume_scaled_energy()). If
+// the move is rejected, the cell and the positions are restored exactly, so the cached pair energies
+// and separations are still current and the next pairs() has nothing to visit; if it is accepted,
+// the next full energy() recomputes them. The sums are kept
+// across rejected volume moves, and forgotten by any other move.
+
+static const int volume_scale_power[VOLUME_SCALE_POWERS] = { 12, 6 };
+static const int shell_stride                            = 1 + VOLUME_SCALE_POWERS;  // r, then A_p
+
+
+
+
+static void inverse_powers( double r, double *inv ) {
+
+	double ir2 = 1.0 / (r*r),
+	       ir6 = ir2 * ir2 * ir2;
+
+	inv[VOLUME_SCALE_R12] = ir6 * ir6;
+	inv[VOLUME_SCALE_R6]  = ir6;
+}
+
+
+
+
+bool System::volume_scale_supported() {
+// The energy of the system is the Lennard-Jones energy of single-site molecules, and nothing else.
+
+	if( ensemble != ENSEMBLE_NPT )
+		return false;
+	if( verlet_list || cell_list )  // pairs out of range may not have a current separation
+		return false;
+	if( rd_anharmonic || use_sg || use_dreiding || using_lj_buffered_14_7 || using_disp_expansion || cdvdw_exp_repulsion || rd_crystal || feynman_hibbs )
+		return false;
+	if( polarization || polarvdw || using_axilrod_teller || cavity_autoreject_absolute || spectre || gwp )
+		return false;
+
+	for( Molecule *molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+		if( !molecule_ptr->atoms || molecule_ptr->atoms->next )
+			return false;
+		if( !rd_only && (molecule_ptr->atoms->charge != 0.0) )
+			return false;
+	}
+
+	return true;
+}
+
+
+
+
+void System::volume_scale_coefficients( const Pair *pair_ptr, double *A ) {
+// A_p for a pair, as lj_pair() would weigh its (sigma/r)^p.
+
+	double sigma2  = pair_ptr->sigma * pair_ptr->sigma,
+	       sigma6  = sigma2 * sigma2 * sigma2,
+	       sigma12 = pair_ptr->attractive_only ? 0.0 : sigma6 * sigma6;
+
+	if( cdvdw_sig_repulsion ) {
+		A[VOLUME_SCALE_R12] = pair_ptr->sigrep * sigma12;
+		A[VOLUME_SCALE_R6]  = 0;
+	} else {
+		A[VOLUME_SCALE_R12] =  4.0 * pair_ptr->epsilon * sigma12;
+		A[VOLUME_SCALE_R6]  = -4.0 * pair_ptr->epsilon * sigma6;
+	}
+}
+
+
+
+
+void System::volume_scale_sums() {
+// Bring the cached pair energies up to date, and take the S_p and the shell of pairs about the cutoff
+// from their separations.
+
+	Molecule * molecule_ptr;
+	Atom     * atom_ptr;
+	Pair     * pair_ptr;
+	double     A[VOLUME_SCALE_POWERS],
+	           inv[VOLUME_SCALE_POWERS],
+	           cutoff    = pbc.cutoff + SMALL_dR,  // lj_pair() keeps pairs with r - SMALL_dR < cutoff
+	           reach     = exp( volume_change_factor / 6.0 + 1.0e-9 ),
+	           shell_min = cutoff / reach,
+	           shell_max = cutoff * reach;
+
+	// as energy() would, so that nothing is left flagged for recalculation
+	natoms = countNatoms();
+	pairs();
+	if( last_volume != pbc.volume  ||  observables->energy == 0.0  ||  pair_energies_stale )
+		flag_all_pairs();
+	pair_energies_stale = 0;
+	lj();
+
+	for( int p = 0; p < VOLUME_SCALE_POWERS; p++ )
+		volume_scale_sum[p] = 0;
+	volume_scale_nshell = 0;
+
+	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
+		for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next ) {
+			for( pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next ) {
+
+				// lj() has consumed the flags; lowered here, none are left for a later pairs() to find
+				pair_ptr->recalculate_energy = 0;
+
+				if( pair_ptr->rd_excluded || pair_ptr->frozen )
+					continue;
+
+				double r = pair_ptr->rimg;
+				volume_scale_coefficients( pair_ptr, A );
+
+				if( r < cutoff ) {
+					inverse_powers( r, inv );
+					for( int p = 0; p < VOLUME_SCALE_POWERS; p++ )
+						volume_scale_sum[p] += A[p] * inv[p];
+				}
+
+				if( (r > shell_min) && (r < shell_max) ) {
+					if( volume_scale_nshell >= volume_scale_shell_allocd ) {
+						volume_scale_shell_allocd = 2 * volume_scale_shell_allocd + 64;
+						SafeOps::realloc( volume_scale_shell, volume_scale_shell_allocd * shell_stride * sizeof(double), __LINE__, __FILE__ );
+					}
+					double *entry = volume_scale_shell + volume_scale_nshell * shell_stride;
+					entry[0] = r;
+					for( int p = 0; p < VOLUME_SCALE_POWERS; p++ )
+						entry[1 + p] = A[p];
+					volume_scale_nshell++;
+				}
+			}
+		}
+	}
+
+	pairs_nflagged      = 0;
+	pairs_sweep_all     = 0;
+	volume_scale_volume = pbc.volume;
+}
+
+
+
+
+void System::volume_scale_prepare( double new_volume ) {
+// Called by volume_change() before it scales the system: ready the sums for the trial volume, and
+// keep the cell and the positions to be restored if the move is rejected.
+
+	int    nmolecules = 0;
+	double scale      = pow( new_volume/pbc.volume, 1.0/3.0 );  // as volume_change() scales the basis
+
+	volume_scale_pending = 0;
+
+	if( !volume_scale_supported()  ||  (fabs(log(scale)) > volume_change_factor / 6.0) )
+		return;
+
+	if( volume_scale_volume != pbc.volume )
+		volume_scale_sums();
+
+	for( Molecule *molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		nmolecules++;
+	if( nmolecules > volume_scale_backup_allocd ) {
+		SafeOps::realloc( volume_scale_backup, nmolecules * 12 * sizeof(double), __LINE__, __FILE__ );
+		volume_scale_backup_allocd = nmolecules;
+	}
+
+	double *backup = volume_scale_backup;
+	for( Molecule *molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next, backup += 12 ) {
+		for( int p = 0; p < 3; p++ ) {
+			backup[p]     = molecule_ptr->com[p];
+			backup[3 + p] = molecule_ptr->wrapped_com[p];
+			backup[6 + p] = molecule_ptr->atoms->pos[p];
+			backup[9 + p] = molecule_ptr->atoms->wrapped_pos[p];
+		}
+	}
+	for( int i = 0; i < 3; i++ )
+		for( int j = 0; j < 3; j++ )
+			volume_scale_basis[i][j] = pbc.basis[i][j];
+
+	volume_scale_from    = pbc.volume;
+	volume_scale_factor  = scale;
+	volume_scale_pending = 1;
+}
+
+
+
+
+double System::volume_scaled_energy() {
+// energy(), for the trial configuration of a prepared volume move.
+
+	double s      = volume_scale_factor,
+	       cutoff = pbc.cutoff + SMALL_dR,
+	       inv[VOLUME_SCALE_POWERS],
+	       rd     = 0;
+
+	for( int p = 0; p < VOLUME_SCALE_POWERS; p++ )
+		rd += volume_scale_sum[p] * pow( s, -volume_scale_power[p] );
+
+	// the pairs the move takes across the cutoff, one way or the other
+	for( int k = 0; k < volume_scale_nshell; k++ ) {
+		const double *entry = volume_scale_shell + k * shell_stride;
+		double        r     = entry[0];
+		bool          in    = (r < cutoff),
+		              in_s  = (s*r < cutoff);
+
+		if( in == in_s )
+			continue;
+
+		double term = 0;
+		inverse_powers( s*r, inv );
+		for( int p = 0; p < VOLUME_SCALE_POWERS; p++ )
+			term += entry[1 + p] * inv[p];
+		rd += in_s ? term : -term;
+	}
+
+	if( rd_lrc )
+		rd += lrc_from_counts( LRC_TERMS_RD, pbc.cutoff );
+
+	// the cached pair energies still describe the configuration before the move
+	pair_energies_stale                  = 1;
+	delta_energy_count                   = 0;
+	observables->rd_energy_carry         = 0;
+	observables->coulombic_energy_carry  = 0;
+
+	observables->rd_energy = rd;
+	if( !rd_only ) {
+		observables->coulombic_energy = 0;
+		observables->kspace_energy    = 0;
+	}
+	update_energy_observables( rd );
+
+	return rd;
+}
+
+
+
+
+bool System::volume_scale_restore() {
+// Called by revert_volume_change(): put the cell and the molecules back exactly as they were, which
+// leaves the cached pair energies and separations current, so the full sweep volume_change() asked
+// for is called off. Returns false if the move wasn't a prepared one.
+
+	if( !volume_scale_pending )
+		return false;
+
+	for( int i = 0; i < 3; i++ )
+		for( int j = 0; j < 3; j++ )
+			pbc.basis[i][j] = volume_scale_basis[i][j];
+	update_pbc();
+	observables->volume = pbc.volume;
+
+	const double *backup = volume_scale_backup;
+	for( Molecule *molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next, backup += 12 ) {
+		for( int p = 0; p < 3; p++ ) {
+			molecule_ptr->com[p]                = backup[p];
+			molecule_ptr->wrapped_com[p]        = backup[3 + p];
+			molecule_ptr->atoms->pos[p]         = backup[6 + p];
+			molecule_ptr->atoms->wrapped_pos[p] = backup[9 + p];
+		}
+	}
+
+	last_volume          = volume_scale_from;
+	pair_energies_stale  = 0;
+	volume_scale_pending = 0;
+	pairs_sweep_all      = 0;
+
+	return true;
+}
+
+
+
+
+void System::volume_scale_move_made() {
+// Called by make_move() once the move is done. Any other move changes the configuration the sums
+// describe.
+
+	if( checkpoint->movetype != MOVETYPE_VOLUME ) {
+		volume_scale_pending = 0;
+		volume_scale_volume  = 0;
+	}
+}
+
+
+
+
+void System::volume_scale_init() {
+
+	volume_scale_pending       = 0;
+	volume_scale_volume        = 0;
+	volume_scale_from          = 0;
+	volume_scale_factor        = 1;
+	volume_scale_shell         = nullptr;
+	volume_scale_nshell        = 0;
+	volume_scale_shell_allocd  = 0;
+	volume_scale_backup        = nullptr;
+	volume_scale_backup_allocd = 0;
+	for( int p = 0; p < VOLUME_SCALE_POWERS; p++ )
+		volume_scale_sum[p] = 0;
+}
+
+
+
+
+void System::volume_scale_free() {
+
+	if( volume_scale_shell  ) free( volume_scale_shell  );
+	if( volume_scale_backup ) free( volume_scale_backup );
+	volume_scale_init();
+}
@@ -14,8 +14,13 @@ extern int size, rank;
 
 static const double  ewald_alpha_default              = 0.5;
 static const int     ewald_kmax_default               = 7;
+static const double  ewald_spme_tolerance_default     = 1.0e-5;
+static const double  rd_crystal_ewald_tolerance_default = 1.0e-6;
 static const int     ptemp_freq_default               = 20;   // default frequency for parallel tempering bath swaps
 static const double  wolf_alpha_lookup_cutoff_default = 30.0; //angstroms
+static const double  verlet_skin_default              = 1.0;  //angstroms
+static const int     delta_energy_refresh_default     = 1000; // steps
+static const int     pairs_flagged_per_atom           = 64;   // beyond this many flagged pairs per atom, pairs() does a full sweep
 
 
 
@@ -25,10 +30,8 @@ System::~System() {
 
 	// ***cavity_grid
 	// *ptemp
-	// *polar_wolf_alpha_table
 	// **A_matrix
 	// **B_matrix
-	// *vdw_eiso_info
 	// *insertion_molecules
 	// **insertion_molecules_array
 	// **atom_array
@@ -90,6 +93,23 @@ System::~System() {
 		free(mpi_data.avg_nodestats);
 	if (mpi_data.sinfo && (sorbateCount > 1))
 		free(mpi_data.sinfo);
+
+	if( pairs_visit         ) free( pairs_visit         );
+	if( pairs_flagged       ) free( pairs_flagged       );
+	if( pairs_mobile        ) free( pairs_mobile        );
+	if( pairs_mobile_before ) free( pairs_mobile_before );
+
+	cell_list_free();
+	verlet_list_free();
+	mixing_table_free();
+	lj_block_free();
+	ewald_kspace_free();
+	spme_free();
+	axilrod_teller_free();
+	rd_ewald_free();
+	pair_tables_free();
+	lrc_counts_free();
+	volume_scale_free();
 };
 
 
@@ -183,6 +203,98 @@ System::System() {
 	
 	// Info regarding  periodic boundary and unit cell geometry
 	wrapall                      = 1;
+
+	// Linked-cell neighbor search
+	cell_list                    = 0;
+	cell_list_ncells             = 0;
+	cell_list_ncells_allocd      = 0;
+	cell_list_natoms_allocd      = 0;
+	cell_list_natoms             = 0;
+	cell_list_nbuilt             = 0;
+	cell_list_culled             = 0;
+	cell_list_head               = nullptr;
+	cell_list_next               = nullptr;
+	cell_list_cell               = nullptr;
+	cell_list_prev_head          = nullptr;
+	cell_list_prev_next          = nullptr;
+	cell_list_prev_cell          = nullptr;
+	cell_list_atom_cell          = nullptr;
+	for( int p=0; p<3; p++ )
+		cell_list_dim[p]         = 1;
+	pair_lists_changed           = 1;
+	skip_frozen_pairs            = 0;
+	pairs_mobile                 = nullptr;
+	pairs_mobile_before          = nullptr;
+
+	// Type x type exclusion/mixing table
+	mixing_ntypes                = 0;
+	mixing_type_params           = nullptr;
+	mixing_table                 = nullptr;
+
+	// Dirty-molecule tracking
+	dirty_tracking               = 0;
+	pairs_sweep_all              = 1;
+	pairs_natoms                 = 0;
+	pairs_natoms_allocd          = 0;
+	pairs_visit                  = nullptr;
+	pairs_flagged                = nullptr;
+	pairs_nflagged               = 0;
+	pairs_flagged_allocd         = 0;
+
+	// Verlet neighbor lists
+	verlet_list                  = 0;
+	verlet_skin                  = verlet_skin_default;
+	verlet_list_count            = 0;
+	verlet_list_allocd           = 0;
+	verlet_list_natoms           = 0;
+	verlet_list_natoms_allocd    = 0;
+	verlet_list_rebuilds         = 0;
+	verlet_list_lrc_stale        = 1;
+	verlet_list_volume           = 0.0;
+	verlet_list_lrc              = 0.0;
+	verlet_list_start            = nullptr;
+	verlet_list_offset           = nullptr;
+	verlet_list_pair             = nullptr;
+	verlet_list_atom             = nullptr;
+	verlet_list_ref_pos          = nullptr;
+
+	// Specialized energy pipeline (selected once the input has been validated)
+	energy_pipeline              = nullptr;
+	energy_pipeline_field        = PIPELINE_FIELD_NONE;
+	ef_static_fused              = 0;
+
+	// Ewald k-vectors and SPME mesh (generated on first use)
+	ewald_kspace_init();
+	spme_init();
+	axilrod_teller_init();
+	rd_ewald_init();
+
+	// Tail corrections by type (counted when the pair lists are allocated)
+	lrc_counts_init();
+	es_intra_init();
+
+	// Volume moves by scaling (sums taken on the first volume move)
+	volume_scale_init();
+
+	// Spline lookup tables (built by spline_tables_init())
+	spline_tolerance             = 0.0;
+
+	// Pair tables (kernels chosen by pair_tables_init(), tables made on first use)
+	pair_table_tolerance         = 0.0;
+	pair_table_ntypes            = 0;
+	pair_tables                  = nullptr;
+	pair_table_state             = nullptr;
+	for( int k = 0; k < PAIR_TABLE_KINDS; k++ )
+		pair_table_kernel[k]     = nullptr;
+
+	// Batched Lennard-Jones
+	lj_block_count               = 0;
+	lj_block_pair                = nullptr;
+	lj_block_rimg                = nullptr;
+	lj_block_sigma               = nullptr;
+	lj_block_coef                = nullptr;
+	lj_block_repulsive           = nullptr;
+	lj_block_energy              = nullptr;
 	
 
 
@@ -213,6 +325,14 @@ System::System() {
 	rd_lrc              = 0; 
 	rd_crystal          = 0;
 	rd_crystal_order    = 0;
+	rd_crystal_ewald    = 0;
+	rd_crystal_ewald_tolerance = 0;
+
+	// Delta-energy evaluation of single-molecule moves
+	use_delta_energy     = 0;
+	delta_energy_refresh = delta_energy_refresh_default;
+	delta_energy_count   = 0;
+	pair_energies_stale  = 0;
 
 	// uVT Fugacity Functions
 	h2_fugacity         = 0; 
@@ -231,6 +351,7 @@ System::System() {
 	rd_anharmonic_k         = 0.0;
 	rd_anharmonic_g         = 0.0;
 	using_axilrod_teller    = false; 
+	axilrod_teller_cutoff   = 0.0;
 	c6_mixing               = 0; 
 	damp_dispersion         = 0; 
 	using_disp_expansion    = false;
@@ -248,8 +369,13 @@ System::System() {
 	wolf                    = 0;
 	ewald_alpha_set         = 0; 
 	ewald_kmax              = 0; 
+	ewald_spme              = 0;
+	ewald_retune            = 1;
 	polar_ewald_alpha_set   = 0;
 	ewald_alpha             = 0;
+	ewald_spme_tolerance    = 0;
+	ewald_precision         = 0;
+	ewald_tuned_volume      = 0;
 	polar_ewald_alpha       = 0;
 	
 	
@@ -280,9 +406,7 @@ System::System() {
 	polar_damp              = 0.0;
 	field_damp              = 0.0;
 	polar_precision         = 0.0;
-	polar_wolf_alpha_table         = nullptr;
 	polar_wolf_alpha_lookup_cutoff = 0.0;
-	polar_wolf_alpha_table_max     = 0;       //stores the total size of the array
 	damp_type                      = 0;
 	A_matrix                       = nullptr; // A matrix, B matrix and polarizability tensor 
 	B_matrix                       = nullptr;
@@ -291,7 +415,6 @@ System::System() {
 			C_matrix[i][j]  = 0;
 		}
 
-	vdw_eiso_info = nullptr; //keeps track of molecule vdw self energies
 	
 
 	//misc
@@ -402,6 +525,7 @@ System::System() {
 	// default ewald parameters 
 	ewald_alpha                    = ewald_alpha_default;
 	ewald_kmax                     = ewald_kmax_default;
+	ewald_spme_tolerance           = ewald_spme_tolerance_default;
 	polar_ewald_alpha              = ewald_alpha_default;
 	polar_wolf_alpha_lookup_cutoff = wolf_alpha_lookup_cutoff_default; 
 
@@ -410,6 +534,7 @@ System::System() {
 
 	// default rd LRC flag 
 	rd_lrc = 1;
+	rd_crystal_ewald_tolerance = rd_crystal_ewald_tolerance_default;
 
 	// Initialize fit_input_list to reflect an empty list
 	fit_input_list.next = nullptr;
@@ -533,6 +658,100 @@ System::System( const System &sd ) {
 	pbc.cutoff                    = sd.pbc.cutoff; // radial cutoff (A)
 	pbc.volume                    = sd.pbc.volume; // unit cell volume (A^3) 
 
+	// Linked-cell neighbor search (the index itself is rebuilt by each system)
+	cell_list                     = sd.cell_list;
+	cell_list_ncells              = 0;
+	cell_list_ncells_allocd       = 0;
+	cell_list_natoms_allocd       = 0;
+	cell_list_natoms              = 0;
+	cell_list_nbuilt              = 0;
+	cell_list_culled              = 0;
+	cell_list_head                = nullptr;
+	cell_list_next                = nullptr;
+	cell_list_cell                = nullptr;
+	cell_list_prev_head           = nullptr;
+	cell_list_prev_next           = nullptr;
+	cell_list_prev_cell           = nullptr;
+	cell_list_atom_cell           = nullptr;
+	for( int p=0; p<3; p++ )
+		cell_list_dim[p]          = 1;
+	pair_lists_changed            = 1;
+	skip_frozen_pairs             = 0;
+	pairs_mobile                  = nullptr;
+	pairs_mobile_before           = nullptr;
+
+	// Type x type exclusion/mixing table (interned again by each system)
+	mixing_ntypes                 = 0;
+	mixing_type_params            = nullptr;
+	mixing_table                  = nullptr;
+
+	// Dirty-molecule tracking (enabled by the driver that makes the moves)
+	dirty_tracking                = 0;
+	pairs_sweep_all               = 1;
+	pairs_natoms                  = 0;
+	pairs_natoms_allocd           = 0;
+	pairs_visit                   = nullptr;
+	pairs_flagged                 = nullptr;
+	pairs_nflagged                = 0;
+	pairs_flagged_allocd          = 0;
+
+	// Verlet neighbor lists (likewise rebuilt by each system)
+	verlet_list                   = sd.verlet_list;
+	verlet_skin                   = sd.verlet_skin;
+	verlet_list_count             = 0;
+	verlet_list_allocd            = 0;
+	verlet_list_natoms            = 0;
+	verlet_list_natoms_allocd     = 0;
+	verlet_list_rebuilds          = 0;
+	verlet_list_lrc_stale         = 1;
+	verlet_list_volume            = 0.0;
+	verlet_list_lrc               = 0.0;
+	verlet_list_start             = nullptr;
+	verlet_list_offset            = nullptr;
+	verlet_list_pair              = nullptr;
+	verlet_list_atom              = nullptr;
+	verlet_list_ref_pos           = nullptr;
+
+	// Specialized energy pipeline
+	energy_pipeline               = sd.energy_pipeline;
+	energy_pipeline_field         = sd.energy_pipeline_field;
+	ef_static_fused               = 0;
+
+	// Ewald k-vectors and SPME mesh (regenerated on first use)
+	ewald_kspace_init();
+	spme_init();
+	axilrod_teller_init();
+	rd_ewald_init();
+
+	// Tail corrections by type (recounted when the pair lists are allocated)
+	lrc_counts_init();
+	es_intra_init();
+
+	// Volume moves by scaling (sums taken on the first volume move)
+	volume_scale_init();
+
+	// Spline lookup tables
+	spline_tolerance              = sd.spline_tolerance;
+	spline_erfc                   = sd.spline_erfc;
+	spline_exp                    = sd.spline_exp;
+
+	// Pair tables (remade on first use, since the mixing types are this system's own)
+	pair_table_tolerance          = sd.pair_table_tolerance;
+	pair_table_ntypes             = 0;
+	pair_tables                   = nullptr;
+	pair_table_state              = nullptr;
+	for( int k = 0; k < PAIR_TABLE_KINDS; k++ )
+		pair_table_kernel[k]      = sd.pair_table_kernel[k];
+
+	// Batched Lennard-Jones
+	lj_block_count                = 0;
+	lj_block_pair                 = nullptr;
+	lj_block_rimg                 = nullptr;
+	lj_block_sigma                = nullptr;
+	lj_block_coef                 = nullptr;
+	lj_block_repulsive            = nullptr;
+	lj_block_energy               = nullptr;
+
 	for(int i=0;i<3;i++) {
 		for(int j=0;j<3;j++) {
 			C_matrix            [ i ][ j ] = sd.C_matrix            [ i ][ j ];
@@ -540,6 +759,7 @@ System::System( const System &sd ) {
 			pbc.reciprocal_basis[ i ][ j ] = sd.pbc.reciprocal_basis[ i ][ j ]; // reciprocal space lattice (1/A)
 		}
 	}
+	pbc.classify_cell();
 	
 	// RNG
 	preset_seed_on                = sd.preset_seed_on; //for manual specification of random seeds
@@ -567,6 +787,14 @@ System::System( const System &sd ) {
 	rd_lrc                        = sd.rd_lrc;
 	rd_crystal                    = sd.rd_crystal;
 	rd_crystal_order              = sd.rd_crystal_order;
+	rd_crystal_ewald              = sd.rd_crystal_ewald;
+	rd_crystal_ewald_tolerance    = sd.rd_crystal_ewald_tolerance;
+
+	// Delta-energy evaluation of single-molecule moves
+	use_delta_energy              = sd.use_delta_energy;
+	delta_energy_refresh          = sd.delta_energy_refresh;
+	delta_energy_count            = 0;
+	pair_energies_stale           = 0;
 
 	// uVT Fugacity Functions
 	h2_fugacity                   = sd.h2_fugacity; 
@@ -581,6 +809,7 @@ System::System( const System &sd ) {
 	rd_anharmonic_k               = sd.rd_anharmonic_k; 
 	rd_anharmonic_g               = sd.rd_anharmonic_g;
 	using_axilrod_teller          = sd.using_axilrod_teller;
+	axilrod_teller_cutoff         = sd.axilrod_teller_cutoff;
 	c6_mixing                     = sd.c6_mixing; 
 	damp_dispersion               = sd.damp_dispersion;
 	using_disp_expansion          = sd.using_disp_expansion;
@@ -601,8 +830,13 @@ System::System( const System &sd ) {
 	wolf                          = sd.wolf;
 	ewald_alpha_set               = sd.ewald_alpha_set;
 	ewald_kmax                    = sd.ewald_kmax;
+	ewald_spme                    = sd.ewald_spme;
+	ewald_retune                  = sd.ewald_retune;
 	polar_ewald_alpha_set         = sd.polar_ewald_alpha_set;
 	ewald_alpha                   = sd.ewald_alpha;
+	ewald_spme_tolerance          = sd.ewald_spme_tolerance;
+	ewald_precision               = sd.ewald_precision;
+	ewald_tuned_volume            = sd.ewald_tuned_volume;
 	polar_ewald_alpha             = sd.polar_ewald_alpha;
 	
 	// Thole Options
@@ -633,7 +867,6 @@ System::System( const System &sd ) {
 	field_damp                    = sd.field_damp;
 	polar_precision               = sd.polar_precision;
 	polar_wolf_alpha_lookup_cutoff= sd.polar_wolf_alpha_lookup_cutoff;
-	polar_wolf_alpha_table_max    = sd.polar_wolf_alpha_table_max; //stores the total size of the array
 	damp_type                     = sd.damp_type;
 	
 
@@ -735,10 +968,8 @@ System::System( const System &sd ) {
 	atom_array                    = nullptr;
 	molecule_array                = nullptr;
 	molecules                     = nullptr;
-	polar_wolf_alpha_table        = nullptr;
 	A_matrix                      = nullptr;
 	B_matrix                      = nullptr;
-	vdw_eiso_info                 = nullptr;
 	insertion_molecules           = nullptr;
 	insertion_molecules_array     = nullptr;
 
@@ -1024,7 +1255,7 @@ void System::read_molecules( FILE *fp ) {
 				atom_ptr = molecule_ptr->atoms;
 			}
 
-			strcpy(molecule_ptr->moleculetype, token_moleculetype);
+			molecule_ptr->moleculetype_id = TypeRegistry::molecule_type( token_moleculetype );
 
 			molecule_ptr->id        = current_moleculeid;
 			molecule_ptr->frozen    = current_frozen;
@@ -1066,8 +1297,7 @@ void System::read_molecules( FILE *fp ) {
 			atom_ptr->c8             = current_c8;
 			atom_ptr->c10            = current_c10;
 			atom_ptr->c9             = current_c9;
-			std::memset( atom_ptr->atomtype, 0, maxLine );
-			strcpy( atom_ptr->atomtype, token_atomtype );
+			atom_ptr->atomtype_id    = TypeRegistry::atom_type( token_atomtype );
 			if(current_gwp_alpha != 0.)
 				atom_ptr->gwp_spin = 1;
 			else
@@ -1212,14 +1442,12 @@ void System::update_pbc() {
 */
 
 	// compute the unit cell volume, cutoff and reciprocal space lattice vectors
-	pbc.compute_volume;
-	if (pbc.cutoff == 0.) pbc.compute_cutoff;
-	pbc.compute_reciprocal;
+	pbc.update();
 
-	// calculate ewald_alpha and polar_ewald_alpha unless manually set
-	if (ewald_alpha_set != 1)
+	// calculate ewald_alpha and polar_ewald_alpha unless manually set (or left to ewald_tune())
+	if (ewald_alpha_set != 1 && ewald_precision <= 0)
 		ewald_alpha = 3.5 / pbc.cutoff;
-	if (polar_ewald_alpha_set != 1)
+	if (polar_ewald_alpha_set != 1 && ewald_precision <= 0)
 		polar_ewald_alpha = 3.5 / pbc.cutoff;
 	
 }
@@ -1304,6 +1532,7 @@ void System::pairs() {
 
 	int n;
 	Pair *pair_ptr;
+	bool cull, same_grid, partial, lists_changed = (pair_lists_changed != 0);
 	
 	// needed for GS ranking metric
 	double rmin;
@@ -1312,39 +1541,40 @@ void System::pairs() {
 	rebuild_arrays();
 	n = natoms;
 
-	// loop over all atoms and pair
-	for( int i = 0; i < (n - 1); i++) {
-		pair_ptr = atom_array[i]->pairs;
-		for( int j = (i + 1); j < n; j++ ) {
-
-			// set the link 
-			pair_ptr->atom     = atom_array[j];
-			pair_ptr->molecule = molecule_array[j];
-
-			// this:
-			//
-			//     if ( !pair_ptr->frozen && !(pair_ptr->rd_excluded && pair_ptr->es_excluded) ) { pair_exculsions(...); }
-			//
-			// is dangerous and has already been responsible for numerous bugs, most recently in UVT runs.
-			// After an insert/remove move there is no guarantee that pair_ptr->rd_excluded is properly set.
-			
-			pair_exclusions( molecule_array[i], molecule_array[j], atom_array[i], atom_array[j], pair_ptr );
-
-			// recalc min image (the induced-induced interaction is needed for frozen atoms)
-			if( !pair_ptr->frozen || polarization )
-				minimum_image( atom_array[i], atom_array[j], pair_ptr );
-
-			pair_ptr = pair_ptr->next;
+	// bin the atoms so that distant pairs can be dismissed without imaging them. When the pair
+	// lists have just been reallocated, the stored exclusions/mixing are stale for every pair,
+	// so we do one full sweep before culling again.
+	cull      = cell_list && !pair_lists_changed;
+	same_grid = cull && cell_list_build();
+
+	// if every move since the last sweep has marked the molecules it perturbed, only the pairs
+	// involving those molecules (and any pairs left flagged by the last sweep) need revisiting
+	partial = dirty_tracking && !pairs_sweep_all && !pair_lists_changed && (n == pairs_natoms);
+
+	// once a sweep has culled every pair by this grid, only the pairs in neighboring cells (and
+	// those that have just left them) are visited
+	if( same_grid && cell_list_culled && !pairs_sweep_all && (n == pairs_natoms) )
+		pairs_cell_sweep( partial );
+	else if( partial )
+		pairs_dirty_sweep( cull );
+	else
+		pairs_full_sweep( cull );
+	cell_list_culled   = cull;
+	pair_lists_changed = 0;
 
-		} // for j
-	} // for i
+	// refresh the neighbor lists now that every image separation is current
+	if( verlet_list )
+		verlet_list_update( lists_changed );
 
 
 	// update the Center-of-Masa of each molecule
-	update_com();
+	update_com( partial );
 
 	// store wrapped coords
-	wrap_all();
+	wrap_all( partial );
+
+	for( Molecule *molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next )
+		molecule_ptr->dirty = 0;
 
 	// rank metric 
 	if( polar_iterative && polar_gs_ranked ) {
@@ -1381,6 +1611,288 @@ void System::pairs() {
 
 
 
+void System::pairs_full_sweep( bool cull ) {
+// Visit every stored pair.
+
+	int n        = natoms,
+	    n_mobile = 0;
+
+	if( n > pairs_natoms_allocd ) {
+		SafeOps::realloc( pairs_visit,         n * sizeof(char),      __LINE__, __FILE__ );
+		SafeOps::realloc( pairs_mobile,        n * sizeof(int),       __LINE__, __FILE__ );
+		SafeOps::realloc( pairs_mobile_before, (n + 1) * sizeof(int), __LINE__, __FILE__ );
+		image_batch.reserve( n );
+		pairs_natoms_allocd = n;
+	}
+
+	// index the non-frozen atoms, through which the lists of frozen atoms are addressed
+	for( int i = 0; i < n; i++ ) {
+		pairs_mobile_before[i] = n_mobile;
+		if( ! atom_array[i]->frozen )
+			pairs_mobile[ n_mobile++ ] = i;
+	}
+	pairs_mobile_before[n] = n_mobile;
+
+	// every flag is about to be reset anyway
+	pairs_nflagged  = 0;
+	pairs_sweep_all = 0;
+
+	// loop over all atoms and pair
+	for( int i = 0; i < (n - 1); i++)
+		pairs_row_sweep( i, cull );
+
+	pairs_natoms = n;
+}
+
+
+
+
+void System::pairs_dirty_sweep( bool cull ) {
+// Visit only the pairs with an endpoint in a dirty molecule. Flags raised by the last sweep are
+// lowered first; the pairs that have moved again get them raised anew.
+
+	int n = natoms;
+
+	for( size_t f = 0; f < pairs_nflagged; f++ ) {
+		int i = pairs_flagged[2*f],
+		    j = pairs_flagged[2*f + 1];
+		pair_node( i, j )->recalculate_energy = 0;
+	}
+	pairs_nflagged = 0;
+
+	for( int i = 0; i < n; i++ )
+		pairs_visit[i] = molecule_array[i]->dirty;
+
+	for( int i = 0; i < n; i++ ) {
+		if( ! pairs_visit[i] )
+			continue;
+
+		pairs_row_sweep( i, cull );
+
+		// pairs (k,i) owned by atoms that are visited themselves are handled in their rows
+		image_batch.n = 0;
+		for( int k = 0; k < i; k++ ) {
+			if( pairs_visit[k] )
+				continue;
+			if( skip_frozen_pairs && atom_array[k]->frozen && atom_array[i]->frozen )
+				continue;
+			if( pair_update( k, i, pair_node(k, i), cull ) )
+				image_batch.push( atom_array[k]->pos, k );
+		}
+		pairs_image_batch( i, true );
+	}
+}
+
+
+
+
+void System::pairs_cell_sweep( bool dirty_only ) {
+// Visit the pairs with an endpoint in a dirty molecule (or in any molecule, without dirty_only) by way
+// of the cell list. The pairs in neighboring cells are updated, as are the intra-molecular pairs, and
+// an atom that changed cells has its pairs with its old neighbors culled. Every other pair was culled
+// by an earlier sweep and is never visited. Flags raised by the last sweep are lowered first.
+
+	int n = natoms,
+	    cells[27],
+	    ncells;
+
+	for( size_t f = 0; f < pairs_nflagged; f++ ) {
+		int i = pairs_flagged[2*f],
+		    j = pairs_flagged[2*f + 1];
+		pair_node( i, j )->recalculate_energy = 0;
+	}
+	pairs_nflagged = 0;
+
+	for( int i = 0; i < n; i++ )
+		pairs_visit[i] = dirty_only ? molecule_array[i]->dirty : 1;
+
+	for( int i = 0; i < n; i++ ) {
+		if( ! pairs_visit[i] )
+			continue;
+
+		bool frozen = skip_frozen_pairs && atom_array[i]->frozen;  // then only pairs with mobile atoms are stored
+
+		ncells = cell_list_neighbor_cells( cell_list_cell[i], cells );
+
+		// pairs (i,j) in neighboring cells, and the rest of the molecule, which is never culled
+		image_batch.n = 0;
+		for( int c = 0; c < ncells; c++ ) {
+			for( int j = cell_list_head[ cells[c] ]; j >= 0; j = cell_list_next[j] ) {
+				if( (j <= i)  ||  (frozen && atom_array[j]->frozen) )
+					continue;
+				if( pair_update( i, j, pair_node(i, j), true ) )
+					image_batch.push( atom_array[j]->pos, j );
+			}
+		}
+		for( int j = i + 1; (j < n) && (molecule_array[j] == molecule_array[i]); j++ ) {
+			if( cell_list_neighbors(i, j)  ||  (frozen && atom_array[j]->frozen) )
+				continue;
+			if( pair_update( i, j, pair_node(i, j), true ) )
+				image_batch.push( atom_array[j]->pos, j );
+		}
+		pairs_image_batch( i, false );
+
+		// pairs (k,i) in neighboring cells. If k is visited itself, it has taken the pair up already.
+		image_batch.n = 0;
+		for( int c = 0; c < ncells; c++ ) {
+			for( int k = cell_list_head[ cells[c] ]; k >= 0; k = cell_list_next[k] ) {
+				if( (k >= i)  ||  pairs_visit[k]  ||  (frozen && atom_array[k]->frozen) )
+					continue;
+				if( pair_update( k, i, pair_node(k, i), true ) )
+					image_batch.push( atom_array[k]->pos, k );
+			}
+		}
+		pairs_image_batch( i, true );
+
+		if( cell_list_prev_cell[i] == cell_list_cell[i] )
+			continue;
+
+		// the atom has changed cells: cull its pairs with the atoms of its old neighborhood that are no
+		// longer neighbors. Were both atoms visited and moved, the first of them culls the pair.
+		ncells = cell_list_neighbor_cells( cell_list_prev_cell[i], cells );
+		for( int c = 0; c < ncells; c++ ) {
+			for( int j = cell_list_prev_head[ cells[c] ]; j >= 0; j = cell_list_prev_next[j] ) {
+				if( (j == i)  ||  (molecule_array[j] == molecule_array[i])  ||  cell_list_neighbors(i, j) )
+					continue;
+				if( (j < i)  &&  pairs_visit[j]  &&  (cell_list_prev_cell[j] != cell_list_cell[j]) )
+					continue;
+				if( frozen && atom_array[j]->frozen )
+					continue;
+				if( j > i )
+					pair_update( i, j, pair_node(i, j), true );
+				else
+					pair_update( j, i, pair_node(j, i), true );
+			}
+		}
+	}
+}
+
+
+
+
+void System::pairs_row_sweep( int i, bool cull ) {
+// Visit every stored pair in atom_array[i]'s list.
+
+	Pair * pair_ptr = atom_array[i]->pairs;
+	int    j;
+
+	// queue up the pairs that need imaging, and then image them all at once
+	image_batch.n = 0;
+	if( skip_frozen_pairs && atom_array[i]->frozen ) {
+		for( int m = pairs_mobile_before[i+1]; m < pairs_mobile_before[natoms]; m++ ) {
+			j = pairs_mobile[m];
+			if( pair_update( i, j, pair_ptr++, cull ) )
+				image_batch.push( atom_array[j]->pos, j );
+		}
+	} else {
+		for( j = (i + 1); j < natoms; j++ )
+			if( pair_update( i, j, pair_ptr++, cull ) )
+				image_batch.push( atom_array[j]->pos, j );
+	}
+	pairs_image_batch( i, false );
+}
+
+
+
+
+void System::pairs_image_batch( int i, bool column ) {
+// Image atom_array[i] against every atom queued in image_batch, then store and flag the pairs as
+// minimum_image() would have. The pairs are (i,j) for each queued j, or (j,i) with column.
+
+	Pair * pair_ptr;
+	int    j;
+
+	if( ! image_batch.n )
+		return;
+
+	pbc.image_batch( atom_array[i]->pos, image_batch );
+
+	for( int k = 0; k < image_batch.n; k++ ) {
+		j = image_batch.index[k];
+		if( column ) {
+			pair_ptr = pair_node( j, i );
+			minimum_image_store( pair_ptr, image_batch, k, -1.0 );
+			pair_flag( j, i, pair_ptr );
+		} else {
+			pair_ptr = pair_node( i, j );
+			minimum_image_store( pair_ptr, image_batch, k, 1.0 );
+			pair_flag( i, j, pair_ptr );
+		}
+	}
+}
+
+
+
+
+Pair * System::pair_node( int i, int j ) {
+// The stored pair between atom_array[i] and atom_array[j], i < j. Only valid once pairs_full_sweep()
+// has indexed the current atom_array.
+
+	if( skip_frozen_pairs && atom_array[i]->frozen )
+		return atom_array[i]->pairs + (pairs_mobile_before[j] - pairs_mobile_before[i+1]);
+	return atom_array[i]->pairs + (j - i - 1);
+}
+
+
+
+
+bool System::pair_update( int i, int j, Pair *pair_ptr, bool cull ) {
+// Refresh the links and exclusions of the pair between atom_array[i] and atom_array[j]. Returns true
+// if its image separation needs refreshing too, which is left to the caller (see pairs_image_batch()).
+
+	// The exclusions and mixed parameters only change along with the atoms in the pairing, i.e. when
+	// the lists have been resized (insert/remove, where every entry may now describe a different
+	// pair) or when restore() has linked in copies of a molecule's atoms. Otherwise they are left be.
+	// A culled pair may have missed any number of copies, so its molecule is checked as well.
+	if( (pair_ptr->atom != atom_array[j])  ||  (pair_ptr->molecule != molecule_array[j])  ||  pair_lists_changed  ||  spectre ) {
+		pair_ptr->atom     = atom_array[j];
+		pair_ptr->molecule = molecule_array[j];
+		mixing_table_apply( molecule_array[i], molecule_array[j], atom_array[i], atom_array[j], pair_ptr );
+	}
+
+	// pairs in non-neighboring cells are beyond the cutoff. intra-molecular pairs are always
+	// kept, since the self-interaction terms need their true separations.
+	if( cull && !pair_ptr->frozen && (molecule_array[i] != molecule_array[j]) && !cell_list_neighbors(i, j) ) {
+		cell_list_cull( pair_ptr );
+	} else {
+		pair_ptr->culled = 0;
+
+		// recalc min image (the induced-induced interaction is needed for frozen atoms)
+		if( !pair_ptr->frozen || polarization )
+			return true;
+		pair_ptr->recalculate_energy = 0; // frozen pairs never change, and any flagged energy has been consumed
+	}
+
+	pair_flag( i, j, pair_ptr );
+	return false;
+}
+
+
+
+
+void System::pair_flag( int i, int j, Pair *pair_ptr ) {
+// Remember a raised recalculate flag, so that the next partial sweep can lower it. If too many are
+// raised, just have the next pairs() visit everything.
+
+	if( ! pair_ptr->recalculate_energy  ||  pairs_sweep_all )
+		return;
+
+	if( pairs_nflagged == pairs_flagged_allocd ) {
+		if( pairs_flagged_allocd >= (size_t) pairs_flagged_per_atom * natoms ) {
+			pairs_sweep_all = 1;
+			return;
+		}
+		pairs_flagged_allocd = pairs_flagged_allocd ? 2*pairs_flagged_allocd : 1024;
+		SafeOps::realloc( pairs_flagged, pairs_flagged_allocd * 2 * sizeof(int), __LINE__, __FILE__ );
+	}
+	pairs_flagged[ 2*pairs_nflagged     ] = i;
+	pairs_flagged[ 2*pairs_nflagged + 1 ] = j;
+	pairs_nflagged++;
+}
+
+
+
+
 void System::pair_exclusions( Molecule *molecule_i, Molecule *molecule_j, Atom *atom_i, Atom *atom_j, Pair *pair_ptr) {
 // set the exclusions and LJ mixing for relevant pairs 
 
@@ -1567,27 +2079,12 @@ void System::minimum_image( Atom *atom_i, Atom *atom_j, Pair *pair_ptr ) {
 	if( pair_ptr->recalculate_energy == 0 )
 		return;
 
-	// Matrix multiply:
-	// Project the displacement vector into the reciprocal basis and round 
-	for( int p = 0; p < 3; p++ ) {
-		img[p] = 0;
-		for( int q = 0; q < 3; q++ ) {
-			img[p] += pbc.reciprocal_basis[q][p] * d[q];
-		}
-		
-		img[p] = rint(img[p]);
-	}
-	
-	// Matrix multiply to project back into our basis 
-	for( int p = 0; p < 3; p++) {
-		di[p] = 0;
-		for( int q = 0; q < 3; q++)
-			di[p] += pbc.basis[q][p] * img[q];
-	}
+	// find the nearest lattice vector (a per-axis rounding for orthorhombic cells)
+	pbc.image_offset( d, img );
 
 	// correct the displacement
 	for( int p = 0; p < 3; p++ )
-		di[p] = d[p] - di[p];
+		di[p] = d[p] - img[p];
 
 
 	// pythagorean terms 
@@ -1625,6 +2122,34 @@ void System::minimum_image( Atom *atom_i, Atom *atom_j, Pair *pair_ptr ) {
 
 
 
+void System::minimum_image_store( Pair *pair_ptr, const ImageBatch &batch, int k, double sign ) {
+// minimum_image(), for a pair imaged by PeriodicBoundary::image_batch(). A sign of -1 stores the
+// reverse of the batched displacement, for pairs whose owner was the batch's partner.
+
+	double d[3] = { sign * batch.dx[k], sign * batch.dy[k], sign * batch.dz[k] };
+
+	pair_ptr->recalculate_energy = 0;
+	for( int p = 0; p < 3; p++ ) {
+		if( d[p] != pair_ptr->d_prev[p] ) {
+			pair_ptr->recalculate_energy = 1;
+			pair_ptr->d_prev[p] = d[p];
+		}
+	}
+
+	//relative position didn't change. nothing to do here.
+	if( pair_ptr->recalculate_energy == 0 )
+		return;
+
+	pair_ptr->r       = batch.r   [k];
+	pair_ptr->rimg    = batch.rimg[k];
+	pair_ptr->dimg[0] = sign * batch.ix[k];
+	pair_ptr->dimg[1] = sign * batch.iy[k];
+	pair_ptr->dimg[2] = sign * batch.iz[k];
+}
+
+
+
+
 void System::flag_all_pairs() {
 // flag all pairs to have their energy calculated. 
 // flag_all_pairs() needs to be called at simulation start, or can 
@@ -1638,6 +2163,9 @@ void System::flag_all_pairs() {
 		for(atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next)
 			for(pair_ptr = atom_ptr->pairs; pair_ptr; pair_ptr = pair_ptr->next)
 				pair_ptr->recalculate_energy = 1;
+
+	// every flag is now raised, so the next pairs() must visit everything to lower them
+	pairs_sweep_all = 1;
 }
 
 
@@ -1688,15 +2216,19 @@ void System::spectre_wrapall() {
 
 
 
-void System::update_com() {
+void System::update_com( bool dirty_only ) {
 // Computes and updates molecular center of mass for each molecule in the system.
-// (spectre and "target" molecules excluded)
+// (spectre and "target" molecules excluded). With dirty_only, molecules that have
+// not been perturbed since the last call are skipped.
 
 	Molecule * molecule_ptr = molecules;
 	Atom * atom_ptr;
 
 	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
 
+		if( dirty_only && !molecule_ptr->dirty )
+			continue;
+
 		for(int i = 0; i < 3; i++)
 			molecule_ptr->com[i] = 0;
 
@@ -1720,34 +2252,27 @@ void System::update_com() {
 
 
 
-int System::wrap_all() {
+int System::wrap_all( bool dirty_only ) {
 // Stores PBC-wrapped coords for each (non-Frozen) molecule and
 // adjusts the wrappped position of each atom found therein.
+// With dirty_only, only molecules perturbed since the last call are visited.
 
 	Molecule * molecule_ptr;
 	Atom * atom_ptr;
-	double d[3], dimg[3];
+	double dimg[3];
 
 	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
 
+		if( dirty_only && !molecule_ptr->dirty )
+			continue;
+
 		if(  ! molecule_ptr->frozen  ) {
 			// get the minimum imaging distance for the com 
-			for( int i = 0; i < 3; i++) {
-				d[i] = 0;
-				for( int j = 0; j < 3; j++) {
-					d[i] += pbc.reciprocal_basis[j][i] * molecule_ptr->com[j];
-				}
-				d[i] = rint(d[i]);
-			}
+			pbc.image_offset( molecule_ptr->com, dimg );
 
-			for( int i = 0; i < 3; i++) {
-				dimg[i] = 0;
-				for( int j = 0; j < 3; j++)
-					dimg[i] += pbc.basis[j][i]*d[j];
-
-				// store the wrapped com coordinate 
+			// store the wrapped com coordinate 
+			for( int i = 0; i < 3; i++)
 				molecule_ptr->wrapped_com[i] = dimg[i];
-			}
 
 			// apply the distance to all of the atoms of this molecule 
 			for(atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
@@ -1759,18 +2284,7 @@ int System::wrap_all() {
 
 			// don't wrap frozen 
 			for( atom_ptr = molecule_ptr->atoms; atom_ptr; atom_ptr = atom_ptr->next) {
-				for (int i = 0; i < 3; i++) {
-					d[i] = 0;
-					for (int j = 0; j < 3; j++) {
-						d[i] += pbc.reciprocal_basis[j][i] * atom_ptr->pos[j];
-					}
-					d[i] = rint(d[i]);
-				}
-				for (int i = 0; i < 3; i++) {
-					dimg[i] = 0;
-					for (int j = 0; j < 3; j++)
-						dimg[i] += pbc.basis[j][i] * d[j];
-				}
+				pbc.image_offset( atom_ptr->pos, dimg );
 				for (int i = 0; i < 3; i++)
 					atom_ptr->wrapped_pos[i] = atom_ptr->pos[i] - dimg[i];
 			}
@@ -1920,11 +2434,35 @@ void System::count_sorbates() {
 
 	// Count each sorbate in the system and record the total in the corresponding entry in the sorbate averages list.
 	for( molecule_ptr = molecules; molecule_ptr; molecule_ptr = molecule_ptr->next ) {
-		for ( i=0; i<sorbateCount; i++ ) {
-			if( SafeOps::iequals( sorbateInfo[i].id, molecule_ptr->moleculetype )) {
-				sorbateInfo[i].currN++;
+		i = sorbate_index( molecule_ptr );
+		if( i >= 0 )
+			sorbateInfo[i].currN++;
+	}
+}
+
+
+
+
+int System::sorbate_index( const Molecule *molecule ) {
+// Returns the index into sorbateInfo of molecule's sorbate, or -1 if it is not one of them. The names
+// are only compared the first time a molecule type is seen.
+
+	int t = molecule->moleculetype_id;
+
+	if( t >= (int) sorbate_of_moleculetype.size() )
+		sorbate_of_moleculetype.resize( TypeRegistry::molecule_type_count(), -2 );
+
+	if( sorbate_of_moleculetype[t] == -2 ) {
+		sorbate_of_moleculetype[t] = -1;
+		for( int i = 0; i < sorbateCount; i++ ) {
+			if( SafeOps::iequals( sorbateInfo[i].id, molecule->moleculetype() )) {
+				sorbate_of_moleculetype[t] = i;
 				break;
-	}}}
+			}
+		}
+	}
+
+	return sorbate_of_moleculetype[t];
 }
 
 
@@ -1996,7 +2534,7 @@ int System::printAtoms() {
 		sprintf(linebuf, "\nMOLECULE %d\n", molCount);
 		Output::out(linebuf);
 		for( a=m->atoms; a; a=a->next) {
-			sprintf(linebuf, "M%0dA%0d: (%s)   %lf, %lf, %lf\n", molCount, atomNum, a->atomtype, a->pos[0], a->pos[1], a->pos[2]);
+			sprintf(linebuf, "M%0dA%0d: (%s)   %lf, %lf, %lf\n", molCount, atomNum, a->atomtype(), a->pos[0], a->pos[1], a->pos[2]);
 			Output::out(linebuf);
 		}
 		Output::out("\n");
@@ -4,16 +4,20 @@
 #ifdef _MPI
 	#include <mpi.h>
 #endif
+#include <math.h>
 #include <random>
 #include <stdint.h>
 #include <vector>
 
 class Atom;
 class Pair;
+struct PairPassConstants;
 
 #include "constants.h"
+#include "FFT.h"
 #include "Molecule.h"
 #include "PeriodicBoundary.h"
+#include "SplineTable.h"
 
 
 
@@ -97,7 +101,10 @@ public:
 		       NU,
 		       spin_ratio,         // ortho:para spin ratio 
 		       frozen_mass,
-		       total_mass;         //updated in average.c
+		       total_mass,         //updated in average.c
+		       kspace_energy,      // Ewald reciprocal + self part of coulombic_energy
+		       rd_energy_carry,    // compensation terms for the running totals kept by delta_energy()
+		       coulombic_energy_carry;
 	} observables_t;
 
 	typedef struct _checkpoint {
@@ -211,13 +218,6 @@ public:
 		double density;
 	} sorbateInfo_t;
 
-	//stores vdw energies for each molecule within the coupled dipole model
-	typedef struct _vdw {
-		char mtype[maxLine];
-		double energy;
-		struct _vdw * next;
-	} vdw_t;
-
 	typedef struct _mtx {
 		int dim;
 		double * val;
@@ -261,17 +261,27 @@ public:
 	void countN();
 	int  countNatoms();
 	void pairs();
+	void pairs_full_sweep( bool cull );
+	void pairs_dirty_sweep( bool cull );
+	void pairs_cell_sweep( bool dirty_only );
+	void pairs_row_sweep( int i, bool cull );
+	void pairs_image_batch( int i, bool column );
+	Pair * pair_node( int i, int j );
+	bool pair_update( int i, int j, Pair *pair_ptr, bool cull );
+	void pair_flag( int i, int j, Pair *pair_ptr );
 	void pair_exclusions( Molecule *molecule_i, Molecule *molecule_j, Atom *atom_i, Atom *atom_j, Pair *pair_ptr);
 	void minimum_image( Atom *atom_i, Atom *atom_j, Pair *pair_ptr );
+	void minimum_image_store( Pair *pair_ptr, const ImageBatch &batch, int k, double sign );
 	void flag_all_pairs();
 	void spectre_wrapall();
-	void update_com();
-	int  wrap_all();
+	void update_com( bool dirty_only );
+	int  wrap_all( bool dirty_only );
 	double get_rand();
 	int calculate_bonds();
 	int bondlength_check( Atom *atom1, Atom *atom2 );
 	void calc_system_mass();
 	void count_sorbates();
+	int  sorbate_index( const Molecule *molecule );
 	void allocateStatisticsMem();
 	void car2basis(double a, double b, double c, double alpha, double beta, double gamma);
 	
@@ -294,8 +304,24 @@ public:
 	double cavity_absolute_check();
 	
 
+	// System.CellList.cpp
+	bool cell_list_build();
+	int  cell_list_neighbor_cells( int c, int *cells );
+	bool cell_list_neighbors( int i, int j );
+	void cell_list_cull( Pair *pair_ptr );
+	void cell_list_free();
+
+
+	// System.DeltaEnergy.cpp
+	double delta_energy( Molecule *molecule );
+	bool   delta_energy_supported();
+	void   delta_energy_molecule( Molecule *molecule, Molecule *skip, bool intra, double &rd, double &es );
+	void   delta_energy_pair( Molecule *molecule_i, Atom *atom_i, Molecule *molecule_j, Atom *atom_j, int k, bool lrc, double &rd, double &es );
+	
+
 	// System.Energy.cpp
 	double energy();
+	void   update_energy_observables( double potential_energy );
 		
 	double * getsqrtKinv( int N );
 	double sum_eiso_vdw ( double * sqrtKinv );
@@ -314,8 +340,8 @@ public:
 	double vdw();
 	double fh_vdw_corr();
 	double fh_vdw_corr_2be();
-	static void free_vdw_eiso( vdw_t * vdw_eiso_info );
 	double lr_vdw_corr();
+	double lr_vdw_pair( const Atom *atom_ptr, const Atom *other_ptr, const Pair *pair_ptr );
 	
 	double anharmonic();
 	static double anharmonic_energy(double k, double g, double x);
@@ -324,8 +350,28 @@ public:
 	static double anharmonic_fh_fourth_order(double temperature, double mass, double k, double g, double x);
 	
 
-	// System.Energy.AxilrodTeller.cpp
-	double axilrod_teller ();
+	// System.AxilrodTeller.cpp
+	double axilrod_teller();
+	double axilrod_teller_full();
+	double axilrod_teller_molecule( Molecule *molecule, Molecule *skip );
+	void   axilrod_teller_move_made();
+	void   axilrod_teller_restore();
+	void   axilrod_teller_accept();
+	void   axilrod_teller_init();
+	void   axilrod_teller_free();
+	int    at_gather( Molecule *molecule, Molecule *skip );
+	int    at_gather_molecule( Molecule *molecule, int n );
+	void   at_neighbors( int n );
+	bool   at_bin( int n );
+	int    at_cell_around( int i, int k );
+	void   at_separation( const Atom *atom_i, const Atom *atom_j, double *d, double &r );
+	void   at_nbr_reserve( int count );
+	int    at_nbr_add( int count, int i, int j );
+	int    at_type_intern( const Atom *atom );
+	double at_c9_mix( int u, int v, int w );
+	inline double at_c9_lookup( int u, int v, int w ) const {
+		return at_c9[ (u*at_ntypes + v)*at_ntypes + w ];
+	}
 	
 
 	// System.Energy.Coulombic.cpp
@@ -334,6 +380,7 @@ public:
 	static double coulombic_nopbc( Molecule * molecules );
 	double coulombic_nopbc_gwp();
 	double coulombic_real();
+	void   coulombic_real_pair( Molecule * molecule_ptr, Atom * atom_ptr, Pair * pair_ptr );
 	double coulombic_real_FH( Molecule * molecule_ptr, Pair *pair_ptr, double gaussian_term, double erfc_term );
 	double coulombic_reciprocal();
 	double coulombic_self();
@@ -345,6 +392,7 @@ public:
 	static double tt_damping(int n, double br);
 	double disp_expansion_lrc_self( Atom * atom_ptr, const double cutoff );
 	double disp_expansion_lrc( Pair * pair_ptr, const double cutoff );
+	static double disp_expansion_kernel( double r, const double *param );
 	double exp_fh_corr( Molecule * molecule_ptr, Pair * pair_ptr, int order, double pot );
 	double exp_crystal_self( Atom * aptr, double cutoff );
 	double exp_lrc_self( Atom * atom_ptr, double cutoff );
@@ -353,25 +401,170 @@ public:
 	//System.Energy.Dreiding.cpp
 	double dreiding();
 	static double dreiding_nopbc( Molecule *molecules ); 
+	static double dreiding_kernel( double r, const double *param );
 	
 
 	// System.Energy.ExpRepulsion.cpp
 	double exp_repulsion();
+	void   exp_repulsion_pair( Molecule * molecule_ptr, Atom * atom_ptr, Pair * pair_ptr, double cutoff );
 	double exp_lrc_corr( Atom * atom_ptr,  Pair * pair_ptr, double cutoff );
+	static double exp_repulsion_kernel( double r, const double *param );
 	
 
 	// System.Energy.LJ.cpp
 	double lj();
+	void   lj_pair( Molecule * molecule_ptr, Atom * atom_ptr, Pair * pair_ptr, double cutoff );
 	double lj_lrc_corr( Atom * atom_ptr,  Pair * pair_ptr, double cutoff );
 	double lj_fh_corr( Molecule * molecule_ptr, Pair * pair_ptr, int order, double term12, double term6 );
 	double rd_crystal_self( Atom * aptr, double cutoff );
 	double lj_lrc_self( Atom * atom_ptr, double cutoff );
 	double lj_buffered_14_7();
 	double lj_buffered_14_7_nopbc();
+	static double lj_buffered_14_7_kernel( double r, const double *param );
+
+	// System.EnergyPipeline.cpp
+	typedef void (System::*energy_pipeline_fn)( double &rd_energy, double &coulombic_energy );
+	void energy_pipeline_select();
+	template< int RD, int ES, int FH, bool LRC > void energy_pipeline_run( double &rd_energy, double &coulombic_energy );
+	template< int RD, int ES, int FH, bool LRC > void   pair_pass( double &rd_energy, double &es_real_energy );
+	template< int RD, int FH >                   void   rd_pair( Molecule *molecule_ptr, Atom *atom_ptr, Pair *pair_ptr, double cutoff );
+	template< int ES, int FH >                   double es_field_pair( Molecule *molecule_ptr, Atom *atom_ptr, Pair *pair_ptr, const PairPassConstants &k );
+	template< int FH >                           void   coulombic_real_pair_fh( Molecule *molecule_ptr, Atom *atom_ptr, Pair *pair_ptr );
+	void ef_static_pass_begin( PairPassConstants &k );
+	void ef_static_pair( Molecule *molecule_ptr, Atom *atom_ptr, Pair *pair_ptr, const PairPassConstants &k );
+
+	// System.LJBlock.cpp
+	bool   lj_block_supported();
+	double lj_block_queue( Pair *pair_ptr, double cutoff );
+	double lj_block_flush();
+	void   lj_block_free();
+
+	// System.EwaldKSpace.cpp
+	void   ewald_kvectors_update();
+	int    ewald_phases_begin( bool charged_only, Molecule *only = nullptr );
+	void   ewald_phases_at( int kk );
+	void   ewald_sf_sum();
+	void   ewald_sf_update();
+	void   ewald_sf_add_molecule( Molecule *molecule, double sign );
+	void   ewald_sf_move_made();
+	void   ewald_sf_restore();
+	void   ewald_sf_accept();
+	void   ewald_sf_reserve();
+	void   ewald_kspace_init();
+	void   ewald_kspace_free();
+
+	// System.DispersionEwald.cpp
+	void   rd_ewald_pair( Atom *atom_ptr, Pair *pair_ptr );
+	double rd_ewald_reciprocal();
+	void   rd_ewald_update();
+	void   rd_ewald_init();
+	void   rd_ewald_free();
+
+	// System.EwaldTuning.cpp
+	void   ewald_tune();
+	bool   ewald_tune_check();
+	double ewald_time_evaluation();
+
+	// System.SPME.cpp
+	double spme_reciprocal();
+	void   spme_update();
+	int    spme_splines( bool charged_only, bool derivatives = false );
+	void   spme_spread_charges();
+	void   spme_spread_dipoles();
+	void   spme_convolve( const double *influence );
+	void   spme_field( int j, double *field );
+	void   spme_recip_field();
+	void   spme_induced_field();
+	void   spme_init();
+	void   spme_free();
+
+	// System.SplineTables.cpp
+	void   spline_tables_init();
+
+	// erfc(x), erf(x) and exp(-x), from the spline tables when they are in use
+	inline double erfc_lookup( double x ) {
+		return (spline_erfc.built() && spline_erfc.covers(x)) ? spline_erfc(x) : erfc(x);
+	}
+	inline double erf_lookup( double x ) {
+		return (spline_erfc.built() && spline_erfc.covers(x)) ? 1.0 - spline_erfc(x) : erf(x);
+	}
+	inline double exp_neg_lookup( double x ) {
+		return (spline_exp.built() && spline_exp.covers(x)) ? spline_exp(x) : exp(-x);
+	}
+
+	// System.TailCorrection.cpp
+	void   lrc_counts_reset();
+	void   lrc_counts_add( Molecule *molecule, int sign );
+	void   lrc_terms_update( int kind, double cutoff );
+	double lrc_from_counts( int kind, double cutoff );
+	void   lrc_counts_init();
+	void   lrc_counts_free();
+
+	// whether the tail corrections are taken from the atom counts rather than summed per pair
+	inline bool lrc_by_type() const {
+		return !spectre;
+	}
+
+	// System.IntraConstants.cpp
+	double es_intra_molecule( const Molecule *molecule );
+	void   es_intra_counts_reset();
+	void   es_intra_counts_add( Molecule *molecule, int sign );
+	void   es_intra_reserve( int t );
+	double es_intra_check();
+	void   es_intra_differs( const Molecule *molecule );
+	double es_intra_from_counts();
+	void   es_intra_init();
+
+	// whether the Ewald self and intra-molecular terms are taken from the molecule counts
+	inline bool es_intra_by_type() const {
+		return !(spectre || gwp || es_intra_mixed);
+	}
+
+	// System.VolumeScaling.cpp
+	bool   volume_scale_supported();
+	void   volume_scale_coefficients( const Pair *pair_ptr, double *A );
+	void   volume_scale_sums();
+	void   volume_scale_prepare( double new_volume );
+	double volume_scaled_energy();
+	bool   volume_scale_restore();
+	void   volume_scale_move_made();
+	void   volume_scale_init();
+	void   volume_scale_free();
+
+	// System.PairTables.cpp
+	void   pair_tables_init();
+	void   pair_tables_reserve( int ntypes );
+	bool   pair_table_make( int kind, int t, int u, double cutoff );
+	void   pair_tables_free();
+	void   pair_kernel_params( const Pair *pair_ptr, double *param );
+	double pair_kernel( SplineTable::function kernel, const Pair *pair_ptr, double r );
+
+	// a PAIR_TABLE_* kernel of a pair of mixing types t,u at separation r, if it is tabulated there
+	inline bool pair_table_lookup( int kind, int t, int u, double r, double cutoff, double &value ) {
+		if( !pair_table_kernel[kind]  ||  t < 0  ||  u < 0 )
+			return false;
+		if( t > u ) {
+			int swap = t;
+			t = u;
+			u = swap;
+		}
+		if( u >= pair_table_ntypes )
+			pair_tables_reserve( u + 1 );
+		int i = (t*pair_table_ntypes + u)*PAIR_TABLE_KINDS + kind;
+		if( !pair_table_state[i] )
+			pair_table_make( kind, t, u, cutoff );
+		if( pair_table_state[i] < 0  ||  !pair_tables[i].covers(r) )
+			return false;
+		value = pair_tables[i](r);
+		return true;
+	}
 	
 
 	// System.Energy.SG.cpp
 	double sg();
+	void   sg_pair( Molecule * molecule_ptr, Atom * atom_ptr, Pair * pair_ptr );
+	static double sg_kernel( double r, const double *param );
+	static double sg_fh_kernel( double r, const double *param );
 	static double sg_nopbc( Molecule *molecules );
 		
 	
@@ -394,7 +587,7 @@ public:
 	void     thole_field();
 	void     thole_field_nopbc();
 	void     thole_field_wolf();
-	double * polar_wolf_alpha_lookup_init();
+	void     polar_wolf_alpha_lookup_init();
 	double   polar_wolf_alpha_getval( double r );
 	void     ewald_estatic();
 	int      thole_iterative();
@@ -490,10 +683,27 @@ public:
 	
 
 
+	// System.MixingTable.cpp
+	void mixing_table_apply( Molecule *molecule_i, Molecule *molecule_j, Atom *atom_i, Atom *atom_j, Pair *pair_ptr );
+	void mixing_types_assign( Molecule *molecule );
+	int  mixing_type_intern( Atom *atom );
+	void mixing_type_atom( int t, Atom *atom );
+	void mixing_table_reset();
+	void mixing_table_free();
+
+
 	// System.Pairs.cpp
 	void allocate_pair_lists();
 	void update_pairs_insert();
 	void update_pairs_remove();
+	void resize_pair_rows( Molecule *molecule, Molecule *stop, int sign );
+
+
+	// System.VerletList.cpp
+	void verlet_list_update( bool lists_changed );
+	void verlet_list_build();
+	void verlet_list_resolve( int i );
+	void verlet_list_free();
 
 	
 
@@ -598,6 +808,217 @@ public:
 	// Info regarding  periodic boundary and unit cell geometry
 	int              wrapall;  // Flag: wrap all option requested
 	PeriodicBoundary pbc;      // Periodic boundary conditions of THIS system 
+
+	// Linked-cell neighbor search
+	int              cell_list;                 // Flag: cull pairs in non-neighboring cells before minimum imaging
+	int              cell_list_dim[3];          // number of cells along each lattice vector
+	int              cell_list_ncells,
+	                 cell_list_ncells_allocd,
+	                 cell_list_natoms_allocd,
+	                 cell_list_natoms,          // atoms binned by the last cell_list_build()
+	                 cell_list_nbuilt,
+	                 cell_list_culled;          // Flag: every pair is culled or not as the last binning has it
+	int            * cell_list_head,            // first atom (atom_array index) in each cell
+	               * cell_list_next,            // next atom in the same cell
+	               * cell_list_cell,            // cell of each atom
+	               * cell_list_prev_head,       // the same, for the binning before the last
+	               * cell_list_prev_next,
+	               * cell_list_prev_cell,
+	               * cell_list_atom_cell;       // cell coordinates of each atom (3 per atom)
+	int              pair_lists_changed;        // Flag: pair lists were (re)allocated since the last pairs()
+	int              skip_frozen_pairs;         // Flag: pairs between two frozen atoms are not stored
+	int            * pairs_mobile,              // atom_array indices of the non-frozen atoms
+	               * pairs_mobile_before;       // number of non-frozen atoms preceding each atom_array index
+
+	// Type x type exclusion/mixing table
+	int              mixing_ntypes;             // number of distinct sets of atomic parameters
+	double         * mixing_type_params;        // the parameters defining each type
+	Pair           * mixing_table;              // exclusions and mixed parameters for each pair of types
+
+	// Dirty-molecule tracking
+	int              dirty_tracking;            // Flag: every move marks the molecules it perturbs (Molecule::dirty)
+	int              pairs_sweep_all;           // Flag: the next pairs() must visit every pair
+	int              pairs_natoms,              // natoms at the last full sweep
+	                 pairs_natoms_allocd;
+	char           * pairs_visit;               // atoms visited by the current partial sweep
+	ImageBatch       image_batch;               // partners of the atom being swept (and delta_energy_molecule())
+	int            * pairs_flagged;             // (i,j) atom indices of pairs whose recalculate flag was raised by the last sweep
+	size_t           pairs_nflagged,
+	                 pairs_flagged_allocd;
+
+	// Verlet neighbor lists
+	int              verlet_list;               // Flag: rd/es kernels iterate Verlet neighbor lists
+	double           verlet_skin;               // lists hold pairs within pbc.cutoff + verlet_skin (A)
+	int              verlet_list_count,         // number of listed pairs
+	                 verlet_list_allocd,
+	                 verlet_list_natoms,        // natoms at the last build
+	                 verlet_list_natoms_allocd,
+	                 verlet_list_rebuilds,      // number of builds so far (see write_performance())
+	                 verlet_list_lrc_stale;     // Flag: verlet_list_lrc must be re-summed
+	double           verlet_list_volume,        // pbc.volume at the last build
+	                 verlet_list_lrc;           // pair LRC summed over all pairs
+	int            * verlet_list_start,         // entries of atom_array[i] are [start[i], start[i+1])
+	               * verlet_list_offset;        // position of each listed node within its owner's pair list
+	Pair          ** verlet_list_pair;
+	Atom          ** verlet_list_atom;          // owner atoms when their entries were last resolved
+	double         * verlet_list_ref_pos;       // atomic positions at the last build
+
+	// Specialized energy pipeline
+	energy_pipeline_fn energy_pipeline;         // pairwise terms of energy() for this configuration, or null for the generic path
+	int              energy_pipeline_field,     // PIPELINE_FIELD_*: which static field the pipeline's pair pass gathers
+	                 ef_static_fused;           // Flag: ef_static was filled in by the pair pass, for the next thole_field()
+
+	// Batched Lennard-Jones
+	int              lj_block_count;            // pairs queued for lj_block_flush()
+	Pair          ** lj_block_pair;
+	double         * lj_block_rimg,
+	               * lj_block_sigma,            // |sigma|
+	               * lj_block_coef,             // 4*epsilon (sigrep with cdvdw_sig_repulsion, 1 for SPECTRE)
+	               * lj_block_repulsive,        // 1 if the r^-12 term applies, otherwise 0
+	               * lj_block_energy;
+
+	// Ewald k-vectors and structure-factor phases (see System.EwaldKSpace.cpp)
+	int              ewald_nk,                  // k-vectors in the half-space sum
+	                 ewald_nk_allocd,
+	                 ewald_kvec_kmax;           // ewald_kmax when they were generated (-1: not yet)
+	double           ewald_kvec_basis[3][3],    // pbc.reciprocal_basis when they were generated
+	                 ewald_kvec_alpha,          // ewald_alpha and polar_ewald_alpha when they were generated
+	                 ewald_kvec_polar_alpha;
+	int            * ewald_kvec_l;              // 3 per k-vector: reciprocal lattice indices l
+	double         * ewald_kvec,                // 3 per k-vector: 2*pi*reciprocal_basis*l
+	               * ewald_kvec_k2,             // |k|^2
+	               * ewald_kvec_weight,         // exp(-k^2/(4*ewald_alpha^2))/k^2
+	               * ewald_kvec_polar_weight;   // exp(-k^2/(4*polar_ewald_alpha^2))/k^2
+	int              ewald_phase_natoms,        // atoms collected by ewald_phases_begin()
+	                 ewald_phase_allocd,
+	                 ewald_phase_width,         // entries per atom and axis in ewald_eimq_re/im
+	                 ewald_phase_l01[2];        // l0, l1 of the products in ewald_phase01_re/im
+	Atom          ** ewald_phase_atom;
+	double         * ewald_eimq_re,             // e^{i m theta_q}
+	               * ewald_eimq_im,
+	               * ewald_phase01_re,          // e^{i (l0 theta_0 + l1 theta_1)}
+	               * ewald_phase01_im,
+	               * ewald_phase_re,            // e^{i k.r}
+	               * ewald_phase_im;
+	int              ewald_sf_valid,            // Flag: ewald_sf_re/im hold S(k) for the configuration as of the last update
+	                 ewald_sf_pending,          // Flag: make_move() has since moved a single molecule
+	                 ewald_sf_rollback,         // Flag: ewald_sf_saved_re/im hold S(k) from before that move
+	                 ewald_sf_updates,          // incremental updates since the last full summation
+	                 ewald_sf_allocd;
+	double         * ewald_sf_re,               // running structure factor of the mobile charges
+	               * ewald_sf_im,
+	               * ewald_sf_saved_re,
+	               * ewald_sf_saved_im;
+
+	// Smooth particle-mesh Ewald (see System.SPME.cpp)
+	int              spme_order,                // B-spline order (0: nothing made yet)
+	                 spme_grid[3],              // mesh points along each cell vector
+	                 spme_natoms,               // atoms collected by spme_splines()
+	                 spme_allocd;
+	double           spme_basis[3][3],          // pbc.reciprocal_basis, the alphas and ewald_spme_tolerance when the mesh was made
+	                 spme_alpha,
+	                 spme_polar_alpha,
+	                 spme_tolerance;
+	double         * spme_bsp_mod,              // |b_q(m)|^2, for each axis in turn
+	               * spme_influence,            // (2 pi/V) exp(-k^2/(4 alpha^2))/k^2 |b(m)|^2, per mesh point
+	               * spme_polar_influence,      // the same, with polar_ewald_alpha
+	               * spme_mesh,                 // charge (or dipole) mesh, then its transform (re/im interleaved)
+	               * spme_theta,                // B-spline weights, spme_order per atom and axis
+	               * spme_dtheta;               // their derivatives
+	int            * spme_base;                 // mesh index of each atom's first weight, per axis
+	Atom          ** spme_atom;
+	FFT              spme_fft;
+
+	// Axilrod-Teller triplets (see System.AxilrodTeller.cpp)
+	int              at_natoms,                 // polarizable atoms collected by at_gather()
+	                 at_allocd,
+	                 at_nbr_allocd,
+	                 at_cells_allocd,
+	                 at_cell_dim[3],            // cells along each cell vector
+	                 at_ntypes;                 // distinct (polarizability, c6, c9) seen so far
+	Atom          ** at_atom;
+	Molecule      ** at_mol;                    // molecule of each collected atom
+	int            * at_type,                   // c9 type of each collected atom
+	               * at_mark,                   // scratch, one per collected atom
+	               * at_nbr_start,              // neighbors of atom i are at_nbr[at_nbr_start[i] .. at_nbr_start[i+1]-1]
+	               * at_nbr,
+	               * at_cell_head,              // first atom in each cell, then at_cell_next, -1 ending the list
+	               * at_cell_next,
+	               * at_cell_of;                // cell indices of each atom
+	double         * at_nbr_d,                  // 4 per neighbor: minimum image displacement and its length
+	               * at_type_params,            // polarizability, c6, c9 of each type
+	               * at_c9;                     // mixed c9 of each triple of types (K A^9)
+	double           at_energy,                 // running three-body energy
+	                 at_saved_energy;           // ...from before the last move
+	int              at_valid,                  // Flag: at_energy is that of the configuration as of the last call
+	                 at_pending,                // Flag: make_move() has since moved a single molecule
+	                 at_rollback,               // Flag: at_saved_energy holds the energy from before that move
+	                 at_updates;                // incremental updates since the last full summation
+
+	// Dispersion Ewald sum for rd_crystal (see System.DispersionEwald.cpp)
+	int              rd_ewald_ntypes,           // mixing_ntypes when the tables were made (-1: not yet)
+	                 rd_ewald_nk,               // k-vectors in the half-space sum
+	                 rd_ewald_nk_allocd,
+	                 rd_ewald_lmax[3],          // largest |l| along each reciprocal vector
+	                 rd_ewald_phase_offset[3];  // l = 0 of each axis in rd_ewald_phase
+	double           rd_ewald_basis[3][3],      // pbc.basis, pbc.cutoff and the tolerance when they were made
+	                 rd_ewald_cutoff,
+	                 rd_ewald_tolerance,
+	                 rd_ewald_beta,
+	                 rd_ewald_a,                // pi^{3/2} beta^3/(3V)
+	                 rd_ewald_g6,               // sum over the lattice (n != 0) of g(beta n)/n^6 ...
+	                 rd_ewald_z6,               // ... of 1/n^6 ...
+	                 rd_ewald_z12;              // ... and of 1/n^12
+	int            * rd_ewald_kvec_l,           // 3 per k-vector: reciprocal lattice indices l
+	               * rd_ewald_mobile,           // mobile atoms of each type
+	               * rd_ewald_frozen;           // frozen atoms of each type
+	double         * rd_ewald_weight,           // 2 A f(k/(2 beta)), for k and -k together
+	               * rd_ewald_phase,            // e^{2 pi i l s_q} of one atom, re/im interleaved
+	               * rd_ewald_c6,               // 4 epsilon sigma^6 of each pair of types
+	               * rd_ewald_m,                // S(k) of the mobile atoms of each type
+	               * rd_ewald_g;                // sum_a C6_ab F_a(k), F_a the S(k) of the frozen atoms of type a
+
+	// Spline lookup tables
+	double           spline_tolerance;          // absolute error allowed in the erfc/exp tables, or 0 to call the library
+	SplineTable      spline_erfc,               // erfc(x)
+	                 spline_exp;                // exp(-x)
+
+	// Tail corrections from the atom counts of each mixing type
+	int              lrc_ntypes;                // length of lrc_type_count
+	int            * lrc_type_count;            // atoms of each mixing type in the system
+	int              lrc_terms_ntypes[LRC_TERMS_KINDS],  // mixing types the cached terms cover (0: none)
+	                 lrc_terms_allocd[LRC_TERMS_KINDS];
+	double           lrc_terms_volume[LRC_TERMS_KINDS],  // volume and cutoff they were evaluated at
+	                 lrc_terms_cutoff[LRC_TERMS_KINDS];
+	double         * lrc_pair_term[LRC_TERMS_KINDS],     // the correction for one pair of atoms of types t,u
+	               * lrc_self_term[LRC_TERMS_KINDS];     // the self correction of one atom of type t
+
+	// Ewald self and intra-molecular terms from the molecule counts of each type
+	std::vector<double> es_intra_energy;        // the terms of one molecule of each type (by id), NAN until computed
+	std::vector<int>    es_intra_count;         // molecules of each type in the system
+	double           es_intra_alpha;            // ewald_alpha the terms were computed for
+	int              es_intra_checked,          // Flag: the molecules read in have been checked against their types
+	                 es_intra_mixed;            // Flag: molecules of some type differ, so the terms are summed per pair
+
+	// Volume moves by scaling the inverse-power sums
+	int              volume_scale_pending;      // Flag: volume_change() has scaled the system, and energy() takes the energy from the sums
+	double           volume_scale_volume,       // volume the sums were taken at (0: none)
+	                 volume_scale_from,         // volume before the pending move...
+	                 volume_scale_factor,       // ...and its linear scale factor
+	                 volume_scale_sum[VOLUME_SCALE_POWERS],  // S_p, the sum of A_p r^-p over the pairs inside the cutoff
+	                 volume_scale_basis[3][3];  // the basis before the pending move
+	double         * volume_scale_shell,        // r and A_p of the pairs a move might take across the cutoff
+	               * volume_scale_backup;       // com, wrapped_com, pos and wrapped_pos of each molecule before the pending move
+	int              volume_scale_nshell,
+	                 volume_scale_shell_allocd,
+	                 volume_scale_backup_allocd;
+
+	// Tabulated pair kernels
+	double           pair_table_tolerance;      // absolute error (K) allowed in the pair tables, or 0 to evaluate the kernels directly
+	SplineTable::function pair_table_kernel[PAIR_TABLE_KINDS];  // what each kind of table holds (null: not tabulated)
+	int              pair_table_ntypes;         // mixing types the tables are laid out for
+	SplineTable    * pair_tables;               // PAIR_TABLE_KINDS per pair of mixing types t <= u
+	signed char    * pair_table_state;          // 0: not made yet, 1: made, -1: evaluated directly
 	
 	
 	// (P)RNG
@@ -627,7 +1048,15 @@ public:
 	int            vdw_fh_2be;          // Flag: 2BE method for polarvdw requested
 	int            rd_lrc, 
 	               rd_crystal,
-	               rd_crystal_order;
+	               rd_crystal_order,
+	               rd_crystal_ewald;           // Flag: rd_crystal lattice sums by Ewald summation, in place of the image loops
+	double         rd_crystal_ewald_tolerance; // relative size of the terms dropped from those sums
+
+	// Delta-energy evaluation of single-molecule moves
+	int            use_delta_energy,
+	               delta_energy_refresh,  // full energy() after this many delta evaluations
+	               delta_energy_count,    // delta evaluations since the last full energy()
+	               pair_energies_stale;   // Flag: delta_energy() has bypassed the cached pair energies
 
 	// uVT Fugacity Functions
 	int            h2_fugacity, 
@@ -641,7 +1070,8 @@ public:
 	int            rd_only, 
 	               rd_anharmonic;
 	double         rd_anharmonic_k, 
-	               rd_anharmonic_g;
+	               rd_anharmonic_g,
+	               axilrod_teller_cutoff;  // only triplets whose sides are all shorter than this (A), or 0 for all of them
 	int            c6_mixing, 
 	               damp_dispersion,
 	               disp_expansion_mbvdw,
@@ -665,8 +1095,13 @@ public:
 	int            wolf, 
 	               ewald_alpha_set, 
 	               ewald_kmax, 
+	               ewald_spme,           // Flag: reciprocal-space sum by smooth particle-mesh Ewald
+	               ewald_retune,         // Flag: ewald_tune() runs again when the volume drifts (default on)
 	               polar_ewald_alpha_set;
 	double         ewald_alpha,
+	               ewald_spme_tolerance, // accuracy the SPME mesh and spline order are chosen for
+	               ewald_precision,      // target error (K) that ewald_tune() chooses alpha and kmax for, or 0
+	               ewald_tuned_volume,   // cell volume they were last chosen at
 		           polar_ewald_alpha;
 	
 	
@@ -699,15 +1134,14 @@ public:
 	               polar_damp,
 	               field_damp,
 	               polar_precision,
-	             * polar_wolf_alpha_table,
 	               polar_wolf_alpha_lookup_cutoff;
-	int            polar_wolf_alpha_table_max;     //stores the total size of the array double polar_wolf_alpha_table[]
+	SplineTable    polar_wolf_alpha_table;         // erfc(a*r)/r^2 + 2*a*exp(-a^2*r^2)/(sqrt(pi)*r), see polar_wolf_alpha_lookup_init()
 	int            damp_type;
 	double      ** A_matrix;       // A matrix (Thole polarization) 
 	double      ** B_matrix;       // B matrix (Thole polarization)
 	double         C_matrix[3][3]; // Polarizability tensor 
 
-	vdw_t        * vdw_eiso_info; //keeps track of molecule vdw self energies
+	std::vector<double> vdw_eiso_energy; // vdw self energy of each molecule type (by id), NAN until computed
 	
 
 	//misc
@@ -760,6 +1194,7 @@ public:
 	sorbateInfo_t      * sorbateInfo;    // stores an array of sorbate Info
 	int                  sorbateInsert;  // which sorbate was last inserted
 	sorbateAverages_t  * sorbateGlobal;  // where the global average is stored
+	std::vector<int>     sorbate_of_moleculetype; // sorbateInfo index for each molecule type id (-1 none, -2 not yet resolved)
 
 	checkpoint_t       * checkpoint;
 
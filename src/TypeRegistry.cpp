@@ -0,0 +1,31 @@
+#include "TypeRegistry.h"
+
+
+
+
+int TypeRegistry::intern( std::vector<std::string> &names, const char *name ) {
+
+	for( size_t id = 0; id < names.size(); id++ )
+		if( names[id] == name )
+			return (int) id;
+
+	names.push_back( name );
+	return (int) names.size() - 1;
+}
+
+
+
+
+std::vector<std::string> & TypeRegistry::atom_types() {
+// Constructed on first use, so that it is ready for any static initializer that might need it.
+	static std::vector<std::string> names( 1, std::string() );
+	return names;
+}
+
+
+
+
+std::vector<std::string> & TypeRegistry::molecule_types() {
+	static std::vector<std::string> names( 1, std::string() );
+	return names;
+}
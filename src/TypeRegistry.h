@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+// Interned atom and molecule type names.
+//
+// Atoms and molecules carry a small integer id in place of their type name, so that copying them
+// is cheap and types may be compared (or used to index per-type data) directly. The registry is
+// shared by every System, so an id means the same thing in all of them. Id 0 is the empty name,
+// which is what a zeroed (calloc'd) Atom or Molecule refers to.
+
+class TypeRegistry
+{
+	TypeRegistry() {};
+	~TypeRegistry() {};
+
+public:
+
+	// return the id of name, registering it if it hasn't been seen before
+	static int atom_type    ( const char *name ) { return intern( atom_types(),     name ); }
+	static int molecule_type( const char *name ) { return intern( molecule_types(), name ); }
+
+	static const char * atom_type_name    ( int id ) { return atom_types()    [id].c_str(); }
+	static const char * molecule_type_name( int id ) { return molecule_types()[id].c_str(); }
+
+	// ids run from 0 to (count - 1)
+	static int molecule_type_count() { return (int) molecule_types().size(); }
+
+private:
+
+	static int intern( std::vector<std::string> &names, const char *name );
+
+	static std::vector<std::string> & atom_types();
+	static std::vector<std::string> & molecule_types();
+};
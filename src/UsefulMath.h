@@ -26,6 +26,15 @@ public:
 		return a[0]*b[0]+a[1]*b[1]+a[2]*b[2];
 	}
 
+
+	// Kahan summation: add x to sum, carrying the rounding error forward in carry
+	static void compensated_add ( double &sum, double &carry, double x ) {
+		double y = x - carry,
+		       t = sum + y;
+		carry = (t - sum) - y;
+		sum   = t;
+	}
+
 /*
 	static double min ( double a, double b ) {
 		if ( a > b ) 
@@ -85,6 +85,48 @@ enum {
 	ENSEMBLE_PATH_INTEGRAL_NVT,
 	ENSEMBLE_NVT_GIBBS
 };
+enum {
+	PIPELINE_RD_LJ,
+	PIPELINE_RD_LJ_POLARVDW,
+	PIPELINE_RD_LJ_SIGREP,
+	PIPELINE_RD_EXP_REPULSION
+};
+enum {
+	PIPELINE_ES_NONE,
+	PIPELINE_ES_EWALD,
+	PIPELINE_ES_WOLF
+};
+enum {
+	PIPELINE_FIELD_NONE,
+	PIPELINE_FIELD_EWALD,
+	PIPELINE_FIELD_WOLF,
+	PIPELINE_FIELD_NOPBC
+};
+enum {
+	LRC_TERMS_RD,
+	LRC_TERMS_VDW,
+	LRC_TERMS_KINDS
+};
+enum {
+	VOLUME_SCALE_R12,
+	VOLUME_SCALE_R6,
+	VOLUME_SCALE_POWERS
+};
+enum {
+	PAIR_TABLE_ENERGY,
+	PAIR_TABLE_FH,
+	PAIR_TABLE_KINDS
+};
+enum {
+	PAIR_KERNEL_SIGMA,
+	PAIR_KERNEL_EPSILON,
+	PAIR_KERNEL_C6,
+	PAIR_KERNEL_C8,
+	PAIR_KERNEL_C10,
+	PAIR_KERNEL_ATTRACTIVE_ONLY,
+	PAIR_KERNEL_DAMPING,
+	PAIR_KERNEL_NPARAMS
+};
 enum {
 	MOVETYPE_INSERT,
 	MOVETYPE_REMOVE,